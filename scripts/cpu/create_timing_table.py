@@ -0,0 +1,48 @@
+import table as t
+
+READ_INSTRUCTIONS = {"LDA", "LDX", "LDY", "EOR", "AND", "ORA", "ADC", "SBC", "CMP", "CPX", "CPY", "BIT"}
+STORE_INSTRUCTIONS = {"STA", "STX", "STY"}
+READ_MODIFY_WRITE_INSTRUCTIONS = {"ASL", "LSR", "ROL", "ROR", "INC", "DEC"}
+
+READ_CYCLES = {
+    t.IMMD: 2, t.ZRPG: 3, t.ZRPX: 4, t.ZRPY: 4, t.ABSO: 4, t.ABSX: 4, t.ABSY: 4, t.INDX: 6, t.INDY: 5
+}
+STORE_CYCLES = {
+    t.ZRPG: 3, t.ZRPX: 4, t.ZRPY: 4, t.ABSO: 4, t.ABSX: 5, t.ABSY: 5, t.INDX: 6, t.INDY: 6
+}
+READ_MODIFY_WRITE_CYCLES = {
+    t.ACCU: 2, t.ZRPG: 5, t.ZRPX: 6, t.ABSO: 6, t.ABSX: 7
+}
+OTHER_CYCLES = {
+    ("BRK", t.IMPL): 7, ("JSR", t.ABSO): 6, ("RTI", t.IMPL): 6, ("RTS", t.IMPL): 6,
+    ("JMP", t.ABSO): 3, ("JMP", t.INDR): 5,
+    ("PHA", t.IMPL): 3, ("PHP", t.IMPL): 3, ("PLA", t.IMPL): 4, ("PLP", t.IMPL): 4,
+}
+
+
+def timing(name, mode):
+    if name is None:
+        return (0, False)
+    elif name in READ_INSTRUCTIONS:
+        return (READ_CYCLES[mode], mode in (t.ABSX, t.ABSY, t.INDY))
+    elif name in STORE_INSTRUCTIONS:
+        return (STORE_CYCLES[mode], False)
+    elif name in READ_MODIFY_WRITE_INSTRUCTIONS:
+        return (READ_MODIFY_WRITE_CYCLES[mode], False)
+    elif (name, mode) in OTHER_CYCLES:
+        return (OTHER_CYCLES[(name, mode)], False)
+    else:
+        return (2, False)  # implied instructions and untaken branches
+
+
+for i in range(len(t.instructions)):
+    hex_str = ""
+    if i < 16:
+        hex_str = "0x0" + hex(i)[2:]
+    else:
+        hex_str = hex(i)
+
+    (name, mode) = t.instructions[i]
+    (cycles, penalty) = timing(name, mode)
+    entry = "{ " + str(cycles) + ", " + ("true" if penalty else "false") + " },"
+    print("{:<14}".format(entry), "/*", hex_str, "*/")
@@ -0,0 +1,74 @@
+#include <algorithm>
+
+#include "audio_output.hpp"
+#include "apu/apu.hpp"
+
+namespace RNES {
+
+    static const size_t SAMPLES_PER_FRAME = 800; // 48000 Hz at 60 frames per second
+    static const Uint16 DEVICE_BUFFER_SAMPLES = 512;
+
+    // The furthest the resampling ratio is ever moved from 1.0. Small enough that the change in
+    // pitch can't be heard.
+    static const double MAX_RATE_ADJUSTMENT = 0.005;
+
+    AudioOutput::AudioOutput(size_t t_targetFill)
+        : m_ring(2 * t_targetFill)
+        , m_rateController(t_targetFill, MAX_RATE_ADJUSTMENT)
+        , m_device(0)
+        , m_lastSample(0)
+    {
+        ;
+    }
+
+    AudioOutput::~AudioOutput() {
+        if (m_device != 0) {
+            SDL_CloseAudioDevice(m_device);
+        }
+    }
+
+    ErrorOr<std::unique_ptr<AudioOutput>> AudioOutput::open(size_t t_latencyFrames) {
+        std::unique_ptr<AudioOutput> output(new AudioOutput(t_latencyFrames * SAMPLES_PER_FRAME));
+
+        SDL_AudioSpec desired{};
+        desired.freq = static_cast<int>(APU::SAMPLE_RATE);
+        desired.format = AUDIO_S16SYS;
+        desired.channels = 1;
+        desired.samples = DEVICE_BUFFER_SAMPLES;
+        desired.callback = &AudioOutput::audioCallback;
+        desired.userdata = output.get();
+
+        output->m_device = SDL_OpenAudioDevice(nullptr, 0, &desired, nullptr, 0);
+        REQUIRE(output->m_device != 0, ERROR_FAILED_TO_OPEN_DEVICE);
+
+        SDL_PauseAudioDevice(output->m_device, 0);
+        return output;
+    }
+
+    void AudioOutput::writeSamples(std::span<const int16_t> t_samples) {
+        // If the ring is full the consumer has stalled, and the excess is dropped
+        m_ring.write(t_samples.data(), t_samples.size());
+
+        m_rateController.update(m_ring.size());
+    }
+
+    double AudioOutput::getRateAdjustment() const {
+        return m_rateController.ratio();
+    }
+
+    void AudioOutput::audioCallback(void* t_userData, Uint8* t_stream, int t_length) {
+        AudioOutput& output = *static_cast<AudioOutput*>(t_userData);
+
+        int16_t* samples = reinterpret_cast<int16_t*>(t_stream);
+        const size_t requested = t_length / sizeof(int16_t);
+
+        const size_t count = output.m_ring.read(samples, requested);
+        if (count > 0) {
+            output.m_lastSample = samples[count - 1];
+        }
+
+        // On an underrun hold the last level rather than dropping to zero, which would click
+        std::fill(samples + count, samples + requested, output.m_lastSample);
+    }
+
+}
@@ -0,0 +1,52 @@
+#ifndef RNES_AUDIO_OUTPUT_INCLUDED
+#define RNES_AUDIO_OUTPUT_INCLUDED
+
+#include <memory>
+
+#include "SDL.h"
+
+#include "defines.hpp"
+#include "error_or.hpp"
+#include "apu/audio_ring.hpp"
+#include "apu/rate_control.hpp"
+#include "output/audio_sink.hpp"
+
+namespace RNES {
+
+    /* Plays the APU's output through an SDL audio device. The emulator thread pushes each frame's
+     * samples into a lock-free ring that SDL's callback drains, and the fill level of the ring
+     * drives the APU's rate adjustment so it stays close to a couple of frames of latency.
+     */
+    class AudioOutput : public Output::AudioSink {
+    public:
+        enum Error {
+            ERROR_FAILED_TO_OPEN_DEVICE = 0x200,
+        };
+
+        AudioOutput(const AudioOutput&) = delete;
+        AudioOutput& operator=(const AudioOutput&) = delete;
+
+        ~AudioOutput() override;
+
+        // SDL must have been initialised with SDL_INIT_AUDIO
+        static ErrorOr<std::unique_ptr<AudioOutput>> open(size_t t_latencyFrames);
+
+        // Moves the samples of the frame that just ended into the ring and updates the rate
+        void writeSamples(std::span<const int16_t> t_samples) override;
+        [[nodiscard]] double getRateAdjustment() const override;
+
+    private:
+        explicit AudioOutput(size_t t_targetFill);
+
+        static void audioCallback(void* t_userData, Uint8* t_stream, int t_length);
+
+        APU::AudioRing m_ring;
+        APU::RateController m_rateController;
+        SDL_AudioDeviceID m_device;
+
+        int16_t m_lastSample; // only touched by the audio thread
+    };
+
+}
+
+#endif
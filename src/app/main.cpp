@@ -1,32 +1,92 @@
-#include "mapper/mapper.hpp"
-
-#include <iomanip>
+#include <cstdlib>
 #include <iostream>
-#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
 #include <vector>
 
-#include "assert.hpp"
+#include "SDL.h"
+
+#include "console.hpp"
+#include "movie.hpp"
+#include "rewind_buffer.hpp"
+#include "app/audio_output.hpp"
+#include "app/sdl_video_sink.hpp"
 #include "ppu/ppu.hpp"
 
-std::vector<uint8_t> readFile(const char* t_path);
+// Z and X are A and B, right shift and return are select and start, and the arrows are the d-pad
+static uint8_t readController() {
+    static const SDL_Scancode KEYS[] = {
+        SDL_SCANCODE_Z, SDL_SCANCODE_X, SDL_SCANCODE_RSHIFT, SDL_SCANCODE_RETURN,
+        SDL_SCANCODE_UP, SDL_SCANCODE_DOWN, SDL_SCANCODE_LEFT, SDL_SCANCODE_RIGHT,
+    };
+
+    const Uint8* keys = SDL_GetKeyboardState(nullptr);
+    uint8_t buttons = 0;
+    for (size_t i = 0; i < std::size(KEYS); i++) {
+        if (keys[KEYS[i]]) {
+            buttons |= 1 << i;
+        }
+    }
+    return buttons;
+}
 
+/* --record <movie> saves the input of the whole session when the window is closed. Frames that
+ * were rewound are replaced by whatever was played over them.
+ */
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: <rom_path> <oam_dump>" << std::endl;
+    std::vector<char*> args;
+    const char* moviePath = nullptr;
+    for (int i = 0; i < argc; i++) {
+        if (std::string(argv[i]) == "--record" && i + 1 < argc) {
+            moviePath = argv[++i];
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: <rom_path> [run_ahead_frames] [--record <movie>]" << std::endl;
         return 1;
     }
 
-    if (SDL_Init(SDL_INIT_VIDEO)) {
+    // Movies start without battery RAM, so recording uses a console that has none
+    const auto createConsole = [&]() -> ErrorOr<std::unique_ptr<RNES::Console>> {
+        if (moviePath != nullptr) {
+            return RNES::Console::fromImage(TRY(RNES::Mapper::loadROMImage(argv[1])));
+        }
+        return RNES::Console::fromFile(argv[1]);
+    };
+
+    auto consoleOrError = createConsole();
+    if (consoleOrError.is_error()) {
+        std::cerr << "Failed to load ROM (error " << consoleOrError.get_error().getErrorCode() << ")\n";
+        return EXIT_FAILURE;
+    }
+    std::unique_ptr<RNES::Console> console = std::move(consoleOrError).get_value();
+
+    std::optional<RNES::Movie> movie;
+    if (moviePath != nullptr) {
+        movie.emplace(console->getROMHash());
+    }
+
+    if (argc == 3) {
+        console->setRunAhead(std::stoull(argv[2]));
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO)) {
         std::cerr << "Failed to initialize SDL\n";
         return EXIT_FAILURE;
     }
 
     SDL_Window* window = SDL_CreateWindow(
-            "sdl_test",
+            "RNES",
             SDL_WINDOWPOS_CENTERED,
             SDL_WINDOWPOS_CENTERED,
-            256,
-            240,
+            2 * RNES::PPU::OUTPUT_WIDTH,
+            2 * RNES::PPU::OUTPUT_HEIGHT,
             SDL_WINDOW_SHOWN
     );
 
@@ -37,7 +97,7 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
     if (renderer == nullptr) {
         std::cerr << "Failed to create renderer\n";
 
@@ -46,28 +106,27 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
-    RNES::Mapper::Mapper mapper = RNES::Mapper::parseMapperFromINES(argv[1]);
+    auto videoSink = RNES::SDLVideoSink::create(renderer);
+    if (videoSink.is_error()) {
+        std::cerr << "Failed to create texture\n";
 
-    for (size_t i = 0; i < 0x2000; i++) {
-        std::cout << mapper.ppuController->readWord(i);
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return EXIT_FAILURE;
     }
-
-    std::vector<uint8_t> oamDump = readFile(argv[2]);
-
-    std::array<uint8_t, RNES::PPU::OAM_SIZE> oamDumpArr = {0};
-    for (size_t i = 0; i < oamDumpArr.size(); i++) {
-        oamDumpArr[i] = oamDump[i];
+    console->setVideoSink(std::move(videoSink).get_value());
+
+    // Two frames of buffered audio; the APU's rate is adjusted to keep the buffer there
+    auto audioOutput = RNES::AudioOutput::open(2);
+    if (audioOutput.is_error()) {
+        std::cerr << "Failed to open audio device, continuing without sound\n";
+    } else {
+        console->setAudioSink(std::move(audioOutput).get_value());
     }
 
-    RNES::PPU::PPU ppu(std::move(mapper.ppuController), oamDumpArr);
-
-    for (size_t i = 0; i < 341 * 241; i++) {
-        ppu.cycle();
-    }
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, ppu.getScreenOutput());
-    SDL_RenderCopy(renderer, texture, nullptr, nullptr);
-    SDL_RenderPresent(renderer);
-    SDL_DestroyTexture(texture);
+    // Holding backspace steps back one frame per frame, for as long as the buffer goes back
+    RNES::RewindBuffer rewind(console->getStateSize());
 
     SDL_Event e;
     bool done = false;
@@ -78,25 +137,35 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        SDL_Delay(16);
+        const bool rewinding = SDL_GetKeyboardState(nullptr)[SDL_SCANCODE_BACKSPACE];
+        if (rewinding) {
+            // The frame has to be run again from its saved start to be shown
+            (void)rewind.pop(*console);
+        }
+        else {
+            rewind.push(*console);
+        }
+
+        const uint8_t buttons = readController();
+        console->setInput(0, buttons);
+        if (movie.has_value()) {
+            movie->record(console->getFrameCount(), { buttons, 0 });
+        }
+
+        // Presents the frame through the video sink
+        console->runFrame();
     }
 
+    if (movie.has_value() && movie->save(moviePath).is_error()) {
+        std::cerr << "Failed to save the movie to " << moviePath << "\n";
+    }
+
+    // The sinks hold the texture and the audio device
+    console.reset();
+
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
 
-
     return 0;
 }
-
-std::vector<uint8_t> readFile(const char* t_path) {
-    std::ifstream fileStream(t_path, std::ios::binary | std::ios::in | std::ios::ate);
-    ASSERT(fileStream.is_open(), "Could not open file"); // TODO: change this
-
-    std::vector<uint8_t> result(fileStream.tellg());
-    fileStream.seekg(std::ios::beg);
-    fileStream.read(reinterpret_cast<char*>(result.data()), result.size());
-
-    return result;
-}
-
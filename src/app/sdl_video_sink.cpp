@@ -0,0 +1,68 @@
+#include <cstring>
+
+#include "sdl_video_sink.hpp"
+#include "ppu/ppu.hpp"
+
+namespace RNES {
+
+    static const int ROW_BYTES = PPU::OUTPUT_WIDTH * sizeof(uint32_t);
+
+    SDLVideoSink::SDLVideoSink(SDL_Renderer* t_renderer, SDL_Texture* t_texture)
+        : m_renderer(t_renderer)
+        , m_texture(t_texture)
+        , m_lockedPixels(nullptr)
+        , m_lockedPitch(0)
+        , m_staging()
+    {
+        ;
+    }
+
+    SDLVideoSink::~SDLVideoSink() {
+        if (m_lockedPixels != nullptr) {
+            SDL_UnlockTexture(m_texture);
+        }
+        SDL_DestroyTexture(m_texture);
+    }
+
+    ErrorOr<std::unique_ptr<SDLVideoSink>> SDLVideoSink::create(SDL_Renderer* t_renderer) {
+        SDL_Texture* texture = SDL_CreateTexture(t_renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, PPU::OUTPUT_WIDTH, PPU::OUTPUT_HEIGHT);
+        REQUIRE(texture != nullptr, ERROR_FAILED_TO_CREATE_TEXTURE);
+
+        return std::unique_ptr<SDLVideoSink>(new SDLVideoSink(t_renderer, texture));
+    }
+
+    std::span<uint32_t> SDLVideoSink::beginFrame() {
+        void* pixels = nullptr;
+        if (SDL_LockTexture(m_texture, nullptr, &pixels, &m_lockedPitch) != 0) {
+            // Keep emulating, the frame just won't be shown
+            return {};
+        }
+        m_lockedPixels = static_cast<uint8_t*>(pixels);
+
+        if (m_lockedPitch == ROW_BYTES) {
+            return { reinterpret_cast<uint32_t*>(m_lockedPixels), PPU::OUTPUT_WIDTH * PPU::OUTPUT_HEIGHT };
+        }
+
+        m_staging.resize(PPU::OUTPUT_WIDTH * PPU::OUTPUT_HEIGHT);
+        return m_staging;
+    }
+
+    void SDLVideoSink::endFrame() {
+        if (m_lockedPixels == nullptr) {
+            return;
+        }
+
+        if (m_lockedPitch != ROW_BYTES) {
+            for (size_t y = 0; y < PPU::OUTPUT_HEIGHT; y++) {
+                std::memcpy(m_lockedPixels + y * m_lockedPitch, m_staging.data() + y * PPU::OUTPUT_WIDTH, ROW_BYTES);
+            }
+        }
+
+        SDL_UnlockTexture(m_texture);
+        m_lockedPixels = nullptr;
+
+        SDL_RenderCopy(m_renderer, m_texture, nullptr, nullptr);
+        SDL_RenderPresent(m_renderer);
+    }
+
+}
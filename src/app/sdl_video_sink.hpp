@@ -0,0 +1,48 @@
+#ifndef RNES_SDL_VIDEO_SINK_INCLUDED
+#define RNES_SDL_VIDEO_SINK_INCLUDED
+
+#include <memory>
+#include <vector>
+
+#include "SDL.h"
+
+#include "defines.hpp"
+#include "error_or.hpp"
+#include "output/video_sink.hpp"
+
+namespace RNES {
+
+    /* Draws frames into a streaming SDL texture and presents it. The texture stays locked while a
+     * frame is emulated so the PPU writes straight into it; only if SDL pads the rows is the frame
+     * drawn into a staging buffer and copied over.
+     */
+    class SDLVideoSink : public Output::VideoSink {
+    public:
+        enum Error {
+            ERROR_FAILED_TO_CREATE_TEXTURE = 0x210,
+        };
+
+        SDLVideoSink(const SDLVideoSink&) = delete;
+        SDLVideoSink& operator=(const SDLVideoSink&) = delete;
+
+        ~SDLVideoSink() override;
+
+        static ErrorOr<std::unique_ptr<SDLVideoSink>> create(SDL_Renderer* t_renderer);
+
+        std::span<uint32_t> beginFrame() override;
+        void endFrame() override;
+
+    private:
+        SDLVideoSink(SDL_Renderer* t_renderer, SDL_Texture* t_texture);
+
+        SDL_Renderer* m_renderer;
+        SDL_Texture* m_texture;
+
+        uint8_t* m_lockedPixels;
+        int m_lockedPitch;
+        std::vector<uint32_t> m_staging;
+    };
+
+}
+
+#endif
@@ -0,0 +1,852 @@
+#include <algorithm>
+
+#include "apu.hpp"
+#include "assert.hpp"
+
+namespace RNES::APU {
+
+    static const std::array<uint8_t, 32> LENGTH_TABLE = {
+        10, 254, 20,  2, 40,  4, 80,  6, 160,  8, 60, 10, 14, 12, 26, 14,
+        12,  16, 24, 18, 48, 20, 96, 22, 192, 24, 72, 26, 16, 28, 32, 30,
+    };
+
+    static const std::array<std::array<uint8_t, 8>, 4> DUTY_TABLE = {{
+        { 0, 1, 0, 0, 0, 0, 0, 0 },
+        { 0, 1, 1, 0, 0, 0, 0, 0 },
+        { 0, 1, 1, 1, 1, 0, 0, 0 },
+        { 1, 0, 0, 1, 1, 1, 1, 1 },
+    }};
+
+    static const std::array<uint8_t, 32> TRIANGLE_TABLE = {
+        15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,  0,
+         0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+    };
+
+    // Periods in CPU cycles (NTSC)
+    static const std::array<uint16_t, 16> NOISE_PERIOD_TABLE = {
+        4, 8, 16, 32, 64, 96, 128, 160, 202, 254, 380, 508, 762, 1016, 2034, 4068,
+    };
+
+    static const std::array<uint16_t, 16> DMC_PERIOD_TABLE = {
+        428, 380, 340, 320, 286, 254, 226, 214, 190, 160, 142, 128, 106, 84, 72, 54,
+    };
+
+    // The CPU is halted while the DMC reads a byte. It can be 3 or 2 cycles when the fetch lands on
+    // a write or next to OAM DMA, but the exact cycle isn't known here.
+    static const uint64_t DMC_FETCH_STALL_CYCLES = 4;
+
+    /* The mixer is non-linear, so it is looked up from the sum of the pulse levels and the weighted
+     * sum of the triangle, noise and DMC levels (https://www.nesdev.org/wiki/APU_Mixer). Both tables
+     * together peak just below 1.0, which is stored as MIX_UNIT.
+     */
+    static const int32_t MIX_UNIT = 1 << 14;
+
+    static const std::array<int32_t, 31> PULSE_TABLE = [] {
+        std::array<int32_t, 31> table{};
+        for (size_t i = 1; i < table.size(); i++) {
+            table[i] = static_cast<int32_t>(MIX_UNIT * 95.52 / (8128.0 / static_cast<double>(i) + 100.0));
+        }
+        return table;
+    }();
+
+    static const std::array<int32_t, 203> TND_TABLE = [] {
+        std::array<int32_t, 203> table{};
+        for (size_t i = 1; i < table.size(); i++) {
+            table[i] = static_cast<int32_t>(MIX_UNIT * 163.67 / (24329.0 / static_cast<double>(i) + 100.0));
+        }
+        return table;
+    }();
+
+    /* Band-limited synthesis runs at a fixed fraction of the CPU clock. The filters then run at that
+     * rate and the polyphase resampler takes it the rest of the way to the output rate.
+     */
+    static const double SYNTHESIS_RATE = CPU_CLOCK_RATE / 32.0;
+
+    // High-pass and low-pass stages of the console's output circuit
+    static const double HIGH_PASS_1_CUTOFF = 90.0;
+    static const double HIGH_PASS_2_CUTOFF = 440.0;
+    static const double LOW_PASS_CUTOFF = 14000.0;
+
+    struct FrameStep {
+        uint32_t cycle;
+        bool quarterFrame;
+        bool halfFrame;
+        bool irq;
+    };
+
+    // CPU cycles after the frame counter was reset. The last step of each sequence also restarts it.
+    static const std::array<FrameStep, 4> FOUR_STEP_SEQUENCE = {{
+        {  7457, true, false, false },
+        { 14913, true, true,  false },
+        { 22371, true, false, false },
+        { 29829, true, true,  true  },
+    }};
+    static const uint64_t FOUR_STEP_PERIOD = 29830;
+
+    static const std::array<FrameStep, 5> FIVE_STEP_SEQUENCE = {{
+        {  7457, true,  false, false },
+        { 14913, true,  true,  false },
+        { 22371, true,  false, false },
+        { 29829, false, false, false },
+        { 37281, true,  true,  false },
+    }};
+    static const uint64_t FIVE_STEP_PERIOD = 37282;
+
+    static void clockEnvelope(auto& t_envelope) {
+        if (t_envelope.start) {
+            t_envelope.start = false;
+            t_envelope.decay = 15;
+            t_envelope.divider = t_envelope.period;
+        }
+        else if (t_envelope.divider == 0) {
+            t_envelope.divider = t_envelope.period;
+            if (t_envelope.decay > 0) {
+                t_envelope.decay--;
+            }
+            else if (t_envelope.loop) {
+                t_envelope.decay = 15;
+            }
+        }
+        else {
+            t_envelope.divider--;
+        }
+    }
+
+    static uint8_t envelopeVolume(const auto& t_envelope) {
+        return t_envelope.constantVolume ? t_envelope.period : t_envelope.decay;
+    }
+
+    // Timer period the sweep unit is heading towards; anything over 0x7FF silences the channel
+    static uint32_t sweepTarget(const auto& t_pulse, bool t_isPulse1) {
+        const uint32_t change = t_pulse.timer >> t_pulse.sweepShift;
+        if (!t_pulse.sweepNegate) {
+            return t_pulse.timer + change;
+        }
+
+        // Pulse 1 negates with ones' complement
+        const uint32_t subtract = change + (t_isPulse1 ? 1 : 0);
+        return (subtract > t_pulse.timer) ? 0 : (t_pulse.timer - subtract);
+    }
+
+    static bool isPulseMuted(const auto& t_pulse, bool t_isPulse1) {
+        return t_pulse.timer < 8 || sweepTarget(t_pulse, t_isPulse1) > 0x7FF;
+    }
+
+    // Number of whole periods needed for t_from to reach or pass t_until
+    static uint64_t stepsUntil(uint64_t t_from, uint64_t t_until, uint64_t t_period) {
+        return (t_until - t_from + t_period - 1) / t_period;
+    }
+
+    APU::APU(Scheduler& t_scheduler)
+        : m_scheduler(t_scheduler)
+        , m_memory(nullptr)
+        , m_blip(CPU_CLOCK_RATE, SYNTHESIS_RATE, MAX_FRAME_CYCLES)
+        , m_filters({
+            FirstOrderFilter::highPass(HIGH_PASS_1_CUTOFF, SYNTHESIS_RATE),
+            FirstOrderFilter::highPass(HIGH_PASS_2_CUTOFF, SYNTHESIS_RATE),
+            FirstOrderFilter::lowPass(LOW_PASS_CUTOFF, SYNTHESIS_RATE),
+        })
+        , m_resampler(SYNTHESIS_RATE, SAMPLE_RATE)
+        , m_synthesized()
+        , m_block()
+        , m_output()
+        , m_outputRead(0)
+        , m_synthesisEnabled(false)
+        , m_mixedOutput(0)
+        , m_synthesizedOutput(0)
+        , m_currentCycle(0)
+        , m_audioFrameStart(0)
+        , m_pulses()
+        , m_triangle()
+        , m_noise()
+        , m_dmc()
+        , m_enabled({ false, false, false, false })
+        , m_frameCounter({ false, false, false, 0, 0 })
+        , m_dmcIRQFlag(false)
+    {
+        m_noise.shiftRegister = 1;
+        m_noise.period = NOISE_PERIOD_TABLE[0];
+
+        m_dmc.period = DMC_PERIOD_TABLE[0];
+        m_dmc.bitsRemaining = 8;
+        m_dmc.silence = true;
+    }
+
+    void APU::setMemory(const CPU::CPUMemoryMap* t_memory) {
+        m_memory = t_memory;
+    }
+
+    void APU::setSynthesisEnabled(bool t_enabled) {
+        if (t_enabled == m_synthesisEnabled) {
+            return;
+        }
+
+        m_synthesisEnabled = t_enabled;
+        if (t_enabled) {
+            m_blip.allocate();
+            m_synthesizedOutput = 0;
+            restartSynthesis();
+        }
+        else {
+            m_blip.release();
+            m_output.clear();
+            m_outputRead = 0;
+        }
+    }
+
+    bool APU::isSynthesisEnabled() const {
+        return m_synthesisEnabled;
+    }
+
+    void APU::writeRegister(Address t_address, Word t_value, uint64_t t_cycle) {
+        catchUp(t_cycle);
+
+        switch (t_address) {
+            case 0x4000:
+            case 0x4004: {
+                Pulse& pulse = m_pulses[(t_address - 0x4000) / 4];
+                pulse.duty = t_value >> 6;
+                pulse.envelope.loop = t_value & 0x20;
+                pulse.envelope.constantVolume = t_value & 0x10;
+                pulse.envelope.period = t_value & 0x0F;
+                break;
+            }
+
+            case 0x4001:
+            case 0x4005: {
+                Pulse& pulse = m_pulses[(t_address - 0x4000) / 4];
+                pulse.sweepEnabled = t_value & 0x80;
+                pulse.sweepPeriod = (t_value >> 4) & 0x07;
+                pulse.sweepNegate = t_value & 0x08;
+                pulse.sweepShift = t_value & 0x07;
+                pulse.sweepReload = true;
+                break;
+            }
+
+            case 0x4002:
+            case 0x4006: {
+                Pulse& pulse = m_pulses[(t_address - 0x4000) / 4];
+                pulse.timer = (pulse.timer & 0x0700) | t_value;
+                break;
+            }
+
+            case 0x4003:
+            case 0x4007: {
+                const size_t index = (t_address - 0x4000) / 4;
+                Pulse& pulse = m_pulses[index];
+                pulse.timer = (pulse.timer & 0x00FF) | ((t_value & 0x07) << 8);
+                if (m_enabled[index]) {
+                    pulse.lengthCounter = LENGTH_TABLE[t_value >> 3];
+                }
+                pulse.sequencePosition = 0;
+                pulse.envelope.start = true;
+                break;
+            }
+
+            case 0x4008:
+                m_triangle.control = t_value & 0x80;
+                m_triangle.linearReloadValue = t_value & 0x7F;
+                break;
+
+            case 0x400A:
+                m_triangle.timer = (m_triangle.timer & 0x0700) | t_value;
+                break;
+
+            case 0x400B:
+                m_triangle.timer = (m_triangle.timer & 0x00FF) | ((t_value & 0x07) << 8);
+                if (m_enabled[2]) {
+                    m_triangle.lengthCounter = LENGTH_TABLE[t_value >> 3];
+                }
+                m_triangle.linearReload = true;
+                break;
+
+            case 0x400C:
+                m_noise.envelope.loop = t_value & 0x20;
+                m_noise.envelope.constantVolume = t_value & 0x10;
+                m_noise.envelope.period = t_value & 0x0F;
+                break;
+
+            case 0x400E:
+                m_noise.shortMode = t_value & 0x80;
+                m_noise.period = NOISE_PERIOD_TABLE[t_value & 0x0F];
+                break;
+
+            case 0x400F:
+                if (m_enabled[3]) {
+                    m_noise.lengthCounter = LENGTH_TABLE[t_value >> 3];
+                }
+                m_noise.envelope.start = true;
+                break;
+
+            case 0x4010:
+                m_dmc.irqEnabled = t_value & 0x80;
+                m_dmc.loop = t_value & 0x40;
+                m_dmc.period = DMC_PERIOD_TABLE[t_value & 0x0F];
+                if (!m_dmc.irqEnabled) {
+                    m_dmcIRQFlag = false;
+                }
+                break;
+
+            case 0x4011:
+                m_dmc.level = t_value & 0x7F;
+                break;
+
+            case 0x4012:
+                m_dmc.sampleAddress = 0xC000 + (t_value * 64);
+                break;
+
+            case 0x4013:
+                m_dmc.sampleLength = (t_value * 16) + 1;
+                break;
+
+            case 0x4015:
+                for (size_t i = 0; i < 4; i++) {
+                    m_enabled[i] = t_value & (1 << i);
+                }
+                if (!m_enabled[0]) { m_pulses[0].lengthCounter = 0; }
+                if (!m_enabled[1]) { m_pulses[1].lengthCounter = 0; }
+                if (!m_enabled[2]) { m_triangle.lengthCounter = 0; }
+                if (!m_enabled[3]) { m_noise.lengthCounter = 0; }
+
+                m_dmcIRQFlag = false;
+                if (!(t_value & 0x10)) {
+                    m_dmc.bytesRemaining = 0;
+                }
+                else if (m_dmc.bytesRemaining == 0) {
+                    restartDMC();
+                    if (!m_dmc.sampleBufferFull) {
+                        fetchDMCSample();
+                    }
+                }
+                break;
+
+            case 0x4017:
+                m_frameCounter.fiveStep = t_value & 0x80;
+                m_frameCounter.irqInhibit = t_value & 0x40;
+                if (m_frameCounter.irqInhibit) {
+                    m_frameCounter.irqFlag = false;
+                }
+
+                m_frameCounter.step = 0;
+                m_frameCounter.start = t_cycle;
+                if (m_frameCounter.fiveStep) {
+                    clockQuarterFrame();
+                    clockHalfFrame();
+                }
+                break;
+
+            default:
+                // $4009, $400D and the unused registers
+                break;
+        }
+
+        updateOutputs(t_cycle);
+        scheduleEvents();
+    }
+
+    Word APU::readStatus(uint64_t t_cycle) {
+        catchUp(t_cycle);
+
+        Word result = 0;
+        result |= (m_pulses[0].lengthCounter > 0) ? 0x01 : 0x00;
+        result |= (m_pulses[1].lengthCounter > 0) ? 0x02 : 0x00;
+        result |= (m_triangle.lengthCounter > 0) ? 0x04 : 0x00;
+        result |= (m_noise.lengthCounter > 0) ? 0x08 : 0x00;
+        result |= (m_dmc.bytesRemaining > 0) ? 0x10 : 0x00;
+        result |= m_frameCounter.irqFlag ? 0x40 : 0x00;
+        result |= m_dmcIRQFlag ? 0x80 : 0x00;
+
+        // Reading acknowledges the frame interrupt, but not the DMC one
+        m_frameCounter.irqFlag = false;
+        scheduleEvents();
+
+        return result;
+    }
+
+    void APU::catchUp(uint64_t t_cycle) {
+        ASSERT(t_cycle >= m_currentCycle, "APU can't run backwards");
+
+        while (nextFrameStepCycle() <= t_cycle) {
+            const uint64_t stepCycle = nextFrameStepCycle();
+            runChannels(stepCycle);
+            clockFrameCounter(stepCycle);
+        }
+        runChannels(t_cycle);
+
+        m_currentCycle = t_cycle;
+        scheduleEvents();
+    }
+
+    bool APU::isIRQAsserted() const {
+        return m_frameCounter.irqFlag || m_dmcIRQFlag;
+    }
+
+    void APU::endFrame(uint64_t t_cycle) {
+        ASSERT(m_synthesisEnabled, "No audio is being synthesized");
+        catchUp(t_cycle);
+
+        m_blip.endFrame(static_cast<uint32_t>(t_cycle - m_audioFrameStart));
+        m_audioFrameStart = t_cycle;
+        m_synthesizedOutput = m_mixedOutput;
+
+        // Post-process the whole frame as one block
+        m_synthesized.resize(m_blip.samplesAvailable());
+        m_synthesized.resize(m_blip.readSamples(m_synthesized.data(), m_synthesized.size()));
+
+        m_block.resize(m_synthesized.size());
+        for (size_t i = 0; i < m_block.size(); i++) {
+            m_block[i] = static_cast<float>(m_synthesized[i]) * (1.0F / MIX_UNIT);
+        }
+
+        for (FirstOrderFilter& filter : m_filters) {
+            filter.process(m_block.data(), m_block.size());
+        }
+
+        // Drop what has already been read before appending, so the queue doesn't keep growing
+        m_output.erase(m_output.begin(), m_output.begin() + m_outputRead);
+        m_outputRead = 0;
+        m_resampler.process(m_block.data(), m_block.size(), m_output);
+
+        // Nobody is listening; keep the newest samples and let the rest go
+        if (samplesAvailable() > MAX_QUEUED_SAMPLES) {
+            m_outputRead = m_output.size() - MAX_QUEUED_SAMPLES;
+        }
+    }
+
+    void APU::skipFrame(uint64_t t_cycle) {
+        catchUp(t_cycle);
+
+        // The filters and resampler never see the skipped audio, so they carry on where they left off
+        restartSynthesis();
+    }
+
+    uint64_t APU::getAudioFrameStart() const {
+        return m_audioFrameStart;
+    }
+
+    void APU::setRateAdjustment(double t_ratio) {
+        m_resampler.setRatio(t_ratio);
+    }
+
+    size_t APU::samplesAvailable() const {
+        return m_output.size() - m_outputRead;
+    }
+
+    size_t APU::readSamples(int16_t* t_output, size_t t_count) {
+        const size_t count = std::min(t_count, samplesAvailable());
+        std::copy_n(m_output.begin() + m_outputRead, count, t_output);
+        m_outputRead += count;
+
+        return count;
+    }
+
+    std::span<const int16_t> APU::takeSamples() {
+        const std::span<const int16_t> samples(m_output.data() + m_outputRead, samplesAvailable());
+        m_outputRead = m_output.size();
+
+        return samples;
+    }
+
+    void APU::runChannels(uint64_t t_until) {
+        runPulse(m_pulses[0], true, t_until);
+        runPulse(m_pulses[1], false, t_until);
+        runTriangle(t_until);
+        runNoise(t_until);
+        runDMC(t_until);
+    }
+
+    void APU::runPulse(Pulse& t_pulse, bool t_isPulse1, uint64_t t_until) {
+        if (t_pulse.nextStep >= t_until) {
+            return;
+        }
+
+        const uint64_t period = (t_pulse.timer + 1) * 2;
+
+        // A silenced channel can't change its output, so only the sequencer position has to be kept
+        if (t_pulse.lengthCounter == 0 || isPulseMuted(t_pulse, t_isPulse1) || envelopeVolume(t_pulse.envelope) == 0) {
+            const uint64_t steps = stepsUntil(t_pulse.nextStep, t_until, period);
+            t_pulse.sequencePosition = (t_pulse.sequencePosition + steps) % 8;
+            t_pulse.nextStep += steps * period;
+            return;
+        }
+
+        while (t_pulse.nextStep < t_until) {
+            t_pulse.sequencePosition = (t_pulse.sequencePosition + 1) % 8;
+            setOutput(t_pulse.output, pulseLevel(t_pulse, t_isPulse1), t_pulse.nextStep);
+            t_pulse.nextStep += period;
+        }
+    }
+
+    void APU::runTriangle(uint64_t t_until) {
+        if (m_triangle.nextStep >= t_until) {
+            return;
+        }
+
+        const uint64_t period = m_triangle.timer + 1;
+
+        // The sequencer holds its position while either counter is zero. Periods below 2 produce
+        // ultrasonic output that would only cost time to generate, so those are held as well.
+        if (m_triangle.linearCounter == 0 || m_triangle.lengthCounter == 0 || m_triangle.timer < 2) {
+            m_triangle.nextStep += stepsUntil(m_triangle.nextStep, t_until, period) * period;
+            return;
+        }
+
+        while (m_triangle.nextStep < t_until) {
+            m_triangle.sequencePosition = (m_triangle.sequencePosition + 1) % 32;
+            setOutput(m_triangle.output, triangleLevel(), m_triangle.nextStep);
+            m_triangle.nextStep += period;
+        }
+    }
+
+    void APU::runNoise(uint64_t t_until) {
+        if (m_noise.nextStep >= t_until) {
+            return;
+        }
+
+        const uint64_t period = m_noise.period;
+
+        // The shift register isn't audible while the channel is silent, so it is left where it is
+        if (m_noise.lengthCounter == 0 || envelopeVolume(m_noise.envelope) == 0) {
+            m_noise.nextStep += stepsUntil(m_noise.nextStep, t_until, period) * period;
+            return;
+        }
+
+        const size_t tap = m_noise.shortMode ? 6 : 1;
+        while (m_noise.nextStep < t_until) {
+            const uint16_t feedback = (m_noise.shiftRegister ^ (m_noise.shiftRegister >> tap)) & 0x01;
+            m_noise.shiftRegister = (m_noise.shiftRegister >> 1) | (feedback << 14);
+
+            setOutput(m_noise.output, noiseLevel(), m_noise.nextStep);
+            m_noise.nextStep += period;
+        }
+    }
+
+    void APU::runDMC(uint64_t t_until) {
+        if (m_dmc.nextStep >= t_until) {
+            return;
+        }
+
+        const uint64_t period = m_dmc.period;
+
+        // Nothing left to play: the output unit keeps counting bits but the level can't change
+        if (m_dmc.silence && !m_dmc.sampleBufferFull && m_dmc.bytesRemaining == 0) {
+            const uint64_t steps = stepsUntil(m_dmc.nextStep, t_until, period);
+            m_dmc.bitsRemaining = 8 - ((8 - m_dmc.bitsRemaining + steps) % 8);
+            m_dmc.nextStep += steps * period;
+            return;
+        }
+
+        while (m_dmc.nextStep < t_until) {
+            if (!m_dmc.silence) {
+                if (m_dmc.shiftRegister & 0x01) {
+                    if (m_dmc.level <= 125) {
+                        m_dmc.level += 2;
+                    }
+                }
+                else if (m_dmc.level >= 2) {
+                    m_dmc.level -= 2;
+                }
+                setOutput(m_dmc.output, m_dmc.level, m_dmc.nextStep);
+            }
+            m_dmc.shiftRegister >>= 1;
+
+            if (--m_dmc.bitsRemaining == 0) {
+                m_dmc.bitsRemaining = 8;
+                m_dmc.silence = !m_dmc.sampleBufferFull;
+                if (m_dmc.sampleBufferFull) {
+                    m_dmc.shiftRegister = m_dmc.sampleBuffer;
+                    m_dmc.sampleBufferFull = false;
+                    fetchDMCSample();
+                }
+            }
+
+            m_dmc.nextStep += period;
+        }
+    }
+
+    void APU::fetchDMCSample() {
+        if (m_dmc.bytesRemaining == 0 || m_memory == nullptr) {
+            return;
+        }
+
+        m_dmc.sampleBuffer = m_memory->readWord(m_dmc.currentAddress);
+        m_scheduler.stall(DMC_FETCH_STALL_CYCLES);
+        m_dmc.sampleBufferFull = true;
+        m_dmc.currentAddress = (m_dmc.currentAddress == 0xFFFF) ? 0x8000 : (m_dmc.currentAddress + 1);
+
+        if (--m_dmc.bytesRemaining == 0) {
+            if (m_dmc.loop) {
+                restartDMC();
+            }
+            else if (m_dmc.irqEnabled) {
+                m_dmcIRQFlag = true;
+            }
+        }
+    }
+
+    void APU::restartDMC() {
+        m_dmc.currentAddress = m_dmc.sampleAddress;
+        m_dmc.bytesRemaining = m_dmc.sampleLength;
+    }
+
+    void APU::clockFrameCounter(uint64_t t_cycle) {
+        const FrameStep& step = m_frameCounter.fiveStep
+            ? FIVE_STEP_SEQUENCE[m_frameCounter.step]
+            : FOUR_STEP_SEQUENCE[m_frameCounter.step];
+
+        if (step.quarterFrame) {
+            clockQuarterFrame();
+        }
+        if (step.halfFrame) {
+            clockHalfFrame();
+        }
+        if (step.irq && !m_frameCounter.irqInhibit) {
+            m_frameCounter.irqFlag = true;
+        }
+
+        const size_t stepCount = m_frameCounter.fiveStep ? FIVE_STEP_SEQUENCE.size() : FOUR_STEP_SEQUENCE.size();
+        if (++m_frameCounter.step == stepCount) {
+            m_frameCounter.step = 0;
+            m_frameCounter.start += m_frameCounter.fiveStep ? FIVE_STEP_PERIOD : FOUR_STEP_PERIOD;
+        }
+
+        updateOutputs(t_cycle);
+    }
+
+    void APU::clockQuarterFrame() {
+        clockEnvelope(m_pulses[0].envelope);
+        clockEnvelope(m_pulses[1].envelope);
+        clockEnvelope(m_noise.envelope);
+
+        if (m_triangle.linearReload) {
+            m_triangle.linearCounter = m_triangle.linearReloadValue;
+        }
+        else if (m_triangle.linearCounter > 0) {
+            m_triangle.linearCounter--;
+        }
+        if (!m_triangle.control) {
+            m_triangle.linearReload = false;
+        }
+    }
+
+    void APU::clockHalfFrame() {
+        for (size_t i = 0; i < m_pulses.size(); i++) {
+            Pulse& pulse = m_pulses[i];
+            const bool isPulse1 = (i == 0);
+
+            if (pulse.lengthCounter > 0 && !pulse.envelope.loop) {
+                pulse.lengthCounter--;
+            }
+
+            if (pulse.sweepDivider == 0 && pulse.sweepEnabled && pulse.sweepShift > 0 && !isPulseMuted(pulse, isPulse1)) {
+                pulse.timer = sweepTarget(pulse, isPulse1);
+            }
+            if (pulse.sweepDivider == 0 || pulse.sweepReload) {
+                pulse.sweepDivider = pulse.sweepPeriod;
+                pulse.sweepReload = false;
+            }
+            else {
+                pulse.sweepDivider--;
+            }
+        }
+
+        if (m_triangle.lengthCounter > 0 && !m_triangle.control) {
+            m_triangle.lengthCounter--;
+        }
+        if (m_noise.lengthCounter > 0 && !m_noise.envelope.loop) {
+            m_noise.lengthCounter--;
+        }
+    }
+
+    uint64_t APU::nextFrameStepCycle() const {
+        const FrameStep& step = m_frameCounter.fiveStep
+            ? FIVE_STEP_SEQUENCE[m_frameCounter.step]
+            : FOUR_STEP_SEQUENCE[m_frameCounter.step];
+
+        return m_frameCounter.start + step.cycle;
+    }
+
+    void APU::updateOutputs(uint64_t t_cycle) {
+        m_pulses[0].output = pulseLevel(m_pulses[0], true);
+        m_pulses[1].output = pulseLevel(m_pulses[1], false);
+        m_triangle.output = triangleLevel();
+        m_noise.output = noiseLevel();
+        m_dmc.output = m_dmc.level;
+
+        mixOutput(t_cycle);
+    }
+
+    void APU::setOutput(int32_t& t_output, int32_t t_level, uint64_t t_cycle) {
+        if (t_level != t_output) {
+            t_output = t_level;
+            mixOutput(t_cycle);
+        }
+    }
+
+    void APU::mixOutput(uint64_t t_cycle) {
+        const int32_t mixed =
+            PULSE_TABLE[m_pulses[0].output + m_pulses[1].output] +
+            TND_TABLE[3 * m_triangle.output + 2 * m_noise.output + m_dmc.output];
+
+        if (mixed != m_mixedOutput) {
+            if (m_synthesisEnabled) {
+                m_blip.addDelta(static_cast<uint32_t>(t_cycle - m_audioFrameStart), mixed - m_mixedOutput);
+            }
+            m_mixedOutput = mixed;
+        }
+    }
+
+    void APU::scheduleEvents() {
+        uint64_t irqCycle = NO_EVENT;
+
+        if (!m_frameCounter.fiveStep && !m_frameCounter.irqInhibit && !m_frameCounter.irqFlag) {
+            irqCycle = m_frameCounter.start + FOUR_STEP_SEQUENCE.back().cycle;
+        }
+
+        // The last byte is fetched when the output unit starts on the byte before it
+        if (m_dmc.irqEnabled && !m_dmc.loop && !m_dmcIRQFlag && m_dmc.bytesRemaining > 0 && m_dmc.sampleBufferFull) {
+            const uint64_t firstFetch = m_dmc.nextStep + (m_dmc.bitsRemaining - 1) * m_dmc.period;
+            const uint64_t lastFetch = firstFetch + (m_dmc.bytesRemaining - 1) * 8 * m_dmc.period;
+
+            // Channels only run steps that come before the cycle they are caught up to
+            irqCycle = std::min(irqCycle, lastFetch + 1);
+        }
+
+        // Fetches stall the CPU, so the DMC is caught up to each one as it happens
+        uint64_t fetchCycle = NO_EVENT;
+        if (m_dmc.bytesRemaining > 0 && m_dmc.sampleBufferFull) {
+            fetchCycle = m_dmc.nextStep + (m_dmc.bitsRemaining - 1) * m_dmc.period + 1;
+        }
+
+        // Never schedule into the past, or a misprediction would fire forever
+        if (irqCycle != NO_EVENT) {
+            irqCycle = std::max(irqCycle, m_currentCycle + 1);
+        }
+        if (fetchCycle != NO_EVENT) {
+            fetchCycle = std::max(fetchCycle, m_currentCycle + 1);
+        }
+        m_scheduler.schedule(Event::APU_IRQ, irqCycle);
+        m_scheduler.schedule(Event::DMC_FETCH, fetchCycle);
+    }
+
+    int32_t APU::pulseLevel(const Pulse& t_pulse, bool t_isPulse1) const {
+        if (t_pulse.lengthCounter == 0 || isPulseMuted(t_pulse, t_isPulse1)) {
+            return 0;
+        }
+
+        return DUTY_TABLE[t_pulse.duty][t_pulse.sequencePosition] ? envelopeVolume(t_pulse.envelope) : 0;
+    }
+
+    int32_t APU::triangleLevel() const {
+        return TRIANGLE_TABLE[m_triangle.sequencePosition];
+    }
+
+    int32_t APU::noiseLevel() const {
+        if (m_noise.lengthCounter == 0 || (m_noise.shiftRegister & 0x01)) {
+            return 0;
+        }
+
+        return envelopeVolume(m_noise.envelope);
+    }
+
+    template<typename Stream, typename EnvelopeState>
+    static void transferEnvelope(Stream& t_stream, EnvelopeState& t_envelope) {
+        t_stream.value(t_envelope.start);
+        t_stream.value(t_envelope.loop);
+        t_stream.value(t_envelope.constantVolume);
+        t_stream.value(t_envelope.period);
+        t_stream.value(t_envelope.divider);
+        t_stream.value(t_envelope.decay);
+    }
+
+    template<typename Stream, typename Self>
+    void APU::transferState(Stream& t_stream, Self& t_self) {
+        for (auto& pulse : t_self.m_pulses) {
+            t_stream.value(pulse.duty);
+            t_stream.value(pulse.sequencePosition);
+            t_stream.value(pulse.timer);
+            t_stream.value(pulse.lengthCounter);
+            transferEnvelope(t_stream, pulse.envelope);
+            t_stream.value(pulse.sweepEnabled);
+            t_stream.value(pulse.sweepNegate);
+            t_stream.value(pulse.sweepReload);
+            t_stream.value(pulse.sweepPeriod);
+            t_stream.value(pulse.sweepShift);
+            t_stream.value(pulse.sweepDivider);
+            t_stream.value(pulse.nextStep);
+            t_stream.value(pulse.output);
+        }
+
+        auto& triangle = t_self.m_triangle;
+        t_stream.value(triangle.control);
+        t_stream.value(triangle.linearReload);
+        t_stream.value(triangle.linearReloadValue);
+        t_stream.value(triangle.linearCounter);
+        t_stream.value(triangle.sequencePosition);
+        t_stream.value(triangle.timer);
+        t_stream.value(triangle.lengthCounter);
+        t_stream.value(triangle.nextStep);
+        t_stream.value(triangle.output);
+
+        auto& noise = t_self.m_noise;
+        t_stream.value(noise.shortMode);
+        t_stream.value(noise.shiftRegister);
+        t_stream.value(noise.period);
+        t_stream.value(noise.lengthCounter);
+        transferEnvelope(t_stream, noise.envelope);
+        t_stream.value(noise.nextStep);
+        t_stream.value(noise.output);
+
+        auto& dmc = t_self.m_dmc;
+        t_stream.value(dmc.irqEnabled);
+        t_stream.value(dmc.loop);
+        t_stream.value(dmc.period);
+        t_stream.value(dmc.level);
+        t_stream.value(dmc.sampleAddress);
+        t_stream.value(dmc.sampleLength);
+        t_stream.value(dmc.currentAddress);
+        t_stream.value(dmc.bytesRemaining);
+        t_stream.value(dmc.sampleBuffer);
+        t_stream.value(dmc.sampleBufferFull);
+        t_stream.value(dmc.shiftRegister);
+        t_stream.value(dmc.bitsRemaining);
+        t_stream.value(dmc.silence);
+        t_stream.value(dmc.nextStep);
+        t_stream.value(dmc.output);
+
+        for (auto& enabled : t_self.m_enabled) {
+            t_stream.value(enabled);
+        }
+
+        auto& frameCounter = t_self.m_frameCounter;
+        t_stream.value(frameCounter.fiveStep);
+        t_stream.value(frameCounter.irqInhibit);
+        t_stream.value(frameCounter.irqFlag);
+        t_stream.value(frameCounter.step);
+        t_stream.value(frameCounter.start);
+
+        t_stream.value(t_self.m_dmcIRQFlag);
+        t_stream.value(t_self.m_mixedOutput);
+        t_stream.value(t_self.m_currentCycle);
+    }
+
+    void APU::saveState(StateWriter& t_writer) const {
+        transferState(t_writer, *this);
+    }
+
+    void APU::loadState(StateReader& t_reader) {
+        transferState(t_reader, *this);
+        restartSynthesis();
+    }
+
+    void APU::restartSynthesis() {
+        // A new audio frame at the current cycle, carrying on from the audio handed out last. Only a
+        // change of level since then makes a step, so loading the state a frame ended in is silent.
+        m_audioFrameStart = m_currentCycle;
+        if (m_synthesisEnabled) {
+            m_blip.discardFrame();
+            m_blip.addDelta(0, m_mixedOutput - m_synthesizedOutput);
+        }
+    }
+
+}
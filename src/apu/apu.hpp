@@ -0,0 +1,216 @@
+#ifndef RNES_APU_INCLUDED
+#define RNES_APU_INCLUDED
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include "defines.hpp"
+#include "save_state.hpp"
+#include "scheduler.hpp"
+#include "apu/audio_filter.hpp"
+#include "apu/blip_buffer.hpp"
+#include "apu/resampler.hpp"
+#include "cpu/cpu_memory_map.hpp"
+
+namespace RNES::APU {
+
+    static const double CPU_CLOCK_RATE = 1789773.0;
+    static const double SAMPLE_RATE = 48000.0;
+
+    // Longest stretch of CPU cycles allowed between two calls to endFrame()
+    static const size_t MAX_FRAME_CYCLES = 0x10000;
+
+    // Output samples kept when they aren't being read, such as when running headless
+    static const size_t MAX_QUEUED_SAMPLES = 8192;
+
+    /* The channels are not clocked every cycle. Each one remembers the cycle its timer next expires
+     * and is only run forward when something could observe it: a register access, a frame counter
+     * step or the end of a frame. Changes in the mixed output are written to a BlipBuffer as they
+     * happen, and each frame is filtered and resampled to SAMPLE_RATE as a block in endFrame().
+     */
+    class APU {
+    public:
+        explicit APU(Scheduler& t_scheduler);
+
+        // Used by the DMC to fetch sample bytes
+        void setMemory(const CPU::CPUMemoryMap* t_memory);
+
+        /* Synthesis is off until something listens. The channels run exactly the same either way,
+         * but without it no waveform is built and endFrame() can't be used, only skipFrame(), and
+         * the buffers for it aren't allocated.
+         */
+        void setSynthesisEnabled(bool t_enabled);
+        [[nodiscard]] bool isSynthesisEnabled() const;
+
+        void writeRegister(Address t_address, Word t_value, uint64_t t_cycle);
+        [[nodiscard]] Word readStatus(uint64_t t_cycle);
+
+        // Runs every channel up to t_cycle, raising any interrupts that happen along the way
+        void catchUp(uint64_t t_cycle);
+
+        [[nodiscard]] bool isIRQAsserted() const;
+
+        // Makes the samples generated up to t_cycle available for reading
+        void endFrame(uint64_t t_cycle);
+        // Runs up to t_cycle like endFrame(), but throws the frame's audio away without processing it
+        void skipFrame(uint64_t t_cycle);
+
+        // The cycle the audio not yet passed to endFrame() or skipFrame() starts at
+        [[nodiscard]] uint64_t getAudioFrameStart() const;
+
+        // Scales the output sample rate, for dynamic rate control. Only takes effect between frames.
+        void setRateAdjustment(double t_ratio);
+
+        [[nodiscard]] size_t samplesAvailable() const;
+        size_t readSamples(int16_t* t_output, size_t t_count);
+        // Marks every available sample as read and returns them. Valid until the next endFrame().
+        std::span<const int16_t> takeSamples();
+
+        /* The channels and frame counter. Audio already synthesized isn't part of the state, so
+         * loading one starts a new audio frame at the loaded cycle.
+         */
+        void saveState(StateWriter& t_writer) const;
+        void loadState(StateReader& t_reader);
+
+    private:
+        struct Envelope {
+            bool start;
+            bool loop; // doubles as the length counter halt flag
+            bool constantVolume;
+            uint8_t period;
+            uint8_t divider;
+            uint8_t decay;
+        };
+
+        struct Pulse {
+            uint8_t duty;
+            uint8_t sequencePosition;
+            uint16_t timer;
+            uint8_t lengthCounter;
+            Envelope envelope;
+
+            bool sweepEnabled;
+            bool sweepNegate;
+            bool sweepReload;
+            uint8_t sweepPeriod;
+            uint8_t sweepShift;
+            uint8_t sweepDivider;
+
+            uint64_t nextStep;
+            int32_t output;
+        };
+
+        struct Triangle {
+            bool control; // doubles as the length counter halt flag
+            bool linearReload;
+            uint8_t linearReloadValue;
+            uint8_t linearCounter;
+            uint8_t sequencePosition;
+            uint16_t timer;
+            uint8_t lengthCounter;
+
+            uint64_t nextStep;
+            int32_t output;
+        };
+
+        struct Noise {
+            bool shortMode;
+            uint16_t shiftRegister;
+            uint16_t period;
+            uint8_t lengthCounter;
+            Envelope envelope;
+
+            uint64_t nextStep;
+            int32_t output;
+        };
+
+        struct DMC {
+            bool irqEnabled;
+            bool loop;
+            uint16_t period;
+            uint8_t level;
+
+            Address sampleAddress;
+            uint16_t sampleLength;
+            Address currentAddress;
+            uint16_t bytesRemaining;
+
+            uint8_t sampleBuffer;
+            bool sampleBufferFull;
+            uint8_t shiftRegister;
+            uint8_t bitsRemaining;
+            bool silence;
+
+            uint64_t nextStep;
+            int32_t output;
+        };
+
+        void runChannels(uint64_t t_until);
+        void runPulse(Pulse& t_pulse, bool t_isPulse1, uint64_t t_until);
+        void runTriangle(uint64_t t_until);
+        void runNoise(uint64_t t_until);
+        void runDMC(uint64_t t_until);
+
+        void fetchDMCSample();
+        void restartDMC();
+
+        void clockFrameCounter(uint64_t t_cycle);
+        void clockQuarterFrame();
+        void clockHalfFrame();
+        [[nodiscard]] uint64_t nextFrameStepCycle() const;
+
+        // Recomputes the level of every channel and records any change at t_cycle
+        void updateOutputs(uint64_t t_cycle);
+        void setOutput(int32_t& t_output, int32_t t_level, uint64_t t_cycle);
+        void mixOutput(uint64_t t_cycle);
+        void restartSynthesis();
+
+        // Schedules the next interrupt and the next DMC fetch
+        void scheduleEvents();
+
+        [[nodiscard]] int32_t pulseLevel(const Pulse& t_pulse, bool t_isPulse1) const;
+        [[nodiscard]] int32_t triangleLevel() const;
+        [[nodiscard]] int32_t noiseLevel() const;
+
+        // Visits every saved field, for both saving (const APU) and loading
+        template<typename Stream, typename Self>
+        static void transferState(Stream& t_stream, Self& t_self);
+
+        Scheduler& m_scheduler;
+        const CPU::CPUMemoryMap* m_memory;
+        BlipBuffer m_blip;
+        std::array<FirstOrderFilter, 3> m_filters;
+        PolyphaseResampler m_resampler;
+
+        std::vector<int16_t> m_synthesized;
+        std::vector<float> m_block;
+        std::vector<int16_t> m_output;
+        size_t m_outputRead;
+        bool m_synthesisEnabled;
+        int32_t m_mixedOutput;
+        int32_t m_synthesizedOutput; // the level at the end of the audio last handed out
+
+        uint64_t m_currentCycle;
+        uint64_t m_audioFrameStart;
+
+        std::array<Pulse, 2> m_pulses;
+        Triangle m_triangle;
+        Noise m_noise;
+        DMC m_dmc;
+        std::array<bool, 4> m_enabled; // length counter enables from $4015, the DMC uses bytesRemaining
+
+        struct {
+            bool fiveStep;
+            bool irqInhibit;
+            bool irqFlag;
+            size_t step;
+            uint64_t start;
+        } m_frameCounter;
+
+        bool m_dmcIRQFlag;
+    };
+
+}
+
+#endif
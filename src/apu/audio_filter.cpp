@@ -0,0 +1,75 @@
+#include <numbers>
+
+#include "audio_filter.hpp"
+#include "simd.hpp"
+
+namespace RNES::APU {
+
+    FirstOrderFilter FirstOrderFilter::highPass(double t_cutoff, double t_sampleRate) {
+        const double rc = 1.0 / (2.0 * std::numbers::pi * t_cutoff);
+        const float a = static_cast<float>(rc / (rc + 1.0 / t_sampleRate));
+
+        return { a, -a, a };
+    }
+
+    FirstOrderFilter FirstOrderFilter::lowPass(double t_cutoff, double t_sampleRate) {
+        const double rc = 1.0 / (2.0 * std::numbers::pi * t_cutoff);
+        const float alpha = static_cast<float>((1.0 / t_sampleRate) / (rc + 1.0 / t_sampleRate));
+
+        return { alpha, 0.0F, 1.0F - alpha };
+    }
+
+    FirstOrderFilter::FirstOrderFilter(float t_b0, float t_b1, float t_a1)
+        : m_b0(t_b0)
+        , m_b1(t_b1)
+        , m_a1(t_a1)
+        , m_previousInput(0.0F)
+        , m_previousOutput(0.0F)
+    {
+        ;
+    }
+
+    void FirstOrderFilter::process(float* t_samples, size_t t_count) {
+        /* The recursion is solved four samples at a time. With u[n] = b0 * x[n] + b1 * x[n - 1]
+         * computed for the whole vector, the outputs are a prefix sum of u weighted by powers of a1,
+         * plus the previous output carried in through a1, a1^2, a1^3 and a1^4.
+         */
+        const float a = m_a1;
+        const Float4 a1 = broadcastFloat4(a);
+        const Float4 a2 = broadcastFloat4(a * a);
+        const Float4 carry = { a, a * a, a * a * a, a * a * a * a };
+        const Float4 b0 = broadcastFloat4(m_b0);
+        const Float4 b1 = broadcastFloat4(m_b1);
+
+        float previousInput = m_previousInput;
+        float previousOutput = m_previousOutput;
+
+        size_t i = 0;
+        for (; i + 4 <= t_count; i += 4) {
+            const Float4 x = loadFloat4(t_samples + i);
+            const Float4 xDelayed = { previousInput, x[0], x[1], x[2] };
+
+            Float4 y = b0 * x + b1 * xDelayed;
+            y += a1 * Float4{ 0.0F, y[0], y[1], y[2] };
+            y += a2 * Float4{ 0.0F, 0.0F, y[0], y[1] };
+            y += carry * broadcastFloat4(previousOutput);
+
+            storeFloat4(t_samples + i, y);
+            previousInput = x[3];
+            previousOutput = y[3];
+        }
+
+        for (; i < t_count; i++) {
+            const float x = t_samples[i];
+            const float y = m_b0 * x + m_b1 * previousInput + a * previousOutput;
+
+            t_samples[i] = y;
+            previousInput = x;
+            previousOutput = y;
+        }
+
+        m_previousInput = previousInput;
+        m_previousOutput = previousOutput;
+    }
+
+}
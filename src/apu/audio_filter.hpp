@@ -0,0 +1,31 @@
+#ifndef RNES_AUDIO_FILTER_INCLUDED
+#define RNES_AUDIO_FILTER_INCLUDED
+
+#include "defines.hpp"
+
+namespace RNES::APU {
+
+    /* A first order IIR filter, y[n] = b0 * x[n] + b1 * x[n - 1] + a1 * y[n - 1], run over blocks
+     * of samples in place.
+     */
+    class FirstOrderFilter {
+    public:
+        static FirstOrderFilter highPass(double t_cutoff, double t_sampleRate);
+        static FirstOrderFilter lowPass(double t_cutoff, double t_sampleRate);
+
+        void process(float* t_samples, size_t t_count);
+
+    private:
+        FirstOrderFilter(float t_b0, float t_b1, float t_a1);
+
+        float m_b0;
+        float m_b1;
+        float m_a1;
+
+        float m_previousInput;
+        float m_previousOutput;
+    };
+
+}
+
+#endif
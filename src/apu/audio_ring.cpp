@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <bit>
+
+#include "audio_ring.hpp"
+
+namespace RNES::APU {
+
+    AudioRing::AudioRing(size_t t_capacity)
+        : m_buffer(std::bit_ceil(t_capacity), 0)
+        , m_mask(m_buffer.size() - 1)
+        , m_writeIndex(0)
+        , m_readIndex(0)
+    {
+        ;
+    }
+
+    size_t AudioRing::write(const int16_t* t_samples, size_t t_count) {
+        const size_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+        const size_t readIndex = m_readIndex.load(std::memory_order_acquire);
+
+        const size_t count = std::min(t_count, m_buffer.size() - (writeIndex - readIndex));
+        for (size_t i = 0; i < count; i++) {
+            m_buffer[(writeIndex + i) & m_mask] = t_samples[i];
+        }
+
+        m_writeIndex.store(writeIndex + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t AudioRing::read(int16_t* t_samples, size_t t_count) {
+        const size_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+        const size_t writeIndex = m_writeIndex.load(std::memory_order_acquire);
+
+        const size_t count = std::min(t_count, writeIndex - readIndex);
+        for (size_t i = 0; i < count; i++) {
+            t_samples[i] = m_buffer[(readIndex + i) & m_mask];
+        }
+
+        m_readIndex.store(readIndex + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t AudioRing::size() const {
+        return m_writeIndex.load(std::memory_order_acquire) - m_readIndex.load(std::memory_order_acquire);
+    }
+
+    size_t AudioRing::capacity() const {
+        return m_buffer.size();
+    }
+
+}
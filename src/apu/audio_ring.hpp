@@ -0,0 +1,42 @@
+#ifndef RNES_AUDIO_RING_INCLUDED
+#define RNES_AUDIO_RING_INCLUDED
+
+#include <atomic>
+#include <vector>
+
+#include "defines.hpp"
+
+namespace RNES::APU {
+
+    /* A lock-free ring of samples for exactly one producer thread (the emulator) and one consumer
+     * thread (the audio callback). Neither side ever blocks: write() stores as much as fits and
+     * read() returns as much as is available.
+     */
+    class AudioRing {
+    public:
+        // t_capacity is rounded up to a power of two
+        explicit AudioRing(size_t t_capacity);
+
+        AudioRing(const AudioRing&) = delete;
+        AudioRing& operator=(const AudioRing&) = delete;
+
+        size_t write(const int16_t* t_samples, size_t t_count);
+        size_t read(int16_t* t_samples, size_t t_count);
+
+        // Only exact when called from one of the two threads using the ring
+        [[nodiscard]] size_t size() const;
+        [[nodiscard]] size_t capacity() const;
+
+    private:
+        std::vector<int16_t> m_buffer;
+        size_t m_mask;
+
+        // The indices only ever increase and are wrapped with m_mask when used.
+        // Each one lives on its own cache line so the two threads don't contend for it.
+        alignas(64) std::atomic<size_t> m_writeIndex;
+        alignas(64) std::atomic<size_t> m_readIndex;
+    };
+
+}
+
+#endif
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+
+#include "assert.hpp"
+#include "blip_buffer.hpp"
+
+namespace RNES::APU {
+
+    static const size_t PHASE_BITS = 5;
+    static const size_t PHASE_COUNT = 1 << PHASE_BITS;
+    static const size_t KERNEL_WIDTH = 16;
+
+    static const int32_t KERNEL_UNIT_BITS = 15;
+    static const int32_t KERNEL_UNIT = 1 << KERNEL_UNIT_BITS;
+
+    using Kernel = std::array<std::array<int32_t, KERNEL_WIDTH>, PHASE_COUNT>;
+
+    // Blackman windowed sinc, one row for each sub-sample position a step can start at
+    static Kernel createKernel() {
+        const double cutoff = 0.9; // fraction of the output Nyquist frequency
+        const double halfWidth = KERNEL_WIDTH / 2.0;
+
+        Kernel kernel{};
+        for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+            std::array<double, KERNEL_WIDTH> taps{};
+            double sum = 0.0;
+
+            for (size_t i = 0; i < KERNEL_WIDTH; i++) {
+                const double x = static_cast<double>(i) - (halfWidth - 1.0) - static_cast<double>(phase) / PHASE_COUNT;
+                const double sinc = (x == 0.0) ? 1.0 : std::sin(std::numbers::pi * cutoff * x) / (std::numbers::pi * cutoff * x);
+                const double window = 0.42 + 0.5 * std::cos(std::numbers::pi * x / halfWidth) + 0.08 * std::cos(2.0 * std::numbers::pi * x / halfWidth);
+
+                taps[i] = sinc * std::max(window, 0.0);
+                sum += taps[i];
+            }
+
+            // Every row has to add up to exactly one unit or the integrator drifts
+            int32_t total = 0;
+            for (size_t i = 0; i < KERNEL_WIDTH; i++) {
+                kernel[phase][i] = static_cast<int32_t>(std::lround(taps[i] / sum * KERNEL_UNIT));
+                total += kernel[phase][i];
+            }
+            kernel[phase][KERNEL_WIDTH / 2 - 1] += KERNEL_UNIT - total;
+        }
+
+        return kernel;
+    }
+
+    static const Kernel KERNEL = createKernel();
+
+    BlipBuffer::BlipBuffer(double t_clockRate, double t_sampleRate, size_t t_maxFrameClocks)
+        : m_factor(0)
+        , m_offset(0)
+        , m_integrator(0)
+        , m_capacity(0)
+        , m_buffer()
+        , m_usedEnd(0)
+        , m_readTail()
+        , m_readOffset(0)
+    {
+        setRates(t_clockRate, t_sampleRate);
+
+        // Room for two frames, so one can be left unread while the next is generated
+        const size_t maxFrameSamples = static_cast<size_t>(std::ceil(t_maxFrameClocks * t_sampleRate / t_clockRate));
+        m_capacity = 2 * maxFrameSamples + KERNEL_WIDTH + 1;
+    }
+
+    void BlipBuffer::allocate() {
+        if (m_buffer.empty()) {
+            m_buffer.resize(m_capacity, 0);
+            m_usedEnd = 0;
+        }
+    }
+
+    void BlipBuffer::release() {
+        m_buffer = {};
+        m_offset = 0;
+        m_integrator = 0;
+        m_usedEnd = 0;
+        m_readTail = {};
+        m_readOffset = 0;
+    }
+
+    void BlipBuffer::setRates(double t_clockRate, double t_sampleRate) {
+        m_factor = static_cast<uint64_t>(std::llround(t_sampleRate / t_clockRate * 4294967296.0));
+    }
+
+    void BlipBuffer::addDelta(uint32_t t_clockTime, int32_t t_delta) {
+        const uint64_t position = t_clockTime * m_factor + m_offset;
+        const size_t index = position >> 32;
+        const size_t phase = (position >> (32 - PHASE_BITS)) & (PHASE_COUNT - 1);
+        ASSERT(index + KERNEL_WIDTH <= m_buffer.size(), "Blip buffer overflow");
+
+        int32_t* output = m_buffer.data() + index;
+        const std::array<int32_t, KERNEL_WIDTH>& kernel = KERNEL[phase];
+        for (size_t i = 0; i < KERNEL_WIDTH; i++) {
+            output[i] += kernel[i] * t_delta;
+        }
+        m_usedEnd = std::max(m_usedEnd, index + KERNEL_WIDTH);
+    }
+
+    void BlipBuffer::endFrame(uint32_t t_clocks) {
+        m_offset += t_clocks * m_factor;
+        ASSERT((m_offset >> 32) + KERNEL_WIDTH <= m_buffer.size(), "Blip buffer overflow");
+    }
+
+    size_t BlipBuffer::samplesAvailable() const {
+        return m_offset >> 32;
+    }
+
+    size_t BlipBuffer::readSamples(int16_t* t_output, size_t t_count) {
+        const size_t count = std::min(t_count, samplesAvailable());
+
+        int32_t integrator = m_integrator;
+        for (size_t i = 0; i < count; i++) {
+            integrator += m_buffer[i];
+            t_output[i] = static_cast<int16_t>(std::clamp(integrator >> KERNEL_UNIT_BITS, -32768, 32767));
+        }
+        m_integrator = integrator;
+
+        // Keep the unread samples and the tails of steps that spill past them
+        const size_t remaining = samplesAvailable() - count + KERNEL_WIDTH;
+        std::copy(m_buffer.begin() + count, m_buffer.begin() + count + remaining, m_buffer.begin());
+        std::fill(m_buffer.begin() + remaining, m_buffer.begin() + count + remaining, 0);
+        m_usedEnd = remaining;
+
+        m_offset -= static_cast<uint64_t>(count) << 32;
+        m_readTail.assign(m_buffer.begin(), m_buffer.begin() + remaining);
+        m_readOffset = m_offset;
+        return count;
+    }
+
+    void BlipBuffer::discardFrame() {
+        std::fill(m_buffer.begin(), m_buffer.begin() + m_usedEnd, 0);
+        std::copy(m_readTail.begin(), m_readTail.end(), m_buffer.begin());
+        m_usedEnd = m_readTail.size();
+        m_offset = m_readOffset;
+    }
+
+}
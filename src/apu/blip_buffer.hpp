@@ -0,0 +1,50 @@
+#ifndef RNES_BLIP_BUFFER_INCLUDED
+#define RNES_BLIP_BUFFER_INCLUDED
+
+#include <vector>
+
+#include "defines.hpp"
+
+namespace RNES::APU {
+
+    /* Band-limited step synthesis. Instead of evaluating the waveform every clock, callers add
+     * the change in amplitude at the clock it happens; each change is spread over a few output
+     * samples with a windowed sinc step and the samples are recovered by integrating.
+     */
+    class BlipBuffer {
+    public:
+        BlipBuffer(double t_clockRate, double t_sampleRate, size_t t_maxFrameClocks);
+
+        // The samples are only allocated on request, and can be freed again while they aren't used
+        void allocate();
+        void release();
+
+        void setRates(double t_clockRate, double t_sampleRate);
+
+        // t_clockTime is relative to the start of the current frame
+        void addDelta(uint32_t t_clockTime, int32_t t_delta);
+        void endFrame(uint32_t t_clocks);
+
+        [[nodiscard]] size_t samplesAvailable() const;
+        size_t readSamples(int16_t* t_output, size_t t_count);
+
+        // Drops every delta added since samples were last read, keeping the integrator and the tails
+        // of the steps read before, so synthesis carries on from the level it had reached
+        void discardFrame();
+
+    private:
+        uint64_t m_factor; // output samples per clock, 32.32 fixed point
+        uint64_t m_offset; // start of the current frame in output samples, 32.32 fixed point
+        int32_t m_integrator;
+        size_t m_capacity;
+        std::vector<int32_t> m_buffer;
+        size_t m_usedEnd; // everything from here on is zero, so clearing can stop here
+
+        // The buffer and offset as they were left by the last read
+        std::vector<int32_t> m_readTail;
+        uint64_t m_readOffset;
+    };
+
+}
+
+#endif
@@ -0,0 +1,33 @@
+#include <algorithm>
+
+#include "rate_control.hpp"
+
+namespace RNES::APU {
+
+    // Fill levels are sampled once a frame and jitter with the audio callback's period, so the
+    // controller works on a running average rather than the raw value
+    static const double FILL_SMOOTHING = 0.1;
+
+    RateController::RateController(size_t t_targetFill, double t_maxAdjustment)
+        : m_targetFill(static_cast<double>(t_targetFill))
+        , m_maxAdjustment(t_maxAdjustment)
+        , m_averageFill(static_cast<double>(t_targetFill))
+        , m_ratio(1.0)
+    {
+        ;
+    }
+
+    double RateController::update(size_t t_fill) {
+        m_averageFill += (static_cast<double>(t_fill) - m_averageFill) * FILL_SMOOTHING;
+
+        const double error = std::clamp((m_targetFill - m_averageFill) / m_targetFill, -1.0, 1.0);
+        m_ratio = 1.0 + error * m_maxAdjustment;
+
+        return m_ratio;
+    }
+
+    double RateController::ratio() const {
+        return m_ratio;
+    }
+
+}
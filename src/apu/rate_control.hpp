@@ -0,0 +1,31 @@
+#ifndef RNES_RATE_CONTROL_INCLUDED
+#define RNES_RATE_CONTROL_INCLUDED
+
+#include "defines.hpp"
+
+namespace RNES::APU {
+
+    /* Dynamic rate control. The emulator runs at the display's pace, which never quite matches the
+     * audio device's clock, so instead of dropping or repeating samples the resampling ratio is
+     * nudged by a fraction of a percent: slightly more samples per frame while the output buffer is
+     * below its target fill, slightly fewer while it is above it.
+     */
+    class RateController {
+    public:
+        RateController(size_t t_targetFill, double t_maxAdjustment);
+
+        // Takes the current fill of the output buffer and returns the new ratio, around 1.0
+        double update(size_t t_fill);
+
+        [[nodiscard]] double ratio() const;
+
+    private:
+        double m_targetFill;
+        double m_maxAdjustment;
+        double m_averageFill;
+        double m_ratio;
+    };
+
+}
+
+#endif
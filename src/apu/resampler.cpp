@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numbers>
+
+#include "resampler.hpp"
+#include "simd.hpp"
+
+namespace RNES::APU {
+
+    static const size_t PHASE_BITS = 7;
+    static const size_t PHASE_COUNT = 1 << PHASE_BITS;
+    static const size_t TAP_COUNT = 16; // a multiple of the vector width
+
+    // Passband edge; everything above is attenuated before it can alias into the audible range
+    static const double CUTOFF_FREQUENCY = 20000.0;
+
+    // PHASE_COUNT rows of TAP_COUNT taps
+    static std::vector<float> createFilterBank(double t_inputRate) {
+        const double cutoff = std::min(CUTOFF_FREQUENCY / t_inputRate, 0.5);
+        const double halfWidth = TAP_COUNT / 2.0;
+
+        std::vector<float> bank(PHASE_COUNT * TAP_COUNT);
+        for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+            double sum = 0.0;
+            std::array<double, TAP_COUNT> taps{};
+
+            for (size_t i = 0; i < TAP_COUNT; i++) {
+                const double x = static_cast<double>(i) - (halfWidth - 1.0) - static_cast<double>(phase) / PHASE_COUNT;
+                const double arg = 2.0 * std::numbers::pi * cutoff * x;
+                const double sinc = (x == 0.0) ? 1.0 : std::sin(arg) / arg;
+                const double window = 0.42 + 0.5 * std::cos(std::numbers::pi * x / halfWidth) + 0.08 * std::cos(2.0 * std::numbers::pi * x / halfWidth);
+
+                taps[i] = sinc * std::max(window, 0.0);
+                sum += taps[i];
+            }
+
+            // Unity gain at DC for every phase
+            for (size_t i = 0; i < TAP_COUNT; i++) {
+                bank[phase * TAP_COUNT + i] = static_cast<float>(taps[i] / sum);
+            }
+        }
+
+        return bank;
+    }
+
+    // The bank only depends on the input rate, which every console shares, and building it costs
+    // far more than the rest of a console put together
+    static std::shared_ptr<const std::vector<float>> getFilterBank(double t_inputRate) {
+        static std::mutex s_cacheMutex;
+        static std::map<double, std::shared_ptr<const std::vector<float>>> s_cache;
+
+        const std::lock_guard<std::mutex> lock(s_cacheMutex);
+        auto& bank = s_cache[t_inputRate];
+        if (bank == nullptr) {
+            bank = std::make_shared<const std::vector<float>>(createFilterBank(t_inputRate));
+        }
+        return bank;
+    }
+
+    static float applyTaps(const float* t_input, const float* t_taps) {
+        Float4 sum = broadcastFloat4(0.0F);
+        for (size_t i = 0; i < TAP_COUNT; i += 4) {
+            sum += loadFloat4(t_input + i) * loadFloat4(t_taps + i);
+        }
+
+        return horizontalSum(sum);
+    }
+
+    PolyphaseResampler::PolyphaseResampler(double t_inputRate, double t_outputRate)
+        : m_inputRate(t_inputRate)
+        , m_outputRate(t_outputRate)
+        , m_step(0)
+        , m_position(0)
+        , m_taps(getFilterBank(t_inputRate))
+        , m_history(TAP_COUNT - 1, 0.0F)
+    {
+        setRatio(1.0);
+    }
+
+    void PolyphaseResampler::setRatio(double t_ratio) {
+        m_step = static_cast<uint64_t>(std::llround(m_inputRate / (m_outputRate * t_ratio) * 4294967296.0));
+    }
+
+    void PolyphaseResampler::process(const float* t_input, size_t t_count, std::vector<int16_t>& t_output) {
+        m_history.insert(m_history.end(), t_input, t_input + t_count);
+
+        while ((m_position >> 32) + TAP_COUNT <= m_history.size()) {
+            const size_t index = m_position >> 32;
+            const size_t phase = (m_position >> (32 - PHASE_BITS)) & (PHASE_COUNT - 1);
+
+            const float sample = applyTaps(m_history.data() + index, m_taps->data() + phase * TAP_COUNT);
+            t_output.push_back(static_cast<int16_t>(std::clamp(std::lround(sample * 32767.0F), -32768L, 32767L)));
+
+            m_position += m_step;
+        }
+
+        const size_t consumed = std::min(static_cast<size_t>(m_position >> 32), m_history.size());
+        m_history.erase(m_history.begin(), m_history.begin() + consumed);
+        m_position -= static_cast<uint64_t>(consumed) << 32;
+    }
+
+}
@@ -0,0 +1,40 @@
+#ifndef RNES_RESAMPLER_INCLUDED
+#define RNES_RESAMPLER_INCLUDED
+
+#include <memory>
+#include <vector>
+
+#include "defines.hpp"
+
+namespace RNES::APU {
+
+    /* Converts between two fixed sample rates with a bank of windowed sinc filters, one for each
+     * sub-sample position an output can fall at. The ratio can be nudged at run time for dynamic
+     * rate control.
+     */
+    class PolyphaseResampler {
+    public:
+        PolyphaseResampler(double t_inputRate, double t_outputRate);
+
+        // Values above 1.0 produce more output samples for the same input
+        void setRatio(double t_ratio);
+
+        // Consumes the block and appends every output sample it completes to t_output
+        void process(const float* t_input, size_t t_count, std::vector<int16_t>& t_output);
+
+    private:
+        double m_inputRate;
+        double m_outputRate;
+
+        uint64_t m_step; // input samples per output sample, 32.32 fixed point
+        uint64_t m_position; // of the next output sample within m_history, 32.32 fixed point
+
+        std::shared_ptr<const std::vector<float>> m_taps; // shared by every resampler with the same input rate
+
+        // Input that hasn't been fully used yet, including the filter's look-behind
+        std::vector<float> m_history;
+    };
+
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef RNES_SIMD_INCLUDED
+#define RNES_SIMD_INCLUDED
+
+#include <cstring>
+
+namespace RNES::APU {
+
+    /* Four floats in one vector register, using the compiler's vector extensions so the same code
+     * maps to SSE on x86 and NEON on ARM.
+     */
+    using Float4 = float __attribute__((vector_size(16)));
+
+    inline Float4 loadFloat4(const float* t_source) {
+        Float4 result;
+        std::memcpy(&result, t_source, sizeof(result));
+        return result;
+    }
+
+    inline void storeFloat4(float* t_destination, Float4 t_value) {
+        std::memcpy(t_destination, &t_value, sizeof(t_value));
+    }
+
+    inline Float4 broadcastFloat4(float t_value) {
+        return Float4{ t_value, t_value, t_value, t_value };
+    }
+
+    inline float horizontalSum(Float4 t_value) {
+        return (t_value[0] + t_value[1]) + (t_value[2] + t_value[3]);
+    }
+
+}
+
+#endif
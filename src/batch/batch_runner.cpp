@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "batch_runner.hpp"
+#include "console.hpp"
+#include "hash.hpp"
+#include "batch/state_cache.hpp"
+#include "output/video_sink.hpp"
+
+namespace RNES::Batch {
+
+    using Clock = std::chrono::steady_clock;
+
+    /* A worker's share of the job indices. The owner takes from the back and thieves from the front,
+     * so they only meet on the last job. Jobs are whole emulation runs, long enough that a plain lock
+     * costs nothing next to them.
+     */
+    class WorkQueue {
+    public:
+        void push(size_t t_job) {
+            const std::lock_guard<std::mutex> lock(m_mutex);
+            m_jobs.push_back(t_job);
+        }
+
+        std::optional<size_t> pop() {
+            const std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_jobs.empty()) {
+                return std::nullopt;
+            }
+
+            const size_t job = m_jobs.back();
+            m_jobs.pop_back();
+            return job;
+        }
+
+        std::optional<size_t> steal() {
+            const std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_jobs.empty()) {
+                return std::nullopt;
+            }
+
+            const size_t job = m_jobs.front();
+            m_jobs.pop_front();
+            return job;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::deque<size_t> m_jobs;
+    };
+
+    static JobResult runJob(const Job& t_job, StateCache* t_bootCache, size_t t_worker) {
+        JobResult result{};
+        result.worker = t_worker;
+
+        const auto start = Clock::now();
+
+        // Boot frames past the end of the input run with no buttons held, which the cache can't
+        // know about, so those jobs boot themselves
+        const bool cached = (t_bootCache != nullptr) && (t_job.bootFrames > 0) && (t_job.bootFrames <= std::min<uint64_t>(t_job.input.size(), t_job.frameCount));
+        auto consoleOrError = cached
+                ? t_bootCache->boot(t_job.rom, std::span<const InputFrame>(t_job.input).first(t_job.bootFrames))
+                : Console::fromImage(t_job.rom);
+        if (consoleOrError.is_error()) {
+            result.error = consoleOrError.get_error();
+            return result;
+        }
+        std::unique_ptr<Console> console = std::move(consoleOrError).get_value();
+
+        // Only the end state is reported, so nothing needs to be drawn
+        console->setVideoSink(std::make_unique<Output::NullVideoSink>());
+
+        for (uint64_t frame = cached ? t_job.bootFrames : 0; frame < t_job.frameCount; frame++) {
+            const InputFrame input = (frame < t_job.input.size()) ? t_job.input[frame] : InputFrame{};
+            for (size_t port = 0; port < input.size(); port++) {
+                console->setInput(port, input[port]);
+            }
+
+            console->runFrame();
+        }
+
+        result.frameCount = console->getFrameCount();
+        result.restoredFrames = cached ? t_job.bootFrames : 0;
+        result.emulatedFrames = result.frameCount - result.restoredFrames;
+        result.cycleCount = console->getCycleCount();
+        result.ramHash = hash64(console->getRAM());
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        return result;
+    }
+
+    static void pinToCPU([[maybe_unused]] std::thread& t_thread, [[maybe_unused]] size_t t_cpu) {
+#ifdef __linux__
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(t_cpu % CPU_SETSIZE, &cpus);
+
+        // Pinning is only a hint for better cache behaviour, so failures are ignored
+        pthread_setaffinity_np(t_thread.native_handle(), sizeof(cpus), &cpus);
+#endif
+    }
+
+    double BatchResult::framesPerSecond() const {
+        return (seconds > 0.0) ? static_cast<double>(emulatedFrames) / seconds : 0.0;
+    }
+
+    BatchRunner::BatchRunner(RunnerOptions t_options) : m_options(t_options) {
+        ;
+    }
+
+    BatchResult BatchRunner::run(std::span<const Job> t_jobs) const {
+        const size_t hardwareThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        const size_t requestedThreads = (m_options.threadCount == 0) ? hardwareThreads : m_options.threadCount;
+        const size_t threadCount = std::clamp<size_t>(t_jobs.size(), 1, requestedThreads);
+
+        std::vector<WorkQueue> queues(threadCount);
+        for (size_t i = 0; i < t_jobs.size(); i++) {
+            queues[i % threadCount].push(i);
+        }
+
+        BatchResult result{};
+        result.jobs.resize(t_jobs.size());
+
+        // Each job's result is written by exactly one worker, so the results need no locking
+        const auto work = [&](size_t t_worker) {
+            while (true) {
+                std::optional<size_t> job = queues[t_worker].pop();
+                for (size_t i = 1; !job.has_value() && i < threadCount; i++) {
+                    job = queues[(t_worker + i) % threadCount].steal();
+                }
+
+                // Nothing is ever added once the workers start, so empty queues stay empty
+                if (!job.has_value()) {
+                    return;
+                }
+
+                result.jobs[*job] = runJob(t_jobs[*job], m_options.bootCache.get(), t_worker);
+            }
+        };
+
+        const uint64_t cacheFramesBefore = (m_options.bootCache != nullptr) ? m_options.bootCache->getEmulatedFrames() : 0;
+        const auto start = Clock::now();
+
+        std::vector<std::thread> workers;
+        workers.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; i++) {
+            workers.emplace_back(work, i);
+            if (m_options.pinThreads) {
+                pinToCPU(workers.back(), i);
+            }
+        }
+
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        for (const JobResult& job : result.jobs) {
+            result.emulatedFrames += job.emulatedFrames;
+            result.restoredFrames += job.restoredFrames;
+        }
+        if (m_options.bootCache != nullptr) {
+            result.emulatedFrames += m_options.bootCache->getEmulatedFrames() - cacheFramesBefore;
+        }
+
+        return result;
+    }
+
+}
@@ -0,0 +1,77 @@
+#ifndef RNES_BATCH_RUNNER_INCLUDED
+#define RNES_BATCH_RUNNER_INCLUDED
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "defines.hpp"
+#include "console.hpp"
+#include "error_or.hpp"
+#include "mapper/rom_image.hpp"
+
+namespace RNES::Batch {
+
+    using InputFrame = RNES::InputFrame;
+
+    class StateCache;
+
+    struct Job {
+        // Jobs running the same game should share one image, so it is only loaded and mapped once
+        std::shared_ptr<const Mapper::ROMImage> rom;
+        // One entry per frame. Frames past the end run with no buttons held.
+        std::vector<InputFrame> input;
+        uint64_t frameCount;
+        // Leading frames of input that are only there to boot the game. With a boot cache, their end
+        // state is taken from it rather than emulated again by every job.
+        uint64_t bootFrames = 0;
+    };
+
+    struct JobResult {
+        std::optional<ErrorCode> error; // set if the console couldn't be created
+
+        uint64_t frameCount; // the console's frame count at the end, restored boot frames included
+        uint64_t emulatedFrames; // frames this job actually ran
+        uint64_t restoredFrames; // boot frames taken from the cache instead
+        uint64_t cycleCount;
+        uint64_t ramHash; // hash64 of internal RAM after the last frame, to compare runs
+        double seconds;
+        size_t worker;
+    };
+
+    struct BatchResult {
+        std::vector<JobResult> jobs; // in the same order as the jobs
+        uint64_t emulatedFrames; // by the jobs, and by the boot cache for jobs it hadn't seen before
+        uint64_t restoredFrames; // boot frames the jobs took from the cache
+        double seconds; // wall clock time for the whole batch
+
+        // Emulated frames only, restored ones cost next to nothing
+        [[nodiscard]] double framesPerSecond() const;
+    };
+
+    struct RunnerOptions {
+        size_t threadCount = 0; // 0 uses one thread per hardware thread
+        bool pinThreads = false; // pin worker n to CPU n, where the platform supports it
+        std::shared_ptr<StateCache> bootCache; // optional, shared by every worker
+    };
+
+    /* Runs batches of independent jobs on a pool of worker threads. Jobs are dealt out evenly up
+     * front, and a worker that runs out of its own steals from the others, so a few long jobs don't
+     * leave the rest of the pool idle. Every job gets its own console and no state is shared between
+     * them other than the read-only ROM images.
+     */
+    class BatchRunner {
+    public:
+        explicit BatchRunner(RunnerOptions t_options);
+
+        [[nodiscard]] BatchResult run(std::span<const Job> t_jobs) const;
+
+    private:
+        RunnerOptions m_options;
+    };
+
+}
+
+#endif
@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "batch/batch_runner.hpp"
+#include "batch/state_cache.hpp"
+#include "mapper/mapper.hpp"
+
+/* Runs the same ROM many times in parallel with different random inputs, and prints each run's
+ * final RAM hash along with the combined speed of the whole batch.
+ * --boot <frames> <cache_dir> starts every job with the same frames of no input, booted once and
+ * kept in cache_dir for later runs.
+ */
+int main(int argc, char* argv[]) {
+    std::vector<char*> args;
+    uint64_t bootFrames = 0;
+    const char* cacheDirectory = nullptr;
+    for (int i = 0; i < argc; i++) {
+        if (std::string(argv[i]) == "--boot" && i + 2 < argc) {
+            bootFrames = std::stoull(argv[++i]);
+            cacheDirectory = argv[++i];
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
+    if (argc < 4 || argc > 6) {
+        std::cerr << "Usage: <rom_path> <job_count> <frame_count> [thread_count] [--pin] [--boot <frames> <cache_dir>]" << std::endl;
+        return 1;
+    }
+
+    auto romOrError = RNES::Mapper::loadROMImage(argv[1]);
+    if (romOrError.is_error()) {
+        std::cerr << "Failed to load ROM (error " << romOrError.get_error().getErrorCode() << ")\n";
+        return EXIT_FAILURE;
+    }
+    const auto rom = romOrError.get_value();
+
+    const size_t jobCount = std::stoull(argv[2]);
+    const uint64_t frameCount = std::stoull(argv[3]);
+
+    RNES::Batch::RunnerOptions options;
+    options.threadCount = (argc >= 5) ? std::stoull(argv[4]) : 0;
+    options.pinThreads = (argc >= 6) && std::strcmp(argv[5], "--pin") == 0;
+    if (cacheDirectory != nullptr) {
+        options.bootCache = std::make_shared<RNES::Batch::StateCache>(cacheDirectory);
+    }
+
+    // Every job presses buttons at random, changing them every few frames like a player would.
+    // Seeding with the job number keeps the batch reproducible.
+    std::vector<RNES::Batch::Job> jobs(jobCount);
+    for (size_t i = 0; i < jobCount; i++) {
+        std::mt19937 random(static_cast<uint32_t>(i));
+
+        jobs[i].rom = rom;
+        jobs[i].frameCount = frameCount;
+        jobs[i].bootFrames = std::min(bootFrames, frameCount);
+        jobs[i].input.resize(frameCount);
+        for (uint64_t frame = jobs[i].bootFrames; frame < frameCount; frame++) {
+            jobs[i].input[frame] = (frame % 8 == 0) ? RNES::Batch::InputFrame{ static_cast<uint8_t>(random()), 0 } : jobs[i].input[frame - 1];
+        }
+    }
+
+    const RNES::Batch::BatchRunner runner(options);
+    const RNES::Batch::BatchResult result = runner.run(jobs);
+
+    for (size_t i = 0; i < result.jobs.size(); i++) {
+        const RNES::Batch::JobResult& job = result.jobs[i];
+        std::cout << "job " << i << ": ";
+        if (job.error.has_value()) {
+            std::cout << "error " << job.error->getErrorCode() << "\n";
+            continue;
+        }
+
+        std::cout << job.emulatedFrames << " frames emulated, " << job.restoredFrames << " restored, " << job.cycleCount << " cycles, worker " << job.worker
+                  << ", " << job.seconds << " s, RAM hash " << std::hex << std::setw(16) << std::setfill('0') << job.ramHash
+                  << std::dec << std::setfill(' ') << "\n";
+    }
+
+    std::cout << result.emulatedFrames << " frames emulated in " << result.seconds << " s (" << result.framesPerSecond() << " frames/second), "
+              << result.restoredFrames << " restored from the boot cache\n";
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <unistd.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include "state_cache.hpp"
+#include "hash.hpp"
+#include "mapper/mapped_file.hpp"
+#include "output/video_sink.hpp"
+
+namespace RNES::Batch {
+
+    // Writes t_state to t_path without readers ever seeing a partial file
+    static void writeStateFile(const std::string& t_path, std::span<const uint8_t> t_state) {
+        const std::string temporaryPath = t_path + ".tmp" + std::to_string(getpid());
+
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return;
+        }
+
+        file.write(reinterpret_cast<const char*>(t_state.data()), static_cast<std::streamsize>(t_state.size()));
+        file.close();
+
+        if (!file || std::rename(temporaryPath.c_str(), t_path.c_str()) != 0) {
+            std::remove(temporaryPath.c_str());
+        }
+    }
+
+    StateCache::StateCache(std::string t_directory) : m_directory(std::move(t_directory)), m_entriesMutex(), m_entries(), m_emulatedFrames(0) {
+        ;
+    }
+
+    ErrorOr<std::unique_ptr<Console>> StateCache::boot(const std::shared_ptr<const Mapper::ROMImage>& t_rom, std::span<const InputFrame> t_input) {
+        const uint64_t inputHash = hash64({ reinterpret_cast<const uint8_t*>(t_input.data()), t_input.size_bytes() });
+
+        std::shared_ptr<Entry> entry;
+        {
+            const std::lock_guard<std::mutex> lock(m_entriesMutex);
+            auto& slot = m_entries[{ t_rom->hash, inputHash }];
+            if (slot == nullptr) {
+                slot = std::make_shared<Entry>();
+            }
+            entry = slot;
+        }
+
+        // Other keys can be booted meanwhile, only this one waits
+        const std::lock_guard<std::mutex> lock(entry->mutex);
+        if (entry->console == nullptr) {
+            entry->console = TRY(load(t_rom, t_input, getPath(t_rom->hash, inputHash)));
+        }
+
+        return entry->console->fork();
+    }
+
+    std::string StateCache::getPath(uint64_t t_romHash, uint64_t t_inputHash) const {
+        char name[64];
+        std::snprintf(name, sizeof(name), "%016" PRIx64 "-%016" PRIx64 ".state", t_romHash, t_inputHash);
+        return m_directory + "/" + name;
+    }
+
+    uint64_t StateCache::getEmulatedFrames() const {
+        return m_emulatedFrames.load(std::memory_order_relaxed);
+    }
+
+    ErrorOr<std::unique_ptr<const Console>> StateCache::load(const std::shared_ptr<const Mapper::ROMImage>& t_rom, std::span<const InputFrame> t_input, const std::string& t_path) {
+        std::unique_ptr<Console> console = TRY(Console::fromImage(t_rom));
+        console->setVideoSink(std::make_unique<Output::NullVideoSink>());
+
+        // Loading checks the header, so files from another version or ROM are booted over
+        const auto file = Mapper::mapFile(t_path.c_str());
+        if (!file.is_error() && !console->loadState(file.get_value()->data()).is_error()) {
+            return std::unique_ptr<const Console>(std::move(console));
+        }
+
+        for (const InputFrame& frame : t_input) {
+            for (size_t port = 0; port < frame.size(); port++) {
+                console->setInput(port, frame[port]);
+            }
+            console->runFrame();
+        }
+        m_emulatedFrames.fetch_add(t_input.size(), std::memory_order_relaxed);
+
+        std::vector<uint8_t> state(console->getStateSize());
+        const auto saved = console->saveState(state);
+        ASSERT(!saved.is_error(), "Failed to save the booted state");
+        writeStateFile(t_path, state);
+
+        return std::unique_ptr<const Console>(std::move(console));
+    }
+
+}
@@ -0,0 +1,71 @@
+#ifndef RNES_STATE_CACHE_INCLUDED
+#define RNES_STATE_CACHE_INCLUDED
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <utility>
+
+#include "defines.hpp"
+#include "error_or.hpp"
+#include "console.hpp"
+#include "batch/batch_runner.hpp"
+#include "mapper/rom_image.hpp"
+
+namespace RNES::Batch {
+
+    /* Consoles that have already been booted through a given input prefix, so jobs that all start
+     * by sitting through the same boot and intro only pay for it once.
+     *
+     * States are keyed by the ROM's hash and the hash of the input prefix, and kept on disk as plain
+     * save state files named after the two, so other processes and later runs can use them too.
+     * Files are memory mapped and loaded straight out of the mapping. Within a process each key is
+     * booted or loaded once into a console that is never run, and every boot() after that is a
+     * fork() of it, which takes a few microseconds.
+     *
+     * Files are written under a temporary name and renamed into place, so readers never see half a
+     * state. Missing, stale or damaged files are simply booted again and replaced. Failing to write a
+     * file isn't an error, it only means the next process boots again. boot() can be called from any
+     * number of threads.
+     */
+    class StateCache {
+    public:
+        explicit StateCache(std::string t_directory);
+
+        StateCache(const StateCache&) = delete;
+        StateCache& operator=(const StateCache&) = delete;
+
+        // A console in the state reached by running t_rom from power on through t_input, one entry
+        // per frame. Like any forked console it draws nothing until given a video sink.
+        ErrorOr<std::unique_ptr<Console>> boot(const std::shared_ptr<const Mapper::ROMImage>& t_rom, std::span<const InputFrame> t_input);
+
+        // Where the state for this key is kept
+        [[nodiscard]] std::string getPath(uint64_t t_romHash, uint64_t t_inputHash) const;
+
+        // Frames run to boot keys that weren't on disk, so far
+        [[nodiscard]] uint64_t getEmulatedFrames() const;
+
+    private:
+        using Key = std::pair<uint64_t, uint64_t>; // ROM hash, input hash
+
+        struct Entry {
+            std::mutex mutex; // held while booting, so each key is only booted once
+            std::unique_ptr<const Console> console;
+        };
+
+        ErrorOr<std::unique_ptr<const Console>> load(const std::shared_ptr<const Mapper::ROMImage>& t_rom, std::span<const InputFrame> t_input, const std::string& t_path);
+
+        std::string m_directory;
+
+        std::mutex m_entriesMutex;
+        std::map<Key, std::shared_ptr<Entry>> m_entries;
+
+        std::atomic<uint64_t> m_emulatedFrames;
+    };
+
+}
+
+#endif
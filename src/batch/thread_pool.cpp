@@ -0,0 +1,97 @@
+#include <algorithm>
+
+#include "thread_pool.hpp"
+
+namespace RNES::Batch {
+
+    ThreadPool::ThreadPool(size_t t_threadCount)
+        : m_workers()
+        , m_generation(0)
+        , m_busyWorkers(0)
+        , m_stopping(false)
+        , m_task(nullptr)
+        , m_taskCount(0)
+        , m_nextTask(0)
+    {
+        const size_t hardwareThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        const size_t threadCount = (t_threadCount == 0) ? hardwareThreads : t_threadCount;
+
+        // The calling thread does its share of the work too
+        m_workers.reserve(threadCount - 1);
+        for (size_t i = 1; i < threadCount; i++) {
+            m_workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            const std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+
+        for (std::thread& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::parallelFor(size_t t_count, const std::function<void(size_t)>& t_task) {
+        if (m_workers.empty() || t_count <= 1) {
+            for (size_t i = 0; i < t_count; i++) {
+                t_task(i);
+            }
+            return;
+        }
+
+        {
+            const std::lock_guard<std::mutex> lock(m_mutex);
+            m_task = &t_task;
+            m_taskCount = t_count;
+            m_nextTask.store(0, std::memory_order_relaxed);
+            m_busyWorkers = m_workers.size();
+            m_generation++;
+        }
+        m_wake.notify_all();
+
+        runTasks();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_finished.wait(lock, [this] { return m_busyWorkers == 0; });
+    }
+
+    size_t ThreadPool::threadCount() const {
+        return m_workers.size() + 1;
+    }
+
+    void ThreadPool::workerLoop() {
+        uint64_t seenGeneration = 0;
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&] { return m_stopping || m_generation != seenGeneration; });
+                if (m_stopping) {
+                    return;
+                }
+                seenGeneration = m_generation;
+            }
+
+            runTasks();
+
+            {
+                const std::lock_guard<std::mutex> lock(m_mutex);
+                if (--m_busyWorkers == 0) {
+                    m_finished.notify_one();
+                }
+            }
+        }
+    }
+
+    void ThreadPool::runTasks() {
+        // Tasks are claimed one at a time, so a thread that finishes early simply takes more
+        for (size_t i = m_nextTask.fetch_add(1); i < m_taskCount; i = m_nextTask.fetch_add(1)) {
+            (*m_task)(i);
+        }
+    }
+
+}
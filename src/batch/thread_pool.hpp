@@ -0,0 +1,53 @@
+#ifndef RNES_THREAD_POOL_INCLUDED
+#define RNES_THREAD_POOL_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "defines.hpp"
+
+namespace RNES::Batch {
+
+    /* A fixed set of threads for running many small tasks in lockstep, such as stepping every
+     * instance by one frame. The threads are kept alive between calls so each call only costs a
+     * wake-up rather than thread creation.
+     */
+    class ThreadPool {
+    public:
+        // t_threadCount includes the calling thread, 0 uses one thread per hardware thread
+        explicit ThreadPool(size_t t_threadCount);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Calls t_task(i) for every i < t_count spread over the pool, returning once all have finished
+        void parallelFor(size_t t_count, const std::function<void(size_t)>& t_task);
+
+        [[nodiscard]] size_t threadCount() const;
+
+    private:
+        void workerLoop();
+        void runTasks();
+
+        std::vector<std::thread> m_workers;
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_finished;
+        uint64_t m_generation; // bumped to hand the workers a new set of tasks
+        size_t m_busyWorkers;
+        bool m_stopping;
+
+        const std::function<void(size_t)>* m_task;
+        size_t m_taskCount;
+        std::atomic<size_t> m_nextTask;
+    };
+
+}
+
+#endif
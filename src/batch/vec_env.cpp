@@ -0,0 +1,153 @@
+#include <algorithm>
+
+#include "assert.hpp"
+#include "vec_env.hpp"
+#include "output/video_sink.hpp"
+#include "ppu/ppu.hpp"
+
+namespace RNES::Batch {
+
+    static const size_t OBSERVATION_SIZE = PPU::OUTPUT_WIDTH * PPU::OUTPUT_HEIGHT;
+
+    // Points the PPU at this instance's slice of the observation buffer, only on frames that are kept
+    class VecEnv::ObservationSink : public Output::VideoSink {
+    public:
+        std::span<uint32_t> beginFrame() override {
+            return m_draw ? m_target : std::span<uint32_t>();
+        }
+
+        void endFrame() override {
+            ;
+        }
+
+        void setTarget(std::span<uint32_t> t_target) {
+            m_target = t_target;
+        }
+
+        void setDrawing(bool t_draw) {
+            m_draw = t_draw;
+        }
+
+    private:
+        std::span<uint32_t> m_target;
+        bool m_draw = false;
+    };
+
+    ErrorOr<std::unique_ptr<VecEnv>> VecEnv::create(std::shared_ptr<const Mapper::ROMImage> t_rom, size_t t_count, VecEnvOptions t_options) {
+        ASSERT(t_options.frameSkip > 0, "Every step has to run at least one frame");
+
+        std::unique_ptr<VecEnv> env(new VecEnv(std::move(t_rom), t_options));
+
+        env->m_instances.resize(t_count);
+        env->m_ram.resize(t_count * RAM_SIZE, 0);
+        env->m_dones.resize(t_count, 0);
+        env->m_episodeFrames.resize(t_count, 0);
+
+        for (size_t i = 0; i < t_count; i++) {
+            TRY(env->restart(i));
+        }
+
+        return env;
+    }
+
+    VecEnv::VecEnv(std::shared_ptr<const Mapper::ROMImage> t_rom, VecEnvOptions t_options)
+        : m_rom(std::move(t_rom))
+        , m_options(t_options)
+        , m_pool(t_options.threadCount)
+        , m_instances()
+        , m_observations()
+        , m_doneCheck()
+        , m_ram()
+        , m_dones()
+        , m_episodeFrames()
+    {
+        ;
+    }
+
+    size_t VecEnv::size() const {
+        return m_instances.size();
+    }
+
+    void VecEnv::setObservationBuffer(std::span<uint32_t> t_observations) {
+        ASSERT(t_observations.empty() || t_observations.size() == m_instances.size() * OBSERVATION_SIZE, "Observation buffer is the wrong size");
+        m_observations = t_observations;
+
+        for (size_t i = 0; i < m_instances.size(); i++) {
+            m_instances[i].sink->setTarget(m_observations.empty() ? std::span<uint32_t>() : m_observations.subspan(i * OBSERVATION_SIZE, OBSERVATION_SIZE));
+        }
+    }
+
+    void VecEnv::setDoneCheck(DoneCheck t_check) {
+        m_doneCheck = std::move(t_check);
+    }
+
+    void VecEnv::step(std::span<const uint8_t> t_actions) {
+        ASSERT(t_actions.size() == m_instances.size(), "Need one action per instance");
+
+        m_pool.parallelFor(m_instances.size(), [&](size_t t_index) {
+            stepInstance(t_index, t_actions[t_index]);
+        });
+    }
+
+    void VecEnv::reset() {
+        m_pool.parallelFor(m_instances.size(), [&](size_t t_index) {
+            // The image has already made consoles successfully, so this can't fail
+            const ErrorOr<void> result = restart(t_index);
+            ASSERT(!result.is_error(), "Failed to restart an instance");
+        });
+    }
+
+    std::span<const Word> VecEnv::getRAM() const {
+        return m_ram;
+    }
+
+    std::span<const uint8_t> VecEnv::getDones() const {
+        return m_dones;
+    }
+
+    std::span<const uint64_t> VecEnv::getEpisodeFrames() const {
+        return m_episodeFrames;
+    }
+
+    ErrorOr<void> VecEnv::restart(size_t t_index) {
+        Instance& instance = m_instances[t_index];
+
+        instance.console = TRY(Console::fromImage(m_rom));
+
+        auto sink = std::make_unique<ObservationSink>();
+        sink->setTarget(m_observations.empty() ? std::span<uint32_t>() : m_observations.subspan(t_index * OBSERVATION_SIZE, OBSERVATION_SIZE));
+        instance.sink = sink.get();
+        instance.console->setVideoSink(std::move(sink));
+
+        const auto ram = instance.console->getRAM();
+        std::copy(ram.begin(), ram.end(), m_ram.begin() + t_index * RAM_SIZE);
+        m_dones[t_index] = 0;
+        m_episodeFrames[t_index] = 0;
+
+        return {};
+    }
+
+    void VecEnv::stepInstance(size_t t_index, uint8_t t_action) {
+        if (m_dones[t_index]) {
+            const ErrorOr<void> result = restart(t_index);
+            ASSERT(!result.is_error(), "Failed to restart an instance");
+        }
+
+        Instance& instance = m_instances[t_index];
+        instance.console->setInput(0, t_action);
+
+        for (size_t frame = 0; frame < m_options.frameSkip; frame++) {
+            instance.sink->setDrawing(frame + 1 == m_options.frameSkip);
+            instance.console->runFrame();
+        }
+        m_episodeFrames[t_index] += m_options.frameSkip;
+
+        const auto ram = instance.console->getRAM();
+        std::copy(ram.begin(), ram.end(), m_ram.begin() + t_index * RAM_SIZE);
+
+        const bool timedOut = (m_options.maxEpisodeFrames != 0) && (m_episodeFrames[t_index] >= m_options.maxEpisodeFrames);
+        const bool ended = m_doneCheck && m_doneCheck(ram);
+        m_dones[t_index] = (timedOut || ended) ? 1 : 0;
+    }
+
+}
@@ -0,0 +1,90 @@
+#ifndef RNES_VEC_ENV_INCLUDED
+#define RNES_VEC_ENV_INCLUDED
+
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "defines.hpp"
+#include "error_or.hpp"
+#include "console.hpp"
+#include "batch/thread_pool.hpp"
+#include "mapper/rom_image.hpp"
+
+namespace RNES::Batch {
+
+    static const size_t RAM_SIZE = 0x0800;
+
+    struct VecEnvOptions {
+        size_t threadCount = 0; // 0 uses one thread per hardware thread
+        size_t frameSkip = 1; // frames each action is held for, only the last one is drawn
+        uint64_t maxEpisodeFrames = 0; // episodes end after this many frames, 0 for no limit
+    };
+
+    /* N copies of one game stepped in lockstep, for reinforcement learning. Every step takes one
+     * action per instance and leaves the results in contiguous arrays indexed by instance: the RAM of
+     * every console, whether its episode ended, and optionally the pictures, which are drawn straight
+     * into a buffer owned by the caller.
+     *
+     * Instances whose episode ended are restarted from power on at the start of the next step, so
+     * the state seen after a step is always the one the episode ended in.
+     */
+    class VecEnv {
+    public:
+        // Decides whether an episode has ended from the console's RAM. Called from worker threads.
+        using DoneCheck = std::function<bool(std::span<const Word, RAM_SIZE>)>;
+
+        static ErrorOr<std::unique_ptr<VecEnv>> create(std::shared_ptr<const Mapper::ROMImage> t_rom, size_t t_count, VecEnvOptions t_options);
+
+        VecEnv(const VecEnv&) = delete;
+        VecEnv& operator=(const VecEnv&) = delete;
+
+        [[nodiscard]] size_t size() const;
+
+        // [N][OUTPUT_HEIGHT][OUTPUT_WIDTH] packed RGBA pixels, rewritten in place by every step. The
+        // memory must outlive the environment or be replaced. An empty span turns drawing off.
+        void setObservationBuffer(std::span<uint32_t> t_observations);
+        void setDoneCheck(DoneCheck t_check);
+
+        // Holds t_actions[i] on instance i's first controller for frameSkip frames
+        void step(std::span<const uint8_t> t_actions);
+        // Restarts every instance from power on
+        void reset();
+
+        // [N][RAM_SIZE], as it was at the end of the last step
+        [[nodiscard]] std::span<const Word> getRAM() const;
+        // 1 where the episode ended during the last step
+        [[nodiscard]] std::span<const uint8_t> getDones() const;
+        // Frames since each instance's episode started
+        [[nodiscard]] std::span<const uint64_t> getEpisodeFrames() const;
+
+    private:
+        class ObservationSink;
+
+        struct Instance {
+            std::unique_ptr<Console> console;
+            ObservationSink* sink; // owned by console
+        };
+
+        VecEnv(std::shared_ptr<const Mapper::ROMImage> t_rom, VecEnvOptions t_options);
+
+        ErrorOr<void> restart(size_t t_index);
+        void stepInstance(size_t t_index, uint8_t t_action);
+
+        std::shared_ptr<const Mapper::ROMImage> m_rom;
+        VecEnvOptions m_options;
+        ThreadPool m_pool;
+
+        std::vector<Instance> m_instances;
+        std::span<uint32_t> m_observations;
+        DoneCheck m_doneCheck;
+
+        std::vector<Word> m_ram;
+        std::vector<uint8_t> m_dones;
+        std::vector<uint64_t> m_episodeFrames;
+    };
+
+}
+
+#endif
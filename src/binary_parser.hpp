@@ -0,0 +1,84 @@
+#ifndef RNES_BINARY_PARSER_INCLUDED
+#define RNES_BINARY_PARSER_INCLUDED
+
+#include <bit>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#include "defines.hpp"
+#include "error_or.hpp"
+
+namespace RNES {
+
+    enum BinaryParserError {
+        ERROR_UNEXPECTED_END_OF_DATA = 0x100,
+    };
+
+    /* Reads little endian values from a block of memory. Byte ranges are returned as views
+     * into the data, so the data has to outlive anything read from it.
+     */
+    class BinaryParser {
+    public:
+        explicit BinaryParser(std::span<const uint8_t> t_data) : m_data(t_data), m_index(0) {
+            ;
+        }
+
+        template<typename T>
+        ErrorOr<T> read() {
+            static_assert(std::is_integral_v<T>, "Only integers can be read");
+            REQUIRE(m_index + sizeof(T) <= m_data.size(), ERROR_UNEXPECTED_END_OF_DATA);
+
+            T result = 0;
+            if constexpr (std::endian::native == std::endian::little) {
+                std::memcpy(&result, m_data.data() + m_index, sizeof(T));
+            }
+            else {
+                for (size_t i = 0; i < sizeof(T); i++) {
+                    result |= static_cast<T>(m_data[m_index + i]) << (8 * i);
+                }
+            }
+
+            m_index += sizeof(T);
+            return result;
+        }
+
+        template<size_t N>
+        ErrorOr<std::span<const uint8_t, N>> readBytes() {
+            REQUIRE(m_index + N <= m_data.size(), ERROR_UNEXPECTED_END_OF_DATA);
+            const std::span<const uint8_t, N> result = m_data.subspan(m_index).template first<N>();
+
+            m_index += N;
+            return result;
+        }
+
+        ErrorOr<std::span<const uint8_t>> readBytes(size_t t_count) {
+            REQUIRE(m_index + t_count <= m_data.size(), ERROR_UNEXPECTED_END_OF_DATA);
+            const std::span<const uint8_t> result = m_data.subspan(m_index, t_count);
+
+            m_index += t_count;
+            return result;
+        }
+
+        ErrorOr<std::span<const uint8_t>> readRest() {
+            return readBytes(m_data.size() - m_index);
+        }
+
+        ErrorOr<void> skip(size_t t_amount) {
+            REQUIRE(m_index + t_amount <= m_data.size(), ERROR_UNEXPECTED_END_OF_DATA);
+            m_index += t_amount;
+            return {};
+        }
+
+        [[nodiscard]] size_t position() const {
+            return m_index;
+        }
+
+    private:
+        std::span<const uint8_t> m_data;
+        size_t m_index;
+    };
+
+}
+
+#endif
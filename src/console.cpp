@@ -0,0 +1,279 @@
+#include "assert.hpp"
+#include "binary_parser.hpp"
+#include "console.hpp"
+
+namespace RNES {
+
+    // "RNSS" when read as little endian
+    static const uint32_t STATE_MAGIC = 0x53534E52;
+    // Has to change whenever any component's saveState() does
+    static const uint16_t STATE_VERSION = 3;
+    // Magic, version, size and ROM hash
+    static const size_t STATE_HEADER_SIZE = 4 + 2 + 4 + 8;
+
+    // Longest stretch runUntil() lets audio build up before handing it over. Half the APU's limit,
+    // so a whole frame can still follow.
+    static const uint64_t AUDIO_FLUSH_CYCLES = APU::MAX_FRAME_CYCLES / 2;
+
+    // Largest state of any one component, which is the PPU with 8KB of CHR-RAM
+    static const size_t MAX_COMPONENT_STATE_SIZE = 0x4000;
+
+    // Copies one component's state into another's through the stack, for forking
+    template<typename Component>
+    static void copyComponentState(const Component& t_source, Component& t_destination) {
+        std::array<uint8_t, MAX_COMPONENT_STATE_SIZE> buffer;
+
+        StateWriter writer(buffer);
+        t_source.saveState(writer);
+        StateReader reader(std::span<const uint8_t>(buffer).first(writer.position()));
+        t_destination.loadState(reader);
+    }
+
+    ErrorOr<std::unique_ptr<Console>> Console::fromFile(const char* t_romPath) {
+        Mapper::Mapper mapper = TRY(Mapper::createMapperFromINES(t_romPath));
+        return std::unique_ptr<Console>(new Console(std::move(mapper), std::make_unique<Output::BufferVideoSink>()));
+    }
+
+    ErrorOr<std::unique_ptr<Console>> Console::fromBuffer(std::span<const uint8_t> t_rom) {
+        const auto image = TRY(Mapper::loadROMImage(t_rom));
+        return fromImage(image);
+    }
+
+    ErrorOr<std::unique_ptr<Console>> Console::fromImage(const std::shared_ptr<const Mapper::ROMImage>& t_image) {
+        Mapper::Mapper mapper = TRY(Mapper::createMapper(t_image, nullptr));
+        return std::unique_ptr<Console>(new Console(std::move(mapper), std::make_unique<Output::BufferVideoSink>()));
+    }
+
+    Console::Console(Mapper::Mapper t_mapper, std::unique_ptr<Output::VideoSink> t_videoSink)
+        : m_image(std::move(t_mapper.image))
+        , m_scheduler()
+        , m_ppu(std::move(t_mapper.ppuController))
+        , m_apu(m_scheduler)
+        , m_cpu()
+        , m_controller(nullptr)
+        , m_videoSink(std::move(t_videoSink))
+        , m_audioSink(std::make_unique<Output::NullAudioSink>())
+        , m_frameCount(0)
+        , m_stateSize(0)
+        , m_runAheadFrames(0)
+        , m_runAheadState()
+    {
+        auto controller = std::make_unique<NESController>(std::move(t_mapper.cpuController), m_scheduler, m_ppu, m_apu);
+        m_controller = controller.get();
+
+        m_cpu.setController(std::move(controller));
+        m_cpu.reset();
+        m_scheduler.setCurrentCycle(m_cpu.getCycleCount());
+
+        StateWriter measure = StateWriter::measure();
+        writeState(measure);
+        m_stateSize = measure.position();
+    }
+
+    void Console::runFrame() {
+        if (m_runAheadFrames == 0) {
+            emulateFrame(true, true);
+            return;
+        }
+
+        emulateFrame(false, true);
+        const auto saved = saveState(m_runAheadState);
+        ASSERT(!saved.is_error(), "Failed to save the run-ahead state");
+
+        for (size_t i = 1; i < m_runAheadFrames; i++) {
+            emulateFrame(false, false);
+        }
+        emulateFrame(true, false);
+
+        const auto loaded = loadState(m_runAheadState);
+        ASSERT(!loaded.is_error(), "Failed to load the run-ahead state");
+    }
+
+    void Console::skipFrame() {
+        emulateFrame(false, false);
+    }
+
+    void Console::setRunAhead(size_t t_frames) {
+        m_runAheadFrames = t_frames;
+        m_runAheadState.resize((t_frames > 0) ? m_stateSize : 0);
+    }
+
+    void Console::emulateFrame(bool t_drawVideo, bool t_playAudio) {
+        // The PPU may be behind, which would put its next vblank in the past
+        m_ppu.catchUp(m_scheduler.now());
+
+        // Without a frame buffer the PPU skips drawing and only does what the CPU can observe
+        const std::span<uint8_t> indices = t_drawVideo ? m_videoSink->beginIndexedFrame() : std::span<uint8_t>();
+        m_ppu.setIndexBuffer(indices);
+        m_ppu.setFrameBuffer((t_drawVideo && indices.empty()) ? m_videoSink->beginFrame() : std::span<uint32_t>());
+        runUntil(m_ppu.nextVBlankCycle(), t_playAudio);
+
+        m_ppu.catchUp(m_scheduler.now());
+        if (t_drawVideo) {
+            m_videoSink->endFrame();
+        }
+
+        endAudioFrame(t_playAudio);
+        m_frameCount++;
+    }
+
+    void Console::endAudioFrame(bool t_playAudio) {
+        const uint64_t now = m_scheduler.now();
+        if (t_playAudio && m_apu.isSynthesisEnabled()) {
+            m_apu.endFrame(now);
+            m_audioSink->writeSamples(m_apu.takeSamples());
+            m_apu.setRateAdjustment(m_audioSink->getRateAdjustment());
+        }
+        else {
+            m_apu.skipFrame(now);
+        }
+    }
+
+    void Console::runCycles(uint64_t t_cycles) {
+        runUntil(m_cpu.getCycleCount() + t_cycles, true);
+    }
+
+    void Console::setInput(size_t t_port, uint8_t t_buttons) {
+        m_controller->setControllerState(t_port, t_buttons);
+    }
+
+    void Console::setVideoSink(std::unique_ptr<Output::VideoSink> t_sink) {
+        // The PPU may still point into the old sink's memory. Nothing is drawn until the next frame.
+        m_ppu.setFrameBuffer({});
+        m_ppu.setIndexBuffer({});
+        m_videoSink = std::move(t_sink);
+    }
+
+    void Console::setAudioSink(std::unique_ptr<Output::AudioSink> t_sink) {
+        m_audioSink = std::move(t_sink);
+        m_apu.setSynthesisEnabled(m_audioSink->wantsSamples());
+    }
+
+    std::span<const uint32_t> Console::getFrameBuffer() const {
+        return m_ppu.getFrameBuffer();
+    }
+
+    std::span<const Word, 0x0800> Console::getRAM() const {
+        return m_controller->getRAM();
+    }
+
+    uint64_t Console::getCycleCount() const {
+        return m_cpu.getCycleCount();
+    }
+
+    uint64_t Console::getFrameCount() const {
+        return m_frameCount;
+    }
+
+    uint64_t Console::getROMHash() const {
+        return m_image->hash;
+    }
+
+    size_t Console::getStateSize() const {
+        return m_stateSize;
+    }
+
+    ErrorOr<size_t> Console::saveState(std::span<uint8_t> t_buffer) const {
+        REQUIRE(t_buffer.size() >= m_stateSize, ERROR_STATE_BUFFER_TOO_SMALL);
+
+        StateWriter writer(t_buffer.first(m_stateSize));
+        writeState(writer);
+        return writer.position();
+    }
+
+    ErrorOr<void> Console::loadState(std::span<const uint8_t> t_state) {
+        // Check everything before touching any component, so a bad state leaves the console as it was
+        BinaryParser parser(t_state);
+        REQUIRE(TRY(parser.read<uint32_t>()) == STATE_MAGIC, ERROR_INVALID_STATE);
+        REQUIRE(TRY(parser.read<uint16_t>()) == STATE_VERSION, ERROR_STATE_VERSION_MISMATCH);
+        REQUIRE(TRY(parser.read<uint32_t>()) == m_stateSize && t_state.size() >= m_stateSize, ERROR_INVALID_STATE);
+        REQUIRE(TRY(parser.read<uint64_t>()) == m_image->hash, ERROR_STATE_ROM_MISMATCH);
+
+        StateReader reader(t_state.subspan(STATE_HEADER_SIZE, m_stateSize - STATE_HEADER_SIZE));
+        reader.value(m_frameCount);
+        m_scheduler.loadState(reader);
+        m_cpu.loadState(reader);
+        m_controller->loadState(reader);
+        m_ppu.loadState(reader);
+        m_apu.loadState(reader);
+
+        return {};
+    }
+
+    std::unique_ptr<Console> Console::fork() const {
+        // This image has made a mapper before, so it can't fail now
+        auto mapper = Mapper::createMapper(m_image, nullptr);
+        ASSERT(!mapper.is_error(), "Failed to recreate the mapper");
+
+        // Children are mostly used for searching, where a frame buffer each would dwarf the rest
+        std::unique_ptr<Console> child(new Console(std::move(mapper).get_value(), std::make_unique<Output::NullVideoSink>()));
+        child->m_ppu.shareMemoryWith(m_ppu);
+        child->m_controller->shareMemoryWith(*m_controller);
+
+        // Component by component, in the order of a save state, so no buffer for the whole state is
+        // needed. The shared pages already hold the copied bytes, so loading leaves them shared.
+        child->m_frameCount = m_frameCount;
+        copyComponentState(m_scheduler, child->m_scheduler);
+        copyComponentState(m_cpu, child->m_cpu);
+        copyComponentState(*m_controller, *child->m_controller);
+        copyComponentState(m_ppu, child->m_ppu);
+        copyComponentState(m_apu, child->m_apu);
+
+        return child;
+    }
+
+    void Console::writeState(StateWriter& t_writer) const {
+        t_writer.value(STATE_MAGIC);
+        t_writer.value(STATE_VERSION);
+        t_writer.value(static_cast<uint32_t>(m_stateSize));
+        t_writer.value(m_image->hash);
+        ASSERT(t_writer.position() == STATE_HEADER_SIZE, "Save state header size is wrong");
+
+        t_writer.value(m_frameCount);
+        m_scheduler.saveState(t_writer);
+        m_cpu.saveState(t_writer);
+        m_controller->saveState(t_writer);
+        m_ppu.saveState(t_writer);
+        m_apu.saveState(t_writer);
+    }
+
+    void Console::runUntil(uint64_t t_cycle, bool t_playAudio) {
+        while (m_cpu.getCycleCount() < t_cycle) {
+            // The APU only has room for so much audio, so long runs hand it over in pieces
+            const uint64_t audioLimit = m_apu.getAudioFrameStart() + AUDIO_FLUSH_CYCLES;
+            const uint64_t end = std::min(t_cycle, audioLimit);
+
+            while (m_cpu.getCycleCount() < end) {
+                m_cpu.executeInstruction();
+                m_scheduler.setCurrentCycle(m_cpu.getCycleCount());
+
+                // Instructions aren't split, so events are handled up to a few cycles late
+                while (m_scheduler.nextEventCycle() <= m_scheduler.now()) {
+                    handleEvent(*m_scheduler.popDueEvent());
+                }
+            }
+
+            if (m_cpu.getCycleCount() >= audioLimit) {
+                endAudioFrame(t_playAudio);
+            }
+        }
+    }
+
+    void Console::handleEvent(Event t_event) {
+        switch (t_event) {
+            case Event::APU_IRQ:
+            case Event::DMC_FETCH:
+                m_apu.catchUp(m_scheduler.now());
+                break;
+
+            case Event::PPU_NMI:
+            case Event::MAPPER_IRQ:
+                m_controller->syncPPU();
+                break;
+
+            default:
+                break;
+        }
+    }
+
+}
@@ -0,0 +1,126 @@
+#ifndef RNES_CONSOLE_INCLUDED
+#define RNES_CONSOLE_INCLUDED
+
+#include <array>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "defines.hpp"
+#include "error_or.hpp"
+#include "scheduler.hpp"
+#include "apu/apu.hpp"
+#include "cpu/cpu.hpp"
+#include "cpu/nes_controller.hpp"
+#include "mapper/mapper.hpp"
+#include "output/audio_sink.hpp"
+#include "output/video_sink.hpp"
+#include "ppu/ppu.hpp"
+
+namespace RNES {
+
+    // Buttons held on both controller ports for one frame, in the order used by Console::setInput
+    using InputFrame = std::array<uint8_t, 2>;
+
+    enum ConsoleError {
+        ERROR_STATE_BUFFER_TOO_SMALL = 0x400,
+        ERROR_INVALID_STATE,
+        ERROR_STATE_VERSION_MISMATCH,
+        ERROR_STATE_ROM_MISMATCH,
+    };
+
+    /* A whole console: the CPU, PPU and APU, the cartridge, and the clock that ties them together.
+     * Consoles don't share any mutable state, so separate instances can run on separate threads.
+     */
+    class Console {
+    public:
+        // Battery-backed RAM is kept in a .sav file next to the ROM
+        static ErrorOr<std::unique_ptr<Console>> fromFile(const char* t_romPath);
+        // Games loaded from a buffer or an image don't save battery-backed RAM
+        static ErrorOr<std::unique_ptr<Console>> fromBuffer(std::span<const uint8_t> t_rom);
+        // Images are read-only and can be shared by any number of consoles on any thread
+        static ErrorOr<std::unique_ptr<Console>> fromImage(const std::shared_ptr<const Mapper::ROMImage>& t_image);
+
+        Console(const Console&) = delete;
+        Console& operator=(const Console&) = delete;
+
+        // Runs until the PPU has finished the next picture
+        void runFrame();
+        // Runs a frame without drawing it or playing its audio, for catching up on frames that have
+        // already been shown once, as rollback does. The console ends up in the same state either way.
+        void skipFrame();
+
+        /* Hides t_frames frames of input lag. Each runFrame() then runs the real frame without
+         * drawing it, saves the state, runs t_frames frames further ahead with the same input and
+         * shows the last of them, then loads the state again. Audio comes from the real frame.
+         * Costs t_frames extra frames of emulation per frame, though only one is drawn.
+         */
+        void setRunAhead(size_t t_frames);
+        void runCycles(uint64_t t_cycles);
+
+        void setInput(size_t t_port, uint8_t t_buttons);
+
+        // Frames are drawn into memory owned by the video sink, and each frame's samples are passed
+        // to the audio sink as soon as it ends. By default frames are kept in a buffer and no audio
+        // is synthesized at all. Sinks can be changed between frames.
+        void setVideoSink(std::unique_ptr<Output::VideoSink> t_sink);
+        void setAudioSink(std::unique_ptr<Output::AudioSink> t_sink);
+
+        // The last frame drawn, or an empty span if the sink doesn't draw frames
+        [[nodiscard]] std::span<const uint32_t> getFrameBuffer() const;
+        [[nodiscard]] std::span<const Word, 0x0800> getRAM() const;
+
+        [[nodiscard]] uint64_t getCycleCount() const;
+        [[nodiscard]] uint64_t getFrameCount() const;
+        // hash64 of the ROM file, which save states and movies are tied to
+        [[nodiscard]] uint64_t getROMHash() const;
+
+        /* Save states hold everything but the ROM, the sinks and the frame being drawn, and can only
+         * be loaded by a console running the same ROM image. The size is fixed for a given image.
+         * Saving and loading don't allocate.
+         */
+        [[nodiscard]] size_t getStateSize() const;
+        // Returns the number of bytes written, which is always getStateSize()
+        ErrorOr<size_t> saveState(std::span<uint8_t> t_buffer) const;
+        ErrorOr<void> loadState(std::span<const uint8_t> t_state);
+
+        /* A new console in exactly this one's state, for searching ahead from it. PRG-RAM, CHR-RAM
+         * and the nametables are shared page by page until either side writes to them, and the ROM
+         * is always shared, so a child costs a few KB plus the pages it writes. The child has its
+         * own copy of everything else, no battery file, no run-ahead, and sinks that discard
+         * everything. Parent and children can run on different threads.
+         */
+        [[nodiscard]] std::unique_ptr<Console> fork() const;
+
+    private:
+        Console(Mapper::Mapper t_mapper, std::unique_ptr<Output::VideoSink> t_videoSink);
+
+        void emulateFrame(bool t_drawVideo, bool t_playAudio);
+        // Hands the audio since the last call to the sink, or drops it
+        void endAudioFrame(bool t_playAudio);
+        void runUntil(uint64_t t_cycle, bool t_playAudio);
+        void handleEvent(Event t_event);
+
+        void writeState(StateWriter& t_writer) const;
+
+        std::shared_ptr<const Mapper::ROMImage> m_image;
+
+        Scheduler m_scheduler;
+        PPU::PPU m_ppu;
+        APU::APU m_apu;
+        CPU::CPU m_cpu;
+        NESController* m_controller; // owned by m_cpu
+
+        std::unique_ptr<Output::VideoSink> m_videoSink;
+        std::unique_ptr<Output::AudioSink> m_audioSink;
+
+        uint64_t m_frameCount;
+        size_t m_stateSize;
+
+        size_t m_runAheadFrames;
+        std::vector<uint8_t> m_runAheadState;
+    };
+
+}
+
+#endif
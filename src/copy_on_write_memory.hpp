@@ -0,0 +1,136 @@
+#ifndef RNES_COPY_ON_WRITE_MEMORY_INCLUDED
+#define RNES_COPY_ON_WRITE_MEMORY_INCLUDED
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <span>
+#include <utility>
+
+#include "assert.hpp"
+#include "defines.hpp"
+#include "save_state.hpp"
+
+namespace RNES {
+
+    /* A block of RAM split into pages that copies share until one of them writes to a page. Copying
+     * only copies the page pointers, so a forked console costs memory in proportion to the pages it
+     * writes to rather than to the size of its RAM. Untouched pages all point at one page of zeros.
+     *
+     * Copies can live on different threads. A page is only written in place by its one owner, which
+     * checks its count with acquire ordering and so sees every other copy's last read of the page
+     * finished, as they let go with release ordering. Nobody else can start sharing the page
+     * meanwhile without going through that owner.
+     */
+    template<size_t SIZE, size_t PAGE_SIZE = 0x100>
+    class CopyOnWriteMemory {
+    public:
+        static_assert(SIZE % PAGE_SIZE == 0, "Memory has to be a whole number of pages");
+
+        CopyOnWriteMemory() = default;
+
+        explicit CopyOnWriteMemory(std::span<const uint8_t> t_contents) : CopyOnWriteMemory() {
+            ASSERT(t_contents.size() == SIZE, "Initial contents are the wrong size");
+            for (size_t i = 0; i < PAGE_COUNT; i++) {
+                setPage(i, t_contents.subspan(i * PAGE_SIZE, PAGE_SIZE));
+            }
+        }
+
+        [[nodiscard]] Word read(size_t t_index) const {
+            return m_pages[t_index / PAGE_SIZE]->bytes[t_index % PAGE_SIZE];
+        }
+
+        void write(size_t t_index, Word t_value) {
+            PageReference& page = m_pages[t_index / PAGE_SIZE];
+            if (!page.isUnique()) {
+                page = PageReference(page->bytes);
+            }
+            page->bytes[t_index % PAGE_SIZE] = t_value;
+        }
+
+        void saveState(StateWriter& t_writer) const {
+            for (const auto& page : m_pages) {
+                t_writer.bytes(page->bytes);
+            }
+        }
+
+        // Pages that already hold the saved bytes stay shared
+        void loadState(StateReader& t_reader) {
+            for (size_t i = 0; i < PAGE_COUNT; i++) {
+                setPage(i, t_reader.view(PAGE_SIZE));
+            }
+        }
+
+    private:
+        static constexpr size_t PAGE_COUNT = SIZE / PAGE_SIZE;
+
+        struct Page {
+            std::atomic<size_t> references;
+            std::array<Word, PAGE_SIZE> bytes;
+        };
+
+        // One counted reference to a page. Default ones share the page of zeros, which is never freed.
+        class PageReference {
+        public:
+            PageReference() : m_page(&zeroPage()) {
+                m_page->references.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // A new page, with nobody else sharing it
+            explicit PageReference(std::span<const Word, PAGE_SIZE> t_bytes) : m_page(new Page{ 1, {} }) {
+                std::memcpy(m_page->bytes.data(), t_bytes.data(), PAGE_SIZE);
+            }
+
+            PageReference(const PageReference& t_other) : m_page(t_other.m_page) {
+                m_page->references.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            PageReference& operator=(PageReference t_other) {
+                std::swap(m_page, t_other.m_page);
+                return *this;
+            }
+
+            ~PageReference() {
+                // Release publishes this copy's reads of the page to whoever ends up owning it alone
+                if (m_page->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    delete m_page;
+                }
+            }
+
+            [[nodiscard]] bool isUnique() const {
+                return m_page->references.load(std::memory_order_acquire) == 1;
+            }
+
+            Page* operator->() const {
+                return m_page;
+            }
+
+        private:
+            Page* m_page;
+        };
+
+        static Page& zeroPage() {
+            // Starts with a reference of its own, so it's never freed
+            static Page s_zeroPage{ 1, {} };
+            return s_zeroPage;
+        }
+
+        void setPage(size_t t_page, std::span<const uint8_t> t_bytes) {
+            PageReference& page = m_pages[t_page];
+            if (std::memcmp(page->bytes.data(), t_bytes.data(), PAGE_SIZE) == 0) {
+                return;
+            }
+
+            if (!page.isUnique()) {
+                page = PageReference(t_bytes.template first<PAGE_SIZE>());
+                return;
+            }
+            std::memcpy(page->bytes.data(), t_bytes.data(), PAGE_SIZE);
+        }
+
+        std::array<PageReference, PAGE_COUNT> m_pages;
+    };
+
+}
+
+#endif
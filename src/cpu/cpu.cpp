@@ -25,6 +25,7 @@ namespace RNES::CPU {
         , m_x(0x00)
         , m_y(0x00)
         , m_st(0x00)
+        , m_cycleCount(0)
         , m_interruptFlags({ false, false, false })
     {
         ;
@@ -34,6 +35,13 @@ namespace RNES::CPU {
         m_controller = std::move(t_controller);
     }
 
+    void CPU::reset() {
+        m_sp = 0xFD;
+        m_st = 0b00100100; // interrupts disabled
+        m_pc = m_controller->readDWord(0xFFFC);
+        m_cycleCount += 7;
+    }
+
     void CPU::printRegisters() const {
         std::cout
             << "PC:  0x" << std::hex << std::setw(4) << std::setfill('0') << (int)m_pc << " (0x" << (int)m_controller->readWord(m_pc) << ")\n"
@@ -115,10 +123,24 @@ namespace RNES::CPU {
         ASSERT(info.id != InstructionId::NONE, "Invalid opcode");
 
         const Instruction instructionPointer = INSTRUCTION_POINTERS[static_cast<size_t>(info.id)];
+        const InstructionTiming timing = TIMING_TABLE[opcode];
+
+        // Has to be checked before the instruction changes the registers it depends on
+        const bool pageCrossed = timing.pageCrossPenalty && crossesPage(info.addressMode);
+        const bool branchTaken = info.addressMode == AddressMode::RELATIVE && isBranchTaken(info.id);
+        const Address nextPc = m_pc + instructionSize(info.addressMode);
 
         // call the function obtained from the table
         (this->*instructionPointer)(info.addressMode);
 
+        m_cycleCount += timing.cycles + (pageCrossed ? 1 : 0) + m_controller->takeStallCycles();
+
+        // Taken branches cost an extra cycle, or two if they land on another page, even when they
+        // land on the next instruction
+        if (branchTaken) {
+            m_cycleCount += ((m_pc & 0xFF00U) != (nextPc & 0xFF00U)) ? 2 : 1;
+        }
+
         return false;
     }
 
@@ -126,6 +148,36 @@ namespace RNES::CPU {
         // TODO
     }
 
+    uint64_t CPU::getCycleCount() const {
+        return m_cycleCount;
+    }
+
+    void CPU::saveState(StateWriter& t_writer) const {
+        t_writer.value(m_pc);
+        t_writer.value(m_sp);
+        t_writer.value(m_acc);
+        t_writer.value(m_x);
+        t_writer.value(m_y);
+        t_writer.value(m_st);
+        t_writer.value(m_cycleCount);
+        t_writer.value(m_interruptFlags.irq);
+        t_writer.value(m_interruptFlags.brk);
+        t_writer.value(m_interruptFlags.nmi);
+    }
+
+    void CPU::loadState(StateReader& t_reader) {
+        t_reader.value(m_pc);
+        t_reader.value(m_sp);
+        t_reader.value(m_acc);
+        t_reader.value(m_x);
+        t_reader.value(m_y);
+        t_reader.value(m_st);
+        t_reader.value(m_cycleCount);
+        t_reader.value(m_interruptFlags.irq);
+        t_reader.value(m_interruptFlags.brk);
+        t_reader.value(m_interruptFlags.nmi);
+    }
+
     bool CPU::getFlag(StatusFlag t_flag) const {
         return !!(m_st & static_cast<Word>(t_flag));
     }
@@ -239,6 +291,47 @@ namespace RNES::CPU {
         }
     }
 
+    bool CPU::crossesPage(AddressMode t_mode) const {
+        switch (t_mode) {
+            case AddressMode::ABSOLUTE_X:
+                return (m_controller->readWord(m_pc + 1) + m_x) > 0xFFU;
+
+            case AddressMode::ABSOLUTE_Y:
+                return (m_controller->readWord(m_pc + 1) + m_y) > 0xFFU;
+
+            case AddressMode::INDIRECT_INDEXED: {
+                const Address zeroPageAddress = m_controller->readWord(m_pc + 1);
+                return (m_controller->readWord(zeroPageAddress) + m_y) > 0xFFU;
+            }
+
+            default:
+                return false;
+        }
+    }
+
+    bool CPU::isBranchTaken(InstructionId t_id) const {
+        switch (t_id) {
+            case InstructionId::BCC:
+                return !getFlag(StatusFlag::CARRY);
+            case InstructionId::BCS:
+                return getFlag(StatusFlag::CARRY);
+            case InstructionId::BNE:
+                return !getFlag(StatusFlag::ZERO);
+            case InstructionId::BEQ:
+                return getFlag(StatusFlag::ZERO);
+            case InstructionId::BPL:
+                return !getFlag(StatusFlag::NEGATIVE);
+            case InstructionId::BMI:
+                return getFlag(StatusFlag::NEGATIVE);
+            case InstructionId::BVC:
+                return !getFlag(StatusFlag::OVERFLOW);
+            case InstructionId::BVS:
+                return getFlag(StatusFlag::OVERFLOW);
+            default:
+                return false;
+        }
+    }
+
     void CPU::generateIRQ() {
         m_interruptFlags.irq = true;
     }
@@ -252,9 +345,16 @@ namespace RNES::CPU {
     }
 
     void CPU::handleInterrupts() {
-        if (m_interruptFlags.nmi) {
+        if (m_interruptFlags.nmi || m_controller->takeNMI()) {
             m_interruptFlags.nmi = false;
-            ASSERT(false, "TODO: implement this");
+
+            stackPushDWord(m_pc);
+            stackPushWord(m_st | 0b00100000);
+
+            setFlag(StatusFlag::INTERRUPT_DISABLE, true);
+
+            m_pc = m_controller->readDWord(0xFFFA);
+            m_cycleCount += 7;
         }
         else if (m_interruptFlags.brk) {
             m_interruptFlags.brk = false;
@@ -266,9 +366,16 @@ namespace RNES::CPU {
 
             m_pc = m_controller->readDWord(0xFFFE);
         }
-        else if (m_interruptFlags.irq && getFlag(StatusFlag::INTERRUPT_DISABLE)) {
+        else if ((m_interruptFlags.irq || m_controller->isIRQAsserted()) && !getFlag(StatusFlag::INTERRUPT_DISABLE)) {
             m_interruptFlags.irq = false;
-            ASSERT(false, "TODO: implement this");
+
+            stackPushDWord(m_pc);
+            stackPushWord(m_st | 0b00100000);
+
+            setFlag(StatusFlag::INTERRUPT_DISABLE, true);
+
+            m_pc = m_controller->readDWord(0xFFFE);
+            m_cycleCount += 7;
         }
     }
 
@@ -7,8 +7,10 @@
 #include <set>
 #include <variant>
 
+#include "cpu_alu.hpp"
 #include "cpu_memory_map.hpp"
 #include "defines.hpp"
+#include "save_state.hpp"
 
 namespace RNES::CPU {
 
@@ -364,6 +366,271 @@ namespace RNES::CPU {
         { InstructionId::NONE,  AddressMode::NONE },             /* 0xff */
     }};
 
+    struct InstructionTiming {
+        uint8_t cycles;
+        bool pageCrossPenalty; // takes an extra cycle when indexing crosses a page
+    };
+
+    // Generated by scripts/cpu/create_timing_table.py. Taken branches are handled separately.
+    constexpr std::array<InstructionTiming, 256> TIMING_TABLE {{
+        { 7, false },  /* 0x00 */
+        { 6, false },  /* 0x01 */
+        { 0, false },  /* 0x02 */
+        { 0, false },  /* 0x03 */
+        { 0, false },  /* 0x04 */
+        { 3, false },  /* 0x05 */
+        { 5, false },  /* 0x06 */
+        { 0, false },  /* 0x07 */
+        { 3, false },  /* 0x08 */
+        { 2, false },  /* 0x09 */
+        { 2, false },  /* 0x0a */
+        { 0, false },  /* 0x0b */
+        { 0, false },  /* 0x0c */
+        { 4, false },  /* 0x0d */
+        { 6, false },  /* 0x0e */
+        { 0, false },  /* 0x0f */
+        { 2, false },  /* 0x10 */
+        { 5, true },   /* 0x11 */
+        { 0, false },  /* 0x12 */
+        { 0, false },  /* 0x13 */
+        { 0, false },  /* 0x14 */
+        { 4, false },  /* 0x15 */
+        { 6, false },  /* 0x16 */
+        { 0, false },  /* 0x17 */
+        { 2, false },  /* 0x18 */
+        { 4, true },   /* 0x19 */
+        { 0, false },  /* 0x1a */
+        { 0, false },  /* 0x1b */
+        { 0, false },  /* 0x1c */
+        { 4, true },   /* 0x1d */
+        { 7, false },  /* 0x1e */
+        { 0, false },  /* 0x1f */
+        { 6, false },  /* 0x20 */
+        { 6, false },  /* 0x21 */
+        { 0, false },  /* 0x22 */
+        { 0, false },  /* 0x23 */
+        { 3, false },  /* 0x24 */
+        { 3, false },  /* 0x25 */
+        { 5, false },  /* 0x26 */
+        { 0, false },  /* 0x27 */
+        { 4, false },  /* 0x28 */
+        { 2, false },  /* 0x29 */
+        { 2, false },  /* 0x2a */
+        { 0, false },  /* 0x2b */
+        { 4, false },  /* 0x2c */
+        { 4, false },  /* 0x2d */
+        { 6, false },  /* 0x2e */
+        { 0, false },  /* 0x2f */
+        { 2, false },  /* 0x30 */
+        { 5, true },   /* 0x31 */
+        { 0, false },  /* 0x32 */
+        { 0, false },  /* 0x33 */
+        { 0, false },  /* 0x34 */
+        { 4, false },  /* 0x35 */
+        { 6, false },  /* 0x36 */
+        { 0, false },  /* 0x37 */
+        { 2, false },  /* 0x38 */
+        { 4, true },   /* 0x39 */
+        { 0, false },  /* 0x3a */
+        { 0, false },  /* 0x3b */
+        { 0, false },  /* 0x3c */
+        { 4, true },   /* 0x3d */
+        { 7, false },  /* 0x3e */
+        { 0, false },  /* 0x3f */
+        { 6, false },  /* 0x40 */
+        { 6, false },  /* 0x41 */
+        { 0, false },  /* 0x42 */
+        { 0, false },  /* 0x43 */
+        { 0, false },  /* 0x44 */
+        { 3, false },  /* 0x45 */
+        { 5, false },  /* 0x46 */
+        { 0, false },  /* 0x47 */
+        { 3, false },  /* 0x48 */
+        { 2, false },  /* 0x49 */
+        { 2, false },  /* 0x4a */
+        { 0, false },  /* 0x4b */
+        { 3, false },  /* 0x4c */
+        { 4, false },  /* 0x4d */
+        { 6, false },  /* 0x4e */
+        { 0, false },  /* 0x4f */
+        { 2, false },  /* 0x50 */
+        { 5, true },   /* 0x51 */
+        { 0, false },  /* 0x52 */
+        { 0, false },  /* 0x53 */
+        { 0, false },  /* 0x54 */
+        { 4, false },  /* 0x55 */
+        { 6, false },  /* 0x56 */
+        { 0, false },  /* 0x57 */
+        { 2, false },  /* 0x58 */
+        { 4, true },   /* 0x59 */
+        { 0, false },  /* 0x5a */
+        { 0, false },  /* 0x5b */
+        { 0, false },  /* 0x5c */
+        { 4, true },   /* 0x5d */
+        { 7, false },  /* 0x5e */
+        { 0, false },  /* 0x5f */
+        { 6, false },  /* 0x60 */
+        { 6, false },  /* 0x61 */
+        { 0, false },  /* 0x62 */
+        { 0, false },  /* 0x63 */
+        { 0, false },  /* 0x64 */
+        { 3, false },  /* 0x65 */
+        { 5, false },  /* 0x66 */
+        { 0, false },  /* 0x67 */
+        { 4, false },  /* 0x68 */
+        { 2, false },  /* 0x69 */
+        { 2, false },  /* 0x6a */
+        { 0, false },  /* 0x6b */
+        { 5, false },  /* 0x6c */
+        { 4, false },  /* 0x6d */
+        { 6, false },  /* 0x6e */
+        { 0, false },  /* 0x6f */
+        { 2, false },  /* 0x70 */
+        { 5, true },   /* 0x71 */
+        { 0, false },  /* 0x72 */
+        { 0, false },  /* 0x73 */
+        { 0, false },  /* 0x74 */
+        { 4, false },  /* 0x75 */
+        { 6, false },  /* 0x76 */
+        { 0, false },  /* 0x77 */
+        { 2, false },  /* 0x78 */
+        { 4, true },   /* 0x79 */
+        { 0, false },  /* 0x7a */
+        { 0, false },  /* 0x7b */
+        { 0, false },  /* 0x7c */
+        { 4, true },   /* 0x7d */
+        { 7, false },  /* 0x7e */
+        { 0, false },  /* 0x7f */
+        { 0, false },  /* 0x80 */
+        { 6, false },  /* 0x81 */
+        { 0, false },  /* 0x82 */
+        { 0, false },  /* 0x83 */
+        { 3, false },  /* 0x84 */
+        { 3, false },  /* 0x85 */
+        { 3, false },  /* 0x86 */
+        { 0, false },  /* 0x87 */
+        { 2, false },  /* 0x88 */
+        { 0, false },  /* 0x89 */
+        { 2, false },  /* 0x8a */
+        { 0, false },  /* 0x8b */
+        { 4, false },  /* 0x8c */
+        { 4, false },  /* 0x8d */
+        { 4, false },  /* 0x8e */
+        { 0, false },  /* 0x8f */
+        { 2, false },  /* 0x90 */
+        { 6, false },  /* 0x91 */
+        { 0, false },  /* 0x92 */
+        { 0, false },  /* 0x93 */
+        { 4, false },  /* 0x94 */
+        { 4, false },  /* 0x95 */
+        { 4, false },  /* 0x96 */
+        { 0, false },  /* 0x97 */
+        { 2, false },  /* 0x98 */
+        { 5, false },  /* 0x99 */
+        { 2, false },  /* 0x9a */
+        { 0, false },  /* 0x9b */
+        { 0, false },  /* 0x9c */
+        { 5, false },  /* 0x9d */
+        { 0, false },  /* 0x9e */
+        { 0, false },  /* 0x9f */
+        { 2, false },  /* 0xa0 */
+        { 6, false },  /* 0xa1 */
+        { 2, false },  /* 0xa2 */
+        { 0, false },  /* 0xa3 */
+        { 3, false },  /* 0xa4 */
+        { 3, false },  /* 0xa5 */
+        { 3, false },  /* 0xa6 */
+        { 0, false },  /* 0xa7 */
+        { 2, false },  /* 0xa8 */
+        { 2, false },  /* 0xa9 */
+        { 2, false },  /* 0xaa */
+        { 0, false },  /* 0xab */
+        { 4, false },  /* 0xac */
+        { 4, false },  /* 0xad */
+        { 4, false },  /* 0xae */
+        { 0, false },  /* 0xaf */
+        { 2, false },  /* 0xb0 */
+        { 5, true },   /* 0xb1 */
+        { 0, false },  /* 0xb2 */
+        { 0, false },  /* 0xb3 */
+        { 4, false },  /* 0xb4 */
+        { 4, false },  /* 0xb5 */
+        { 4, false },  /* 0xb6 */
+        { 0, false },  /* 0xb7 */
+        { 2, false },  /* 0xb8 */
+        { 4, true },   /* 0xb9 */
+        { 2, false },  /* 0xba */
+        { 0, false },  /* 0xbb */
+        { 4, true },   /* 0xbc */
+        { 4, true },   /* 0xbd */
+        { 4, true },   /* 0xbe */
+        { 0, false },  /* 0xbf */
+        { 2, false },  /* 0xc0 */
+        { 6, false },  /* 0xc1 */
+        { 0, false },  /* 0xc2 */
+        { 0, false },  /* 0xc3 */
+        { 3, false },  /* 0xc4 */
+        { 3, false },  /* 0xc5 */
+        { 5, false },  /* 0xc6 */
+        { 0, false },  /* 0xc7 */
+        { 2, false },  /* 0xc8 */
+        { 2, false },  /* 0xc9 */
+        { 2, false },  /* 0xca */
+        { 0, false },  /* 0xcb */
+        { 4, false },  /* 0xcc */
+        { 4, false },  /* 0xcd */
+        { 6, false },  /* 0xce */
+        { 0, false },  /* 0xcf */
+        { 2, false },  /* 0xd0 */
+        { 5, true },   /* 0xd1 */
+        { 0, false },  /* 0xd2 */
+        { 0, false },  /* 0xd3 */
+        { 0, false },  /* 0xd4 */
+        { 4, false },  /* 0xd5 */
+        { 6, false },  /* 0xd6 */
+        { 0, false },  /* 0xd7 */
+        { 2, false },  /* 0xd8 */
+        { 4, true },   /* 0xd9 */
+        { 0, false },  /* 0xda */
+        { 0, false },  /* 0xdb */
+        { 0, false },  /* 0xdc */
+        { 4, true },   /* 0xdd */
+        { 7, false },  /* 0xde */
+        { 0, false },  /* 0xdf */
+        { 2, false },  /* 0xe0 */
+        { 6, false },  /* 0xe1 */
+        { 0, false },  /* 0xe2 */
+        { 0, false },  /* 0xe3 */
+        { 3, false },  /* 0xe4 */
+        { 3, false },  /* 0xe5 */
+        { 5, false },  /* 0xe6 */
+        { 0, false },  /* 0xe7 */
+        { 2, false },  /* 0xe8 */
+        { 2, false },  /* 0xe9 */
+        { 2, false },  /* 0xea */
+        { 0, false },  /* 0xeb */
+        { 4, false },  /* 0xec */
+        { 4, false },  /* 0xed */
+        { 6, false },  /* 0xee */
+        { 0, false },  /* 0xef */
+        { 2, false },  /* 0xf0 */
+        { 5, true },   /* 0xf1 */
+        { 0, false },  /* 0xf2 */
+        { 0, false },  /* 0xf3 */
+        { 0, false },  /* 0xf4 */
+        { 4, false },  /* 0xf5 */
+        { 6, false },  /* 0xf6 */
+        { 0, false },  /* 0xf7 */
+        { 2, false },  /* 0xf8 */
+        { 4, true },   /* 0xf9 */
+        { 0, false },  /* 0xfa */
+        { 0, false },  /* 0xfb */
+        { 0, false },  /* 0xfc */
+        { 4, true },   /* 0xfd */
+        { 7, false },  /* 0xfe */
+        { 0, false },  /* 0xff */
+    }};
+
     [[nodiscard]] constexpr size_t instructionSize(AddressMode t_mode) {
         const std::array<size_t, ADDRESS_MODE_COUNT> AMOUNT_TABLE {{
             1, // IMPLICIT
@@ -401,23 +668,31 @@ namespace RNES::CPU {
 
         void setController(std::unique_ptr<CPUMemoryMap> t_controller);
 
+        // Loads the reset vector, as on power up
+        void reset();
+
         bool executeInstruction();
         void cycle();
         void printRegisters() const;
 
+        [[nodiscard]] uint64_t getCycleCount() const;
+
+        // Registers only; the memory map saves its own state
+        void saveState(StateWriter& t_writer) const;
+        void loadState(StateReader& t_reader);
 
     private:
         //----- Defines -----//
 
         enum class StatusFlag : Word {
-            CARRY             = 0b00000001,
-            ZERO              = 0b00000010,
-            INTERRUPT_DISABLE = 0b00000100,
-            DECIMAL           = 0b00001000,
-            B1                = 0b00010000,
-            B2                = 0b00100000,
-            OVERFLOW          = 0b01000000,
-            NEGATIVE          = 0b10000000
+            CARRY             = STATUS_CARRY,
+            ZERO              = STATUS_ZERO,
+            INTERRUPT_DISABLE = STATUS_INTERRUPT_DISABLE,
+            DECIMAL           = STATUS_DECIMAL,
+            B1                = STATUS_B1,
+            B2                = STATUS_B2,
+            OVERFLOW          = STATUS_OVERFLOW,
+            NEGATIVE          = STATUS_NEGATIVE
         };
 
         class WordReference {
@@ -448,6 +723,8 @@ namespace RNES::CPU {
         Word m_y;
         Word m_st;
 
+        uint64_t m_cycleCount;
+
         struct {
             bool irq;
             bool brk;
@@ -461,6 +738,10 @@ namespace RNES::CPU {
         [[nodiscard]] WordReference getWordArgument(AddressMode t_mode);
         [[nodiscard]] Address getAddressArgument(AddressMode t_mode);
 
+        [[nodiscard]] bool crossesPage(AddressMode t_mode) const;
+        // Whether the branch t_id would be taken with the flags as they are
+        [[nodiscard]] bool isBranchTaken(InstructionId t_id) const;
+
         //----- Interrupts -----//
         void generateIRQ();
         void generateBRK();
@@ -0,0 +1,176 @@
+#ifndef RNES_CPU_ALU_INCLUDED
+#define RNES_CPU_ALU_INCLUDED
+
+#include <type_traits>
+
+#include "cpu_memory_map.hpp"
+#include "defines.hpp"
+
+namespace RNES::CPU {
+
+    // Bits of the status register. Plain constants rather than an enum, so they also combine with vectors.
+    constexpr Word STATUS_CARRY             = 0b00000001;
+    constexpr Word STATUS_ZERO              = 0b00000010;
+    constexpr Word STATUS_INTERRUPT_DISABLE = 0b00000100;
+    constexpr Word STATUS_DECIMAL           = 0b00001000;
+    constexpr Word STATUS_B1                = 0b00010000;
+    constexpr Word STATUS_B2                = 0b00100000;
+    constexpr Word STATUS_OVERFLOW          = 0b01000000;
+    constexpr Word STATUS_NEGATIVE          = 0b10000000;
+
+}
+
+/* The data path of the instructions, shared by CPU and LockstepCPU. Every function is written once
+ * for any Word-like type T: a Word for a single CPU, or a compiler vector of Words when many CPUs run
+ * the same instruction at once. Results are returned and the status register is updated in place.
+ *
+ * Comparisons give a bool for Words but a lane mask of 0 or ~0 for vectors, so conditions are only
+ * ever turned into flags through flagIf().
+ */
+namespace RNES::CPU::ALU {
+
+    template<typename T, typename C>
+    inline T flagIf(C t_condition, Word t_flag) {
+        if constexpr (std::is_integral_v<T>) {
+            return t_condition ? t_flag : 0;
+        }
+        else {
+            return reinterpret_cast<T>(t_condition) & t_flag;
+        }
+    }
+
+    template<typename T>
+    inline void setZN(T& t_st, T t_value) {
+        t_st = (t_st & static_cast<Word>(~(STATUS_ZERO | STATUS_NEGATIVE)))
+             | flagIf<T>(t_value == 0, STATUS_ZERO)
+             | (t_value & STATUS_NEGATIVE);
+    }
+
+    template<typename T>
+    inline T add(T& t_st, T t_acc, T t_arg) {
+        const T carryIn = t_st & STATUS_CARRY;
+        const T result = t_acc + t_arg + carryIn;
+
+        // Without a wider type the carry out is recovered from the wrapped sum
+        const T carry = flagIf<T>((result < t_acc) | ((result == t_acc) & (carryIn != 0)), STATUS_CARRY);
+        const T overflow = ((~(t_acc ^ t_arg) & (t_acc ^ result)) >> 1) & STATUS_OVERFLOW;
+
+        t_st = (t_st & static_cast<Word>(~(STATUS_CARRY | STATUS_OVERFLOW))) | carry | overflow;
+        setZN(t_st, result);
+        return result;
+    }
+
+    template<typename T>
+    inline T subtract(T& t_st, T t_acc, T t_arg) {
+        return add<T>(t_st, t_acc, static_cast<T>(~t_arg));
+    }
+
+    template<typename T>
+    inline void compare(T& t_st, T t_register, T t_arg) {
+        t_st = (t_st & static_cast<Word>(~STATUS_CARRY)) | flagIf<T>(t_register >= t_arg, STATUS_CARRY);
+        setZN(t_st, static_cast<T>(t_register - t_arg));
+    }
+
+    template<typename T>
+    inline void bitTest(T& t_st, T t_acc, T t_value) {
+        t_st = (t_st & static_cast<Word>(~(STATUS_ZERO | STATUS_OVERFLOW | STATUS_NEGATIVE)))
+             | flagIf<T>((t_acc & t_value) == 0, STATUS_ZERO)
+             | (t_value & (STATUS_OVERFLOW | STATUS_NEGATIVE));
+    }
+
+    template<typename T>
+    inline T shiftLeft(T& t_st, T t_value) {
+        const T result = t_value << 1;
+
+        t_st = (t_st & static_cast<Word>(~STATUS_CARRY)) | (t_value >> 7);
+        setZN(t_st, result);
+        return result;
+    }
+
+    template<typename T>
+    inline T shiftRight(T& t_st, T t_value) {
+        const T result = t_value >> 1;
+
+        t_st = (t_st & static_cast<Word>(~STATUS_CARRY)) | (t_value & STATUS_CARRY);
+        setZN(t_st, result);
+        return result;
+    }
+
+    template<typename T>
+    inline T rotateLeft(T& t_st, T t_value) {
+        const T result = (t_value << 1) | (t_st & STATUS_CARRY);
+
+        t_st = (t_st & static_cast<Word>(~STATUS_CARRY)) | (t_value >> 7);
+        setZN(t_st, result);
+        return result;
+    }
+
+    template<typename T>
+    inline T rotateRight(T& t_st, T t_value) {
+        const T result = (t_value >> 1) | ((t_st & STATUS_CARRY) << 7);
+
+        t_st = (t_st & static_cast<Word>(~STATUS_CARRY)) | (t_value & STATUS_CARRY);
+        setZN(t_st, result);
+        return result;
+    }
+
+    template<typename T>
+    inline T increment(T& t_st, T t_value) {
+        const T result = t_value + 1;
+        setZN(t_st, result);
+        return result;
+    }
+
+    template<typename T>
+    inline T decrement(T& t_st, T t_value) {
+        const T result = t_value - 1;
+        setZN(t_st, result);
+        return result;
+    }
+
+    // Decimal mode is rare enough that it only has a scalar version. The overflow flag is left alone.
+    inline Word addDecimal(Word& t_st, Word t_acc, Word t_arg) {
+        const Word accLo = (t_acc & 0x0F) >> 0;
+        const Word accHi = (t_acc & 0xF0) >> 4;
+        const Word argLo = (t_arg & 0x0F) >> 0;
+        const Word argHi = (t_arg & 0xF0) >> 4;
+
+        const Word sumLo = accLo + argLo + (t_st & STATUS_CARRY);
+        const Word resultLo = sumLo % 10;
+        const bool carryLo = (sumLo != resultLo);
+
+        const Word sumHi = accHi + argHi + carryLo;
+        const Word resultHi = sumHi % 10;
+        const bool carryHi = (sumHi != resultHi);
+
+        const Word result = (resultHi << 4) | (resultLo << 0);
+
+        t_st = (t_st & static_cast<Word>(~STATUS_CARRY)) | flagIf<Word>(carryHi, STATUS_CARRY);
+        setZN(t_st, result);
+        return result;
+    }
+
+    inline Word subtractDecimal(Word& t_st, Word t_acc, Word t_arg) {
+        const Word accLo = (t_acc & 0x0F) >> 0;
+        const Word accHi = (t_acc & 0xF0) >> 4;
+        const Word argLo = (t_arg & 0x0F) >> 0;
+        const Word argHi = (t_arg & 0xF0) >> 4;
+
+        const Word diffLo = accLo - argLo - (1 - (t_st & STATUS_CARRY));
+        const bool borrowLo = !!(diffLo & 0x80);
+        const Word resultLo = borrowLo ? (diffLo + 10) : diffLo;
+
+        const Word diffHi = accHi - argHi - borrowLo;
+        const bool borrowHi = !!(diffHi & 0x80);
+        const Word resultHi = borrowHi ? (diffHi + 10) : diffHi;
+
+        const Word result = (resultHi << 4) | (resultLo << 0);
+
+        t_st = (t_st & static_cast<Word>(~STATUS_CARRY)) | flagIf<Word>(!borrowHi, STATUS_CARRY);
+        setZN(t_st, result);
+        return result;
+    }
+
+}
+
+#endif
@@ -192,11 +192,7 @@ namespace RNES::CPU {
 
     void CPU::instructionBIT(AddressMode t_addressMode) {
         const Word value = getWordArgument(t_addressMode);
-        const Word result = m_acc & value;
-
-        setFlag(StatusFlag::ZERO, result == 0);
-        setFlag(StatusFlag::OVERFLOW, value & 0b01000000);
-        setFlag(StatusFlag::NEGATIVE, value & 0b10000000);
+        ALU::bitTest(m_st, m_acc, value);
 
         m_pc += instructionSize(t_addressMode);
     }
@@ -206,42 +202,11 @@ namespace RNES::CPU {
         const Word arg = getWordArgument(t_addressMode);
 
         if (!getFlag(StatusFlag::DECIMAL)) {
-            const Word oldAcc = m_acc;
-            const DWord result = m_acc + arg + getFlag(StatusFlag::CARRY);
-
-            m_acc = result & 0x00FFU;
-
-            setFlag(StatusFlag::ZERO, m_acc == 0);
-            setFlag(StatusFlag::NEGATIVE, m_acc & 0x80U);
-            setFlag(StatusFlag::CARRY, result & 0xFF00);
-
-            const bool overflow = (~(oldAcc ^ arg) & (oldAcc ^ m_acc)) & 0x80;
-            setFlag(StatusFlag::OVERFLOW, overflow);
+            m_acc = ALU::add(m_st, m_acc, arg);
         }
         else {
-            const Word accLo = (m_acc & 0x0F) >> 0;
-            const Word accHi = (m_acc & 0xF0) >> 4;
-            const Word argLo = (arg & 0x0F) >> 0;
-            const Word argHi = (arg & 0xF0) >> 4;
-
-
-            const Word sumLo = accLo + argLo + getFlag(StatusFlag::CARRY);
-            const Word resultLo = sumLo % 10;
-            const bool carryLo = (sumLo != resultLo);
-
-            const Word sumHi = accHi + argHi + carryLo;
-            const Word resultHi = sumHi % 10;
-            const bool carryHi = (sumHi != resultHi);
-
-            const Word result = (resultHi << 4) | (resultLo << 0);
-
-            m_acc = result;
-
-            setFlag(StatusFlag::ZERO, m_acc == 0);
-            setFlag(StatusFlag::NEGATIVE, m_acc & 0x80U);
-            setFlag(StatusFlag::CARRY, carryHi);
-
             // TODO: figure out what to do for the overflow flag here
+            m_acc = ALU::addDecimal(m_st, m_acc, arg);
         }
 
         m_pc += instructionSize(t_addressMode);
@@ -251,82 +216,33 @@ namespace RNES::CPU {
         const Word arg = getWordArgument(t_addressMode);
 
         if (!getFlag(StatusFlag::DECIMAL)) {
-            const Word oldAcc = m_acc;
-            const Word argComp = ~arg;
-            const DWord result = m_acc + argComp + getFlag(StatusFlag::CARRY);
-
-            m_acc = result & 0x00FFU;
-
-            setFlag(StatusFlag::ZERO, m_acc == 0);
-            setFlag(StatusFlag::NEGATIVE, m_acc & 0x80U);
-            setFlag(StatusFlag::CARRY, result & 0xFF00);
-
-            const bool overflow = (~(oldAcc ^ argComp) & (oldAcc ^ m_acc)) & 0x80;
-            setFlag(StatusFlag::OVERFLOW, overflow);
+            m_acc = ALU::subtract(m_st, m_acc, arg);
         }
         else {
-            const Word accLo = (m_acc & 0x0F) >> 0;
-            const Word accHi = (m_acc & 0xF0) >> 4;
-            const Word argLo = (arg & 0x0F) >> 0;
-            const Word argHi = (arg & 0xF0) >> 4;
-
-            const Word diffLo = accLo - argLo - (1 - getFlag(StatusFlag::CARRY));
-            const bool borrowLo = !!(diffLo & 0x80);
-            const Word resultLo = borrowLo ? (diffLo + 10) : diffLo;
-
-            const Word diffHi = accHi - argHi - borrowLo;
-            const bool borrowHi = !!(diffHi & 0x80);
-            const Word resultHi = borrowHi ? (diffHi + 10) : diffHi;
-
-            const Word result = (resultHi << 4) | (resultLo << 0);
-
-            m_acc = result;
-
-            setFlag(StatusFlag::ZERO, m_acc == 0);
-            setFlag(StatusFlag::NEGATIVE, m_acc & 0x80U);
-            setFlag(StatusFlag::CARRY, !borrowHi);
-
             // TODO: overflow
+            m_acc = ALU::subtractDecimal(m_st, m_acc, arg);
         }
 
         m_pc += instructionSize(t_addressMode);
     }
 
     void CPU::instructionCMP(AddressMode t_addressMode) {
-        const Word v1 = m_acc;
-        const Word v2 = getWordArgument(t_addressMode);
-
-        const Word result = v1 - v2;
-
-        setFlag(StatusFlag::CARRY, v1 >= v2);
-        setFlag(StatusFlag::ZERO, v1 == v2);
-        setFlag(StatusFlag::NEGATIVE, result & 0x80U);
+        const Word arg = getWordArgument(t_addressMode);
+        ALU::compare(m_st, m_acc, arg);
 
         m_pc += instructionSize(t_addressMode);
     }
 
     void CPU::instructionCPX(AddressMode t_addressMode) {
-        const Word v1 = m_x;
-        const Word v2 = getWordArgument(t_addressMode);
-
-        const Word result = v1 - v2;
-
-        setFlag(StatusFlag::CARRY, v1 >= v2);
-        setFlag(StatusFlag::ZERO, v1 == v2);
-        setFlag(StatusFlag::NEGATIVE, result & 0x80U);
+        const Word arg = getWordArgument(t_addressMode);
+        ALU::compare(m_st, m_x, arg);
 
         m_pc += instructionSize(t_addressMode);
     }
 
     void CPU::instructionCPY(AddressMode t_addressMode) {
-        const Word v1 = m_y;
-        const Word v2 = getWordArgument(t_addressMode);
-
-        const Word result = v1 - v2;
-
-        setFlag(StatusFlag::CARRY, v1 >= v2);
-        setFlag(StatusFlag::ZERO, v1 == v2);
-        setFlag(StatusFlag::NEGATIVE, result & 0x80U);
+        const Word arg = getWordArgument(t_addressMode);
+        ALU::compare(m_st, m_y, arg);
 
         m_pc += instructionSize(t_addressMode);
     }
@@ -334,12 +250,7 @@ namespace RNES::CPU {
 
     void CPU::instructionINC(AddressMode t_addressMode) {
         WordReference word = getWordArgument(t_addressMode);
-        const Word result = word + 1;
-
-        word = result;
-
-        setFlag(StatusFlag::ZERO, result == 0);
-        setFlag(StatusFlag::NEGATIVE, result & 0x80U);
+        word = ALU::increment(m_st, Word(word));
 
         m_pc += instructionSize(t_addressMode);
     }
@@ -368,12 +279,7 @@ namespace RNES::CPU {
 
     void CPU::instructionDEC(AddressMode t_addressMode) {
         WordReference word = getWordArgument(t_addressMode);
-        const Word result = word - 1;
-
-        word = result;
-
-        setFlag(StatusFlag::ZERO, result == 0);
-        setFlag(StatusFlag::NEGATIVE, result & 0x80U);
+        word = ALU::decrement(m_st, Word(word));
 
         m_pc += instructionSize(t_addressMode);
     }
@@ -403,56 +309,28 @@ namespace RNES::CPU {
 
     void CPU::instructionASL(AddressMode t_addressMode) {
         WordReference word = getWordArgument(t_addressMode);
-        const Word value = word;
-        const Word result = value << 1;
-
-        word = result;
-
-        setFlag(StatusFlag::CARRY, value & 0x80U);
-        setFlag(StatusFlag::ZERO, result == 0);
-        setFlag(StatusFlag::NEGATIVE, result & 0x80U);
+        word = ALU::shiftLeft(m_st, Word(word));
 
         m_pc += instructionSize(t_addressMode);
     }
 
     void CPU::instructionLSR(AddressMode t_addressMode) {
         WordReference word = getWordArgument(t_addressMode);
-        const Word value = word;
-        const Word result = value >> 1;
-
-        word = result;
-
-        setFlag(StatusFlag::CARRY, value & 0x01U);
-        setFlag(StatusFlag::ZERO, result == 0);
-        setFlag(StatusFlag::NEGATIVE, result & 0x80U);
+        word = ALU::shiftRight(m_st, Word(word));
 
         m_pc += instructionSize(t_addressMode);
     }
 
     void CPU::instructionROL(AddressMode t_addressMode) {
         WordReference word = getWordArgument(t_addressMode);
-        const Word value = word;
-        const Word result = (value << 1) | getFlag(StatusFlag::CARRY);
-
-        word = result;
-
-        setFlag(StatusFlag::CARRY, value & 0x80U);
-        setFlag(StatusFlag::ZERO, result == 0);
-        setFlag(StatusFlag::NEGATIVE, result & 0x80U);
+        word = ALU::rotateLeft(m_st, Word(word));
 
         m_pc += instructionSize(t_addressMode);
     }
 
     void CPU::instructionROR(AddressMode t_addressMode) {
         WordReference word = getWordArgument(t_addressMode);
-        const Word value = word;
-        const Word result = (value >> 1) | (getFlag(StatusFlag::CARRY) << 7);
-
-        word = result;
-
-        setFlag(StatusFlag::CARRY, value & 0x01U);
-        setFlag(StatusFlag::ZERO, result == 0);
-        setFlag(StatusFlag::NEGATIVE, result & 0x80U);
+        word = ALU::rotateRight(m_st, Word(word));
 
         m_pc += instructionSize(t_addressMode);
     }
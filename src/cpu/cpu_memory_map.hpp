@@ -2,6 +2,7 @@
 #define RNES_CPU_CONTROLLER_INCLUDED
 
 #include "defines.hpp"
+#include "save_state.hpp"
 
 namespace RNES::CPU {
 
@@ -24,6 +25,42 @@ namespace RNES::CPU {
                 this->readWord(t_address + 0) << 0 |
                 this->readWord(t_address + 1) << 8;
         }
+
+        // Whether a write to t_address reaches a register that can change banking, mirroring or the
+        // IRQ, so the PPU has to catch up first. Mappers keep theirs from $8000 up, and RAM below.
+        [[nodiscard]] virtual bool isRegister(Address t_address) const {
+            return t_address >= 0x8000;
+        }
+
+        // Level of the cartridge IRQ line, sampled by the CPU between instructions
+        [[nodiscard]] virtual bool isIRQAsserted() const {
+            return false;
+        }
+
+        // NMI is edge triggered, so taking a pending one also acknowledges it
+        [[nodiscard]] virtual bool takeNMI() {
+            return false;
+        }
+
+        // Cycles the CPU was halted for by DMA during the last instruction
+        [[nodiscard]] virtual uint64_t takeStallCycles() {
+            return 0;
+        }
+
+        // Maps with RAM or registers of their own have to override both of these
+        virtual void saveState(StateWriter& t_writer) const {
+            (void)t_writer;
+        }
+
+        virtual void loadState(StateReader& t_reader) {
+            (void)t_reader;
+        }
+
+        // Makes this map's RAM a copy-on-write view of t_source's, which has to be the same kind of
+        // map. Registers aren't copied, so this is followed by loading t_source's state.
+        virtual void shareMemoryWith(const CPUMemoryMap& t_source) {
+            (void)t_source;
+        }
     };
 
 }
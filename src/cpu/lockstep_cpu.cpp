@@ -0,0 +1,682 @@
+#include <algorithm>
+#include <cstring>
+
+#include "assert.hpp"
+#include "lockstep_cpu.hpp"
+#include "mapper/mapper.hpp"
+
+namespace RNES::CPU {
+
+    // One Word from each of LANES_PER_BLOCK lanes
+    using WordLanes = Word __attribute__((vector_size(LockstepCPU::LANES_PER_BLOCK)));
+
+    static inline WordLanes loadLanes(const Word* t_source) {
+        WordLanes result;
+        std::memcpy(&result, t_source, sizeof(result));
+        return result;
+    }
+
+    static inline void storeLanes(Word* t_destination, WordLanes t_value) {
+        std::memcpy(t_destination, &t_value, sizeof(t_value));
+    }
+
+    // Takes t_new in lanes where t_mask is set and keeps t_old elsewhere
+    static inline WordLanes blendLanes(WordLanes t_mask, WordLanes t_new, WordLanes t_old) {
+        return (t_new & t_mask) | (t_old & ~t_mask);
+    }
+
+    static inline bool anyLane(WordLanes t_mask) {
+        static_assert(sizeof(WordLanes) % sizeof(uint64_t) == 0);
+
+        std::array<uint64_t, sizeof(WordLanes) / sizeof(uint64_t)> parts{};
+        std::memcpy(parts.data(), &t_mask, sizeof(t_mask));
+
+        uint64_t combined = 0;
+        for (const uint64_t part : parts) {
+            combined |= part;
+        }
+        return combined != 0;
+    }
+
+    static Address signExtend(Word t_value) {
+        return (t_value & 0x80) ? (0xFF00U | t_value) : t_value;
+    }
+
+    static bool isRAM(Address t_address) {
+        return t_address < 0x2000;
+    }
+
+    static bool isReadable(Address t_address) {
+        return isRAM(t_address) || t_address >= 0x8000;
+    }
+
+    static const Word STACK_PUSHED_BITS = STATUS_B1 | STATUS_B2;
+    static const Word STACK_PULLED_MASK = 0b11001111;
+
+    ErrorOr<std::unique_ptr<LockstepCPU>> LockstepCPU::create(std::shared_ptr<const Mapper::ROMImage> t_rom, size_t t_laneCount) {
+        // Lanes share the whole of PRG ROM, so there can't be any bank switching
+        REQUIRE(t_rom->header.mapperNumber == 0, Mapper::ERROR_UNSUPPORTED_MAPPER);
+        REQUIRE(t_rom->prgRom.size() == 0x4000 || t_rom->prgRom.size() == 0x8000, Mapper::ERROR_INVALID_FILE);
+
+        return std::unique_ptr<LockstepCPU>(new LockstepCPU(std::move(t_rom), t_laneCount));
+    }
+
+    LockstepCPU::LockstepCPU(std::shared_ptr<const Mapper::ROMImage> t_rom, size_t t_laneCount)
+        : m_rom(std::move(t_rom))
+        , m_laneCount(t_laneCount)
+        , m_paddedLaneCount((t_laneCount + LANES_PER_BLOCK - 1) / LANES_PER_BLOCK * LANES_PER_BLOCK)
+        , m_pc(m_paddedLaneCount, 0)
+        , m_sp(m_paddedLaneCount, 0xFD)
+        , m_acc(m_paddedLaneCount, 0)
+        , m_x(m_paddedLaneCount, 0)
+        , m_y(m_paddedLaneCount, 0)
+        , m_st(m_paddedLaneCount, 0x24)
+        , m_cycles(m_paddedLaneCount, 0)
+        , m_exits(m_paddedLaneCount, LaneExit::NONE)
+        , m_ram(RAM_SIZE * m_paddedLaneCount, 0)
+        , m_active(m_paddedLaneCount, 0)
+        , m_addresses(m_paddedLaneCount, 0)
+        , m_operands(m_paddedLaneCount, 0)
+        , m_results(m_paddedLaneCount, 0)
+        , m_extraCycles(m_paddedLaneCount, 0)
+        , m_issuedSteps(0)
+        , m_laneInstructions(0)
+    {
+        // Lanes start at the reset vector, as a console would
+        const Address resetVector = readROM(0xFFFC) | (readROM(0xFFFD) << 8);
+        std::fill(m_pc.begin(), m_pc.end(), resetVector);
+    }
+
+    size_t LockstepCPU::getLaneCount() const {
+        return m_laneCount;
+    }
+
+    void LockstepCPU::setLane(size_t t_lane, const Registers& t_registers, std::span<const Word, RAM_SIZE> t_ram, uint64_t t_cycle) {
+        ASSERT(t_lane < m_laneCount, "Invalid lane");
+
+        m_pc[t_lane] = t_registers.pc;
+        m_sp[t_lane] = t_registers.sp;
+        m_acc[t_lane] = t_registers.acc;
+        m_x[t_lane] = t_registers.x;
+        m_y[t_lane] = t_registers.y;
+        m_st[t_lane] = t_registers.st;
+        m_cycles[t_lane] = t_cycle;
+        m_exits[t_lane] = LaneExit::NONE;
+
+        for (size_t i = 0; i < RAM_SIZE; i++) {
+            ramAt(t_lane, i) = t_ram[i];
+        }
+    }
+
+    LockstepCPU::Registers LockstepCPU::getRegisters(size_t t_lane) const {
+        ASSERT(t_lane < m_laneCount, "Invalid lane");
+        return { m_pc[t_lane], m_sp[t_lane], m_acc[t_lane], m_x[t_lane], m_y[t_lane], m_st[t_lane] };
+    }
+
+    void LockstepCPU::getRAM(size_t t_lane, std::span<Word, RAM_SIZE> t_ram) const {
+        ASSERT(t_lane < m_laneCount, "Invalid lane");
+
+        for (size_t i = 0; i < RAM_SIZE; i++) {
+            t_ram[i] = ramAt(t_lane, i);
+        }
+    }
+
+    uint64_t LockstepCPU::getCycleCount(size_t t_lane) const {
+        return m_cycles[t_lane];
+    }
+
+    LockstepCPU::LaneExit LockstepCPU::getExit(size_t t_lane) const {
+        return m_exits[t_lane];
+    }
+
+    uint64_t LockstepCPU::getIssuedSteps() const {
+        return m_issuedSteps;
+    }
+
+    uint64_t LockstepCPU::getLaneInstructions() const {
+        return m_laneInstructions;
+    }
+
+    void LockstepCPU::runUntil(uint64_t t_cycle) {
+        Address pc = 0;
+        while (selectGroup(t_cycle, pc)) {
+            step(pc);
+        }
+    }
+
+    bool LockstepCPU::selectGroup(uint64_t t_cycle, Address& t_pc) {
+        // Running the lowest program counter first lets lanes that fell behind in the code catch up
+        // with the rest, which is where divergent groups merge again
+        bool found = false;
+        Address lowest = 0xFFFF;
+        for (size_t lane = 0; lane < m_laneCount; lane++) {
+            if (m_exits[lane] == LaneExit::NONE && m_cycles[lane] < t_cycle) {
+                found = true;
+                lowest = std::min(lowest, m_pc[lane]);
+            }
+        }
+
+        if (!found) {
+            return false;
+        }
+
+        size_t groupSize = 0;
+        for (size_t lane = 0; lane < m_laneCount; lane++) {
+            const bool active = (m_pc[lane] == lowest) && (m_exits[lane] == LaneExit::NONE) && (m_cycles[lane] < t_cycle);
+            m_active[lane] = active ? 0xFF : 0x00;
+            groupSize += active;
+        }
+
+        m_issuedSteps++;
+        m_laneInstructions += groupSize;
+
+        t_pc = lowest;
+        return true;
+    }
+
+    void LockstepCPU::step(Address t_pc) {
+        if (t_pc < 0x8000) {
+            exitGroup(LaneExit::PC_OUTSIDE_ROM);
+            return;
+        }
+
+        const Word opcode = readROM(t_pc);
+        const InstructionInfo info = INSTRUCTION_TABLE[opcode];
+        const InstructionTiming timing = TIMING_TABLE[opcode];
+        const size_t size = instructionSize(info.addressMode);
+
+        if (info.id == InstructionId::NONE || info.id == InstructionId::BRK) {
+            exitGroup(LaneExit::UNSUPPORTED_INSTRUCTION);
+            return;
+        }
+
+        // The operand bytes have to be in ROM too
+        if (t_pc + size - 1 > 0xFFFF) {
+            exitGroup(LaneExit::PC_OUTSIDE_ROM);
+            return;
+        }
+
+        const Address nextPc = t_pc + size;
+        std::fill(m_extraCycles.begin(), m_extraCycles.end(), 0);
+
+        switch (info.id) {
+            case InstructionId::LDA:
+            case InstructionId::LDX:
+            case InstructionId::LDY: {
+                const auto shared = resolveAddresses(info.addressMode, t_pc, false);
+                const Word* operands = loadOperands(info.addressMode, t_pc, shared);
+
+                std::vector<Word>& reg = (info.id == InstructionId::LDA) ? m_acc : (info.id == InstructionId::LDX) ? m_x : m_y;
+                applyToRegister(reg, operands, [](WordLanes& t_st, WordLanes, WordLanes t_value) {
+                    ALU::setZN(t_st, t_value);
+                    return t_value;
+                });
+                break;
+            }
+
+            case InstructionId::STA:
+            case InstructionId::STX:
+            case InstructionId::STY: {
+                const auto shared = resolveAddresses(info.addressMode, t_pc, true);
+                const std::vector<Word>& reg = (info.id == InstructionId::STA) ? m_acc : (info.id == InstructionId::STX) ? m_x : m_y;
+                storeResults(shared, reg.data());
+                break;
+            }
+
+            case InstructionId::TAX:
+                applyToRegister(m_x, m_acc.data(), [](WordLanes& t_st, WordLanes, WordLanes t_value) { ALU::setZN(t_st, t_value); return t_value; });
+                break;
+            case InstructionId::TAY:
+                applyToRegister(m_y, m_acc.data(), [](WordLanes& t_st, WordLanes, WordLanes t_value) { ALU::setZN(t_st, t_value); return t_value; });
+                break;
+            case InstructionId::TXA:
+                applyToRegister(m_acc, m_x.data(), [](WordLanes& t_st, WordLanes, WordLanes t_value) { ALU::setZN(t_st, t_value); return t_value; });
+                break;
+            case InstructionId::TYA:
+                applyToRegister(m_acc, m_y.data(), [](WordLanes& t_st, WordLanes, WordLanes t_value) { ALU::setZN(t_st, t_value); return t_value; });
+                break;
+            case InstructionId::TSX:
+                applyToRegister(m_x, m_sp.data(), [](WordLanes& t_st, WordLanes, WordLanes t_value) { ALU::setZN(t_st, t_value); return t_value; });
+                break;
+            case InstructionId::TXS:
+                applyToRegister(m_sp, m_x.data(), [](WordLanes&, WordLanes, WordLanes t_value) { return t_value; });
+                break;
+
+            case InstructionId::AND:
+            case InstructionId::EOR:
+            case InstructionId::ORA:
+            case InstructionId::BIT:
+            case InstructionId::ADC:
+            case InstructionId::SBC:
+            case InstructionId::CMP:
+            case InstructionId::CPX:
+            case InstructionId::CPY: {
+                const auto shared = resolveAddresses(info.addressMode, t_pc, false);
+                const Word* operands = loadOperands(info.addressMode, t_pc, shared);
+
+                switch (info.id) {
+                    case InstructionId::AND:
+                        applyToRegister(m_acc, operands, [](WordLanes& t_st, WordLanes t_acc, WordLanes t_arg) {
+                            const WordLanes result = t_acc & t_arg;
+                            ALU::setZN(t_st, result);
+                            return result;
+                        });
+                        break;
+                    case InstructionId::EOR:
+                        applyToRegister(m_acc, operands, [](WordLanes& t_st, WordLanes t_acc, WordLanes t_arg) {
+                            const WordLanes result = t_acc ^ t_arg;
+                            ALU::setZN(t_st, result);
+                            return result;
+                        });
+                        break;
+                    case InstructionId::ORA:
+                        applyToRegister(m_acc, operands, [](WordLanes& t_st, WordLanes t_acc, WordLanes t_arg) {
+                            const WordLanes result = t_acc | t_arg;
+                            ALU::setZN(t_st, result);
+                            return result;
+                        });
+                        break;
+                    case InstructionId::BIT:
+                        applyToRegister(m_acc, operands, [](WordLanes& t_st, WordLanes t_acc, WordLanes t_arg) {
+                            ALU::bitTest(t_st, t_acc, t_arg);
+                            return t_acc;
+                        });
+                        break;
+                    case InstructionId::ADC:
+                    case InstructionId::SBC: {
+                        const bool isAdd = (info.id == InstructionId::ADC);
+                        applyToRegister(m_acc, operands, [isAdd](WordLanes& t_st, WordLanes t_acc, WordLanes t_arg) {
+                            const WordLanes st = t_st;
+                            WordLanes result = isAdd ? ALU::add(t_st, t_acc, t_arg) : ALU::subtract(t_st, t_acc, t_arg);
+
+                            // Lanes in decimal mode redo the instruction one at a time
+                            if (anyLane(st & STATUS_DECIMAL)) {
+                                for (size_t i = 0; i < LANES_PER_BLOCK; i++) {
+                                    if (st[i] & STATUS_DECIMAL) {
+                                        Word laneSt = st[i];
+                                        result[i] = isAdd ? ALU::addDecimal(laneSt, t_acc[i], t_arg[i]) : ALU::subtractDecimal(laneSt, t_acc[i], t_arg[i]);
+                                        t_st[i] = laneSt;
+                                    }
+                                }
+                            }
+
+                            return result;
+                        });
+                        break;
+                    }
+                    default: {
+                        std::vector<Word>& reg = (info.id == InstructionId::CMP) ? m_acc : (info.id == InstructionId::CPX) ? m_x : m_y;
+                        applyToRegister(reg, operands, [](WordLanes& t_st, WordLanes t_reg, WordLanes t_arg) {
+                            ALU::compare(t_st, t_reg, t_arg);
+                            return t_reg;
+                        });
+                        break;
+                    }
+                }
+                break;
+            }
+
+            case InstructionId::INX:
+                applyToRegister(m_x, m_x.data(), [](WordLanes& t_st, WordLanes, WordLanes t_value) { return ALU::increment(t_st, t_value); });
+                break;
+            case InstructionId::INY:
+                applyToRegister(m_y, m_y.data(), [](WordLanes& t_st, WordLanes, WordLanes t_value) { return ALU::increment(t_st, t_value); });
+                break;
+            case InstructionId::DEX:
+                applyToRegister(m_x, m_x.data(), [](WordLanes& t_st, WordLanes, WordLanes t_value) { return ALU::decrement(t_st, t_value); });
+                break;
+            case InstructionId::DEY:
+                applyToRegister(m_y, m_y.data(), [](WordLanes& t_st, WordLanes, WordLanes t_value) { return ALU::decrement(t_st, t_value); });
+                break;
+
+            case InstructionId::INC:
+            case InstructionId::DEC:
+            case InstructionId::ASL:
+            case InstructionId::LSR:
+            case InstructionId::ROL:
+            case InstructionId::ROR: {
+                const auto operation = [id = info.id](WordLanes& t_st, WordLanes t_value) {
+                    switch (id) {
+                        case InstructionId::INC: return ALU::increment(t_st, t_value);
+                        case InstructionId::DEC: return ALU::decrement(t_st, t_value);
+                        case InstructionId::ASL: return ALU::shiftLeft(t_st, t_value);
+                        case InstructionId::LSR: return ALU::shiftRight(t_st, t_value);
+                        case InstructionId::ROL: return ALU::rotateLeft(t_st, t_value);
+                        default:                 return ALU::rotateRight(t_st, t_value);
+                    }
+                };
+
+                if (info.addressMode == AddressMode::ACCUMULATOR) {
+                    applyToRegister(m_acc, m_acc.data(), [&operation](WordLanes& t_st, WordLanes, WordLanes t_value) { return operation(t_st, t_value); });
+                    break;
+                }
+
+                // Read-modify-write, so the address has to be both readable and writable
+                const auto shared = resolveAddresses(info.addressMode, t_pc, true);
+                const Word* operands = loadOperands(info.addressMode, t_pc, shared);
+                applyToMemory(operands, operation);
+                storeResults(shared, m_results.data());
+                break;
+            }
+
+            case InstructionId::CLC: setStatusBits(STATUS_CARRY, false); break;
+            case InstructionId::CLD: setStatusBits(STATUS_DECIMAL, false); break;
+            case InstructionId::CLI: setStatusBits(STATUS_INTERRUPT_DISABLE, false); break;
+            case InstructionId::CLV: setStatusBits(STATUS_OVERFLOW, false); break;
+            case InstructionId::SEC: setStatusBits(STATUS_CARRY, true); break;
+            case InstructionId::SED: setStatusBits(STATUS_DECIMAL, true); break;
+            case InstructionId::SEI: setStatusBits(STATUS_INTERRUPT_DISABLE, true); break;
+
+            case InstructionId::NOP:
+                break;
+
+            case InstructionId::BCC: branch(STATUS_CARRY, false, t_pc); return;
+            case InstructionId::BCS: branch(STATUS_CARRY, true, t_pc); return;
+            case InstructionId::BNE: branch(STATUS_ZERO, false, t_pc); return;
+            case InstructionId::BEQ: branch(STATUS_ZERO, true, t_pc); return;
+            case InstructionId::BPL: branch(STATUS_NEGATIVE, false, t_pc); return;
+            case InstructionId::BMI: branch(STATUS_NEGATIVE, true, t_pc); return;
+            case InstructionId::BVC: branch(STATUS_OVERFLOW, false, t_pc); return;
+            case InstructionId::BVS: branch(STATUS_OVERFLOW, true, t_pc); return;
+
+            case InstructionId::JMP: {
+                const Address target = readROM(t_pc + 1) | (readROM(t_pc + 2) << 8);
+                if (info.addressMode == AddressMode::ABSOLUTE) {
+                    finishInstruction(target, timing);
+                    return;
+                }
+
+                // Indirect, through a pointer that may differ between lanes if it is in RAM
+                if (!isReadable(target) || !isReadable(target + 1)) {
+                    exitGroup(LaneExit::IO_ACCESS);
+                    return;
+                }
+                for (size_t lane = 0; lane < m_laneCount; lane++) {
+                    if (m_active[lane]) {
+                        m_pc[lane] = read(lane, target) | (read(lane, target + 1) << 8);
+                        m_cycles[lane] += timing.cycles;
+                    }
+                }
+                return;
+            }
+
+            case InstructionId::JSR:
+            case InstructionId::RTS:
+            case InstructionId::RTI:
+            case InstructionId::PHA:
+            case InstructionId::PHP:
+            case InstructionId::PLA:
+            case InstructionId::PLP:
+                stackInstruction(info.id, t_pc);
+                if (info.id == InstructionId::JSR || info.id == InstructionId::RTS || info.id == InstructionId::RTI) {
+                    return;
+                }
+                break;
+
+            default:
+                ASSERT(false, "Unhandled instruction");
+        }
+
+        finishInstruction(nextPc, timing);
+    }
+
+    Word LockstepCPU::readROM(Address t_address) const {
+        const std::span<const uint8_t> prgRom = m_rom->prgRom;
+        return prgRom[(t_address - 0x8000) % prgRom.size()];
+    }
+
+    Word LockstepCPU::read(size_t t_lane, Address t_address) const {
+        return isRAM(t_address) ? ramAt(t_lane, t_address) : readROM(t_address);
+    }
+
+    Word& LockstepCPU::ramAt(size_t t_lane, Address t_address) {
+        return m_ram[(t_address % RAM_SIZE) * m_paddedLaneCount + t_lane];
+    }
+
+    const Word& LockstepCPU::ramAt(size_t t_lane, Address t_address) const {
+        return m_ram[(t_address % RAM_SIZE) * m_paddedLaneCount + t_lane];
+    }
+
+    void LockstepCPU::exitLane(size_t t_lane, LaneExit t_exit) {
+        m_exits[t_lane] = t_exit;
+        m_active[t_lane] = 0x00;
+    }
+
+    void LockstepCPU::exitGroup(LaneExit t_exit) {
+        for (size_t lane = 0; lane < m_laneCount; lane++) {
+            if (m_active[lane]) {
+                exitLane(lane, t_exit);
+            }
+        }
+    }
+
+    std::optional<Address> LockstepCPU::resolveAddresses(AddressMode t_mode, Address t_pc, bool t_write) {
+        const Word low = readROM(t_pc + 1);
+        const Address absolute = low | (readROM(t_pc + 2) << 8);
+        const auto accessible = [t_write](Address t_address) { return t_write ? isRAM(t_address) : isReadable(t_address); };
+
+        // Addresses that are the same for every lane
+        if (t_mode == AddressMode::IMMEDIATE || t_mode == AddressMode::ZERO_PAGE || t_mode == AddressMode::ABSOLUTE) {
+            const Address address = (t_mode == AddressMode::IMMEDIATE) ? (t_pc + 1) : (t_mode == AddressMode::ZERO_PAGE) ? low : absolute;
+            if (t_mode != AddressMode::IMMEDIATE && !accessible(address)) {
+                exitGroup(LaneExit::IO_ACCESS);
+            }
+            return address;
+        }
+
+        for (size_t lane = 0; lane < m_laneCount; lane++) {
+            if (!m_active[lane]) {
+                continue;
+            }
+
+            Address address = 0;
+            switch (t_mode) {
+                case AddressMode::ZERO_PAGE_X:
+                    address = (low + m_x[lane]) % 0x0100U;
+                    break;
+                case AddressMode::ZERO_PAGE_Y:
+                    address = (low + m_y[lane]) % 0x0100U;
+                    break;
+                case AddressMode::ABSOLUTE_X:
+                    address = absolute + m_x[lane];
+                    m_extraCycles[lane] = (low + m_x[lane]) > 0xFFU;
+                    break;
+                case AddressMode::ABSOLUTE_Y:
+                    address = absolute + m_y[lane];
+                    m_extraCycles[lane] = (low + m_y[lane]) > 0xFFU;
+                    break;
+                case AddressMode::INDEXED_INDIRECT: {
+                    const Address pointer = (low + m_x[lane]) % 0x0100U;
+                    address = ramAt(lane, pointer) | (ramAt(lane, pointer + 1) << 8);
+                    break;
+                }
+                case AddressMode::INDIRECT_INDEXED: {
+                    const Word pointerLow = ramAt(lane, low);
+                    address = (pointerLow | (ramAt(lane, low + 1) << 8)) + m_y[lane];
+                    m_extraCycles[lane] = (pointerLow + m_y[lane]) > 0xFFU;
+                    break;
+                }
+                default:
+                    ASSERT(false, "Invalid address mode");
+            }
+
+            if (accessible(address)) {
+                m_addresses[lane] = address;
+            }
+            else {
+                exitLane(lane, LaneExit::IO_ACCESS);
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    const Word* LockstepCPU::loadOperands(AddressMode t_mode, Address t_pc, std::optional<Address> t_shared) {
+        if (t_mode == AddressMode::IMMEDIATE) {
+            std::fill(m_operands.begin(), m_operands.end(), readROM(t_pc + 1));
+            return m_operands.data();
+        }
+
+        if (t_shared.has_value()) {
+            // Every lane's copy of a RAM byte is already contiguous
+            if (isRAM(*t_shared)) {
+                return &ramAt(0, *t_shared);
+            }
+
+            std::fill(m_operands.begin(), m_operands.end(), readROM(*t_shared));
+            return m_operands.data();
+        }
+
+        for (size_t lane = 0; lane < m_laneCount; lane++) {
+            if (m_active[lane]) {
+                m_operands[lane] = read(lane, m_addresses[lane]);
+            }
+        }
+        return m_operands.data();
+    }
+
+    void LockstepCPU::storeResults(std::optional<Address> t_shared, const Word* t_values) {
+        if (t_shared.has_value()) {
+            Word* row = &ramAt(0, *t_shared);
+            for (size_t base = 0; base < m_paddedLaneCount; base += LANES_PER_BLOCK) {
+                const WordLanes mask = loadLanes(m_active.data() + base);
+                if (anyLane(mask)) {
+                    storeLanes(row + base, blendLanes(mask, loadLanes(t_values + base), loadLanes(row + base)));
+                }
+            }
+            return;
+        }
+
+        for (size_t lane = 0; lane < m_laneCount; lane++) {
+            if (m_active[lane]) {
+                ramAt(lane, m_addresses[lane]) = t_values[lane];
+            }
+        }
+    }
+
+    template<typename Operation>
+    void LockstepCPU::applyToRegister(std::vector<Word>& t_register, const Word* t_operands, Operation t_operation) {
+        for (size_t base = 0; base < m_paddedLaneCount; base += LANES_PER_BLOCK) {
+            const WordLanes mask = loadLanes(m_active.data() + base);
+            if (!anyLane(mask)) {
+                continue;
+            }
+
+            const WordLanes st = loadLanes(m_st.data() + base);
+            const WordLanes value = loadLanes(t_register.data() + base);
+
+            WordLanes newSt = st;
+            const WordLanes newValue = t_operation(newSt, value, loadLanes(t_operands + base));
+
+            storeLanes(t_register.data() + base, blendLanes(mask, newValue, value));
+            storeLanes(m_st.data() + base, blendLanes(mask, newSt, st));
+        }
+    }
+
+    template<typename Operation>
+    void LockstepCPU::applyToMemory(const Word* t_operands, Operation t_operation) {
+        for (size_t base = 0; base < m_paddedLaneCount; base += LANES_PER_BLOCK) {
+            const WordLanes mask = loadLanes(m_active.data() + base);
+            if (!anyLane(mask)) {
+                continue;
+            }
+
+            const WordLanes st = loadLanes(m_st.data() + base);
+
+            WordLanes newSt = st;
+            storeLanes(m_results.data() + base, t_operation(newSt, loadLanes(t_operands + base)));
+            storeLanes(m_st.data() + base, blendLanes(mask, newSt, st));
+        }
+    }
+
+    void LockstepCPU::setStatusBits(Word t_bits, bool t_value) {
+        for (size_t base = 0; base < m_paddedLaneCount; base += LANES_PER_BLOCK) {
+            const WordLanes mask = loadLanes(m_active.data() + base) & t_bits;
+            const WordLanes st = loadLanes(m_st.data() + base);
+
+            storeLanes(m_st.data() + base, t_value ? (st | mask) : (st & ~mask));
+        }
+    }
+
+    void LockstepCPU::branch(Word t_flag, bool t_set, Address t_pc) {
+        const Address nextPc = t_pc + 2;
+        const Address target = nextPc + signExtend(readROM(t_pc + 1));
+        const bool crossesPage = (target & 0xFF00U) != (nextPc & 0xFF00U);
+
+        for (size_t lane = 0; lane < m_laneCount; lane++) {
+            if (!m_active[lane]) {
+                continue;
+            }
+
+            const bool taken = ((m_st[lane] & t_flag) != 0) == t_set;
+            m_pc[lane] = taken ? target : nextPc;
+            m_cycles[lane] += 2 + (taken ? (crossesPage ? 2 : 1) : 0);
+        }
+    }
+
+    void LockstepCPU::stackInstruction(InstructionId t_id, Address t_pc) {
+        const InstructionTiming timing = TIMING_TABLE[readROM(t_pc)];
+
+        // The stack pointer isn't necessarily the same in every lane, so these go one lane at a time
+        for (size_t lane = 0; lane < m_laneCount; lane++) {
+            if (!m_active[lane]) {
+                continue;
+            }
+
+            Word& sp = m_sp[lane];
+            const auto push = [&](Word t_value) { ramAt(lane, 0x0100U + sp--) = t_value; };
+            const auto pop = [&]() { return ramAt(lane, 0x0100U + ++sp); };
+
+            switch (t_id) {
+                case InstructionId::JSR: {
+                    const Address returnAddress = t_pc + 2;
+                    push(returnAddress >> 8);
+                    push(returnAddress & 0x00FFU);
+                    m_pc[lane] = readROM(t_pc + 1) | (readROM(t_pc + 2) << 8);
+                    m_cycles[lane] += timing.cycles;
+                    break;
+                }
+                case InstructionId::RTS: {
+                    const Word low = pop();
+                    const Word high = pop();
+                    m_pc[lane] = ((high << 8) | low) + 1;
+                    m_cycles[lane] += timing.cycles;
+                    break;
+                }
+                case InstructionId::RTI: {
+                    m_st[lane] = pop() & STACK_PULLED_MASK;
+                    const Word low = pop();
+                    const Word high = pop();
+                    m_pc[lane] = (high << 8) | low;
+                    m_cycles[lane] += timing.cycles;
+                    break;
+                }
+                case InstructionId::PHA:
+                    push(m_acc[lane]);
+                    break;
+                case InstructionId::PHP:
+                    push(m_st[lane] | STACK_PUSHED_BITS);
+                    break;
+                case InstructionId::PLA:
+                    m_acc[lane] = pop();
+                    ALU::setZN(m_st[lane], m_acc[lane]);
+                    break;
+                case InstructionId::PLP:
+                    m_st[lane] = pop() & STACK_PULLED_MASK;
+                    break;
+                default:
+                    ASSERT(false, "Not a stack instruction");
+            }
+        }
+    }
+
+    void LockstepCPU::finishInstruction(Address t_nextPc, InstructionTiming t_timing) {
+        for (size_t lane = 0; lane < m_laneCount; lane++) {
+            if (m_active[lane]) {
+                m_pc[lane] = t_nextPc;
+                m_cycles[lane] += t_timing.cycles + (t_timing.pageCrossPenalty ? m_extraCycles[lane] : 0);
+            }
+        }
+    }
+
+}
@@ -0,0 +1,128 @@
+#ifndef RNES_LOCKSTEP_CPU_INCLUDED
+#define RNES_LOCKSTEP_CPU_INCLUDED
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "cpu.hpp"
+#include "defines.hpp"
+#include "error_or.hpp"
+#include "mapper/rom_image.hpp"
+
+namespace RNES::CPU {
+
+    /* EXPERIMENTAL: many CPUs running the same NROM program, with their registers and RAM stored as
+     * structure of arrays so one instruction can be executed for a whole group of lanes with vector
+     * operations. Each step picks the lowest program counter among the running lanes and executes the
+     * instruction there for every lane that shares it. Lanes that branched apart keep running in
+     * separate groups, and merge back into one as soon as their program counters meet again.
+     *
+     * Only the CPU, its RAM and PRG ROM are modelled. A lane stops before any instruction that would
+     * need the rest of the console (a PPU, APU or mapper register, BRK, or code outside ROM) and
+     * reports why, so the caller can finish that stretch on a full Console.
+     *
+     * The instructions' data path is the same code the scalar CPU uses (cpu_alu.hpp), instantiated for
+     * vectors of LANES_PER_BLOCK Words, which the compiler maps to SSE on x86 and NEON on ARM.
+     */
+    class LockstepCPU {
+    public:
+        static const size_t RAM_SIZE = 0x0800;
+        static const size_t LANES_PER_BLOCK = 16;
+
+        enum class LaneExit : uint8_t {
+            NONE,
+            IO_ACCESS,               // needs memory other than RAM and PRG ROM
+            UNSUPPORTED_INSTRUCTION, // BRK or an invalid opcode
+            PC_OUTSIDE_ROM,          // lanes only share code that is in ROM
+        };
+
+        struct Registers {
+            Address pc;
+            Word sp;
+            Word acc;
+            Word x;
+            Word y;
+            Word st;
+        };
+
+        static ErrorOr<std::unique_ptr<LockstepCPU>> create(std::shared_ptr<const Mapper::ROMImage> t_rom, size_t t_laneCount);
+
+        [[nodiscard]] size_t getLaneCount() const;
+
+        // Replaces a lane's whole state, which also clears its exit
+        void setLane(size_t t_lane, const Registers& t_registers, std::span<const Word, RAM_SIZE> t_ram, uint64_t t_cycle);
+
+        [[nodiscard]] Registers getRegisters(size_t t_lane) const;
+        void getRAM(size_t t_lane, std::span<Word, RAM_SIZE> t_ram) const;
+        [[nodiscard]] uint64_t getCycleCount(size_t t_lane) const;
+        [[nodiscard]] LaneExit getExit(size_t t_lane) const;
+
+        // Runs every lane until its cycle count reaches t_cycle or it exits
+        void runUntil(uint64_t t_cycle);
+
+        // Steps issued, and the lane instructions they executed. The ratio is the average group size.
+        [[nodiscard]] uint64_t getIssuedSteps() const;
+        [[nodiscard]] uint64_t getLaneInstructions() const;
+
+    private:
+        LockstepCPU(std::shared_ptr<const Mapper::ROMImage> t_rom, size_t t_laneCount);
+
+        [[nodiscard]] bool selectGroup(uint64_t t_cycle, Address& t_pc);
+        void step(Address t_pc);
+
+        [[nodiscard]] Word readROM(Address t_address) const;
+        [[nodiscard]] Word read(size_t t_lane, Address t_address) const;
+        [[nodiscard]] Word& ramAt(size_t t_lane, Address t_address);
+        [[nodiscard]] const Word& ramAt(size_t t_lane, Address t_address) const;
+
+        void exitLane(size_t t_lane, LaneExit t_exit);
+        void exitGroup(LaneExit t_exit);
+
+        // Effective addresses of every active lane go in m_addresses, or the single shared one is
+        // returned. Lanes that can't make the access exit, and extra cycles for crossing pages are
+        // counted in m_extraCycles.
+        std::optional<Address> resolveAddresses(AddressMode t_mode, Address t_pc, bool t_write);
+        [[nodiscard]] const Word* loadOperands(AddressMode t_mode, Address t_pc, std::optional<Address> t_shared);
+        void storeResults(std::optional<Address> t_shared, const Word* t_values);
+
+        template<typename Operation>
+        void applyToRegister(std::vector<Word>& t_register, const Word* t_operands, Operation t_operation);
+        template<typename Operation>
+        void applyToMemory(const Word* t_operands, Operation t_operation);
+        void setStatusBits(Word t_bits, bool t_value);
+
+        void branch(Word t_flag, bool t_set, Address t_pc);
+        void stackInstruction(InstructionId t_id, Address t_pc);
+        void finishInstruction(Address t_nextPc, InstructionTiming t_timing);
+
+        std::shared_ptr<const Mapper::ROMImage> m_rom;
+        size_t m_laneCount;
+        size_t m_paddedLaneCount; // a whole number of blocks
+
+        std::vector<Address> m_pc;
+        std::vector<Word> m_sp;
+        std::vector<Word> m_acc;
+        std::vector<Word> m_x;
+        std::vector<Word> m_y;
+        std::vector<Word> m_st;
+        std::vector<uint64_t> m_cycles;
+        std::vector<LaneExit> m_exits;
+
+        std::vector<Word> m_ram; // byte n of every lane is stored together, at [n * m_paddedLaneCount]
+
+        // Scratch for the step being executed
+        std::vector<Word> m_active; // ~0 for lanes in the group
+        std::vector<Address> m_addresses;
+        std::vector<Word> m_operands;
+        std::vector<Word> m_results;
+        std::vector<Word> m_extraCycles;
+
+        uint64_t m_issuedSteps;
+        uint64_t m_laneInstructions;
+    };
+
+}
+
+#endif
@@ -1,24 +1,62 @@
+#include "assert.hpp"
 #include "nes_controller.hpp"
 
 namespace RNES {
 
-    NESController::NESController(std::unique_ptr<CPU::CPUMemoryMap> t_cpuMapper)
-            : m_internalRAM({0}), m_cpuMapper(std::move(t_cpuMapper)) {
-        ;
+    using PPURegisterRead = uint8_t (PPU::PPU::*)();
+    using PPURegisterWrite = void (PPU::PPU::*)(uint8_t);
+
+    // Indexed by the low three bits of the address, as $2008-$3FFF mirror $2000-$2007
+    static const std::array<PPURegisterRead, 8> PPU_REGISTER_READS = {
+        &PPU::PPU::readIOLatch,     // $2000 PPUCTRL
+        &PPU::PPU::readIOLatch,     // $2001 PPUMASK
+        &PPU::PPU::readPPUStatus,   // $2002 PPUSTATUS
+        &PPU::PPU::readIOLatch,     // $2003 OAMADDR
+        &PPU::PPU::readOAMData,     // $2004 OAMDATA
+        &PPU::PPU::readIOLatch,     // $2005 PPUSCROLL
+        &PPU::PPU::readIOLatch,     // $2006 PPUADDR
+        &PPU::PPU::readPPUData,     // $2007 PPUDATA
+    };
+
+    static const std::array<PPURegisterWrite, 8> PPU_REGISTER_WRITES = {
+        &PPU::PPU::writePPUCTRL,    // $2000 PPUCTRL
+        &PPU::PPU::writePPUMask,    // $2001 PPUMASK
+        &PPU::PPU::writeIOLatch,    // $2002 PPUSTATUS
+        &PPU::PPU::writeOAMAddress, // $2003 OAMADDR
+        &PPU::PPU::writeOAMData,    // $2004 OAMDATA
+        &PPU::PPU::writePPUScroll,  // $2005 PPUSCROLL
+        &PPU::PPU::writePPUAddress, // $2006 PPUADDR
+        &PPU::PPU::writePPUData,    // $2007 PPUDATA
+    };
+
+    NESController::NESController(std::unique_ptr<CPU::CPUMemoryMap> t_cpuMapper, Scheduler& t_scheduler, PPU::PPU& t_ppu, APU::APU& t_apu)
+            : m_internalRAM({0}), m_cpuMapper(std::move(t_cpuMapper)), m_scheduler(t_scheduler), m_ppu(t_ppu), m_apu(t_apu)
+            , m_controllerStates({0}), m_controllerStrobe(false), m_controllerShifts({0}) {
+        m_apu.setMemory(this);
     }
 
     Word NESController::readWord(RNES::Address t_address) const {
         if (t_address < 0x2000) {
             return m_internalRAM[t_address % 0x0800]; // first 0x0800 bytes are mirrored
         } else if (t_address < 0x4000) {
-            // TODO: PPU registers
-            return -1;
-        } else if (t_address < 0x4018) {
-            // TODO: APU and IO registers
-            return -1;
+            syncPPU();
+            return (m_ppu.*PPU_REGISTER_READS[t_address & 0x07])();
+        } else if (t_address == 0x4015) {
+            return m_apu.readStatus(m_scheduler.now());
+        } else if (t_address == 0x4016 || t_address == 0x4017) {
+            uint8_t& shift = m_controllerShifts[t_address - 0x4016];
+            if (m_controllerStrobe) {
+                return 0x40 | (m_controllerStates[t_address - 0x4016] & 0x01);
+            }
+
+            // Serial out, one button per read. Once all eight are read the register returns 1s.
+            const uint8_t result = 0x40 | (shift & 0x01); // the upper bits are open bus, usually $40
+            shift = (shift >> 1) | 0x80;
+            return result;
         } else if (t_address < 0x4020) {
-            // TODO: other APU and IO stuff
-            return -1;
+            // Write-only APU registers and the disabled test registers don't drive the bus. What's
+            // left on it is usually the high byte of the address, the last operand byte fetched.
+            return static_cast<Word>(t_address >> 8);
         } else {
             return m_cpuMapper->readWord(t_address);
         }
@@ -28,14 +66,114 @@ namespace RNES {
         if (t_address < 0x2000) {
             m_internalRAM[(t_address % 0x0800)] = t_value;
         } else if (t_address < 0x4000) {
-            // TODO: PPU registers
+            syncPPU();
+            m_ppu.writeIOLatch(t_value);
+            (m_ppu.*PPU_REGISTER_WRITES[t_address & 0x07])(t_value);
+
+            // PPUCTRL may have turned NMIs on or off, and it and PPUMASK decide when A12 rises
+            schedulePPUEvents();
+        } else if (t_address == 0x4014) {
+            // Sprites already drawn this frame have to come from the old OAM
+            syncPPU();
+            runOAMDMA(t_value);
+        } else if (t_address == 0x4016) {
+            m_controllerStrobe = t_value & 0x01;
+            if (m_controllerStrobe) {
+                m_controllerShifts = m_controllerStates;
+            }
         } else if (t_address < 0x4018) {
-            // TODO: APU and IO registers
+            m_apu.writeRegister(t_address, t_value, m_scheduler.now());
         } else if (t_address < 0x4020) {
             // TODO: other APU and IO stuff
+        } else if (m_cpuMapper->isRegister(t_address)) {
+            // Bank switches and mirroring changes only apply to what the PPU draws from now on
+            syncPPU();
+            m_cpuMapper->writeWord(t_address, t_value);
+
+            // The write may have changed the scanline counter or its IRQ settings
+            m_scheduler.schedule(Event::MAPPER_IRQ, m_ppu.nextMapperIRQCycle());
         } else {
+            // PRG-RAM, which nothing else can see
             m_cpuMapper->writeWord(t_address, t_value);
         }
     }
 
+    bool NESController::isIRQAsserted() const {
+        return m_cpuMapper->isIRQAsserted() || m_apu.isIRQAsserted();
+    }
+
+    bool NESController::takeNMI() {
+        return m_ppu.takeNMI();
+    }
+
+    uint64_t NESController::takeStallCycles() {
+        return m_scheduler.takeStallCycles();
+    }
+
+    void NESController::syncPPU() const {
+        m_ppu.catchUp(m_scheduler.now());
+        schedulePPUEvents();
+    }
+
+    void NESController::schedulePPUEvents() const {
+        m_scheduler.schedule(Event::PPU_NMI, m_ppu.nextNMICycle());
+        m_scheduler.schedule(Event::MAPPER_IRQ, m_ppu.nextMapperIRQCycle());
+    }
+
+    void NESController::setControllerState(size_t t_port, uint8_t t_buttons) {
+        ASSERT(t_port < m_controllerStates.size(), "Invalid controller port");
+        m_controllerStates[t_port] = t_buttons;
+
+        if (m_controllerStrobe) {
+            m_controllerShifts[t_port] = t_buttons;
+        }
+    }
+
+    std::span<const Word, 0x0800> NESController::getRAM() const {
+        return m_internalRAM;
+    }
+
+    void NESController::saveState(StateWriter& t_writer) const {
+        t_writer.bytes(m_internalRAM);
+        t_writer.bytes(m_controllerStates);
+        t_writer.value(m_controllerStrobe);
+        t_writer.bytes(m_controllerShifts);
+
+        m_cpuMapper->saveState(t_writer);
+    }
+
+    void NESController::loadState(StateReader& t_reader) {
+        t_reader.bytes(m_internalRAM);
+        t_reader.bytes(m_controllerStates);
+        t_reader.value(m_controllerStrobe);
+        t_reader.bytes(m_controllerShifts);
+
+        m_cpuMapper->loadState(t_reader);
+    }
+
+    void NESController::shareMemoryWith(const CPU::CPUMemoryMap& t_source) {
+        m_cpuMapper->shareMemoryWith(*static_cast<const NESController&>(t_source).m_cpuMapper);
+    }
+
+    void NESController::runOAMDMA(Word t_page) {
+        const Address source = t_page << 8;
+
+        // Pages in internal RAM are copied straight out of it. Anything else has to go through
+        // readWord, as the page may be mapped to registers or bank-switched ROM.
+        if (source < 0x2000) {
+            m_ppu.writeOAMDMA(std::span<const Word, PPU::OAM_SIZE>(m_internalRAM.data() + (source % 0x0800), PPU::OAM_SIZE));
+        } else {
+            std::array<Word, PPU::OAM_SIZE> page{};
+            for (size_t i = 0; i < page.size(); i++) {
+                page[i] = readWord(source + i);
+            }
+            m_ppu.writeOAMDMA(page);
+        }
+
+        // 256 read/write pairs plus a halt cycle, and one more to align if the write lands on an odd
+        // cycle. The write is assumed to be the last cycle of a 4 cycle absolute store.
+        const uint64_t writeCycle = m_scheduler.now() + 3;
+        m_scheduler.stall((writeCycle % 2 == 0) ? 513 : 514);
+    }
+
 }
@@ -3,23 +3,56 @@
 
 #include <array>
 #include <memory>
+#include <span>
 
 #include "defines.hpp"
+#include "scheduler.hpp"
+#include "apu/apu.hpp"
 #include "cpu/cpu_memory_map.hpp"
+#include "ppu/ppu.hpp"
 
 namespace RNES {
 
     class NESController : public CPU::CPUMemoryMap {
     public:
-        explicit NESController(std::unique_ptr<CPU::CPUMemoryMap> t_cpuMapper);
+        NESController(std::unique_ptr<CPU::CPUMemoryMap> t_cpuMapper, Scheduler& t_scheduler, PPU::PPU& t_ppu, APU::APU& t_apu);
         ~NESController() override = default;
 
         [[nodiscard]] Word readWord(Address t_address) const override;
         void writeWord(Address t_address, Word t_value) override;
 
+        [[nodiscard]] bool isIRQAsserted() const override;
+        [[nodiscard]] bool takeNMI() override;
+        [[nodiscard]] uint64_t takeStallCycles() override;
+
+        // Internal RAM, the controller ports and the cartridge's CPU side
+        void saveState(StateWriter& t_writer) const override;
+        void loadState(StateReader& t_reader) override;
+        // Shares the cartridge's PRG-RAM. Internal RAM is small and written every frame, so it's
+        // simply copied along with the rest of the state.
+        void shareMemoryWith(const CPU::CPUMemoryMap& t_source) override;
+
+        // Brings the PPU up to the current cycle and reschedules its next NMI and mapper IRQ
+        void syncPPU() const;
+
+        // Buttons held on a standard controller, bit 0 = A, then B, Select, Start, Up, Down, Left, Right
+        void setControllerState(size_t t_port, uint8_t t_buttons);
+
+        [[nodiscard]] std::span<const Word, 0x0800> getRAM() const;
+
     private:
+        void schedulePPUEvents() const;
+        void runOAMDMA(Word t_page);
+
         std::array<Word, 0x0800> m_internalRAM;
         std::unique_ptr<CPU::CPUMemoryMap> m_cpuMapper;
+        Scheduler& m_scheduler;
+        PPU::PPU& m_ppu;
+        APU::APU& m_apu;
+
+        std::array<uint8_t, 2> m_controllerStates;
+        bool m_controllerStrobe;
+        mutable std::array<uint8_t, 2> m_controllerShifts; // reading shifts them, and reads are const
     };
 
 }
@@ -3,6 +3,7 @@
 
 // Thanks SerenityOS for the idea!
 #include <optional>
+#include <utility>
 #include <variant>
 
 class ErrorCode {
@@ -26,7 +27,7 @@ private:
 template<typename Ty>
 class ErrorOr {
 public:
-    ErrorOr(Ty t_value) : m_value(t_value) {
+    ErrorOr(Ty t_value) : m_value(std::move(t_value)) {
         ;
     }
 
@@ -38,14 +39,19 @@ public:
         return std::holds_alternative<ErrorCode>(m_value);
     }
 
-    [[nodiscard]] Ty& get_value() {
+    [[nodiscard]] Ty& get_value() & {
         return std::get<Ty>(m_value);
     }
 
-    [[nodiscard]] Ty get_value() const {
+    [[nodiscard]] const Ty& get_value() const & {
         return std::get<Ty>(m_value);
     }
 
+    // Lets the value be moved out of a temporary, which also makes move-only types usable
+    [[nodiscard]] Ty&& get_value() && {
+        return std::get<Ty>(std::move(m_value));
+    }
+
     [[nodiscard]] ErrorCode get_error() const {
         return std::get<ErrorCode>(m_value);
     }
@@ -83,11 +89,11 @@ private:
 
 // This uses a GCC extension!
 #define TRY(x) ({\
-    const auto _errorOrX = (x);\
+    auto _errorOrX = (x);\
     if (_errorOrX.is_error()) {\
         return _errorOrX.get_error();\
     }\
-    _errorOrX.get_value();\
+    std::move(_errorOrX).get_value();\
 })
 
 #define REQUIRE(x, e) do {\
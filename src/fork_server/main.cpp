@@ -0,0 +1,149 @@
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "console.hpp"
+#include "hash.hpp"
+#include "output/video_sink.hpp"
+
+/* Boots a ROM once, then serves jobs on a UNIX socket, each in a forked process that starts from
+ * the booted console in the pages it inherits. Jobs are isolated from each other and from the
+ * server, and none of them pays for loading or booting the game.
+ *
+ * A job is one line: the number of frames to run, then the buttons held on the first controller
+ * for each frame, as decimal numbers. Frames past the end of the list run with nothing held. The
+ * reply is one line with the frame count, the cycle count and the hash64 of internal RAM in hex,
+ * or "error" followed by a reason, and then the connection is closed.
+ */
+
+// Reads up to the first newline, or until the client stops sending
+static std::string readLine(int t_socket) {
+    std::string line;
+    char buffer[4096];
+    while (line.find('\n') == std::string::npos) {
+        const ssize_t count = read(t_socket, buffer, sizeof(buffer));
+        if (count <= 0) {
+            break;
+        }
+        line.append(buffer, static_cast<size_t>(count));
+    }
+    return line.substr(0, line.find('\n'));
+}
+
+static void writeAll(int t_socket, const std::string& t_data) {
+    size_t written = 0;
+    while (written < t_data.size()) {
+        const ssize_t count = write(t_socket, t_data.data() + written, t_data.size() - written);
+        if (count <= 0) {
+            return;
+        }
+        written += static_cast<size_t>(count);
+    }
+}
+
+static std::string runJob(RNES::Console& t_console, const std::string& t_request) {
+    std::istringstream request(t_request);
+    uint64_t frameCount = 0;
+    if (!(request >> frameCount)) {
+        return "error expected a frame count\n";
+    }
+
+    for (uint64_t frame = 0; frame < frameCount; frame++) {
+        unsigned buttons = 0;
+        if (!(request >> buttons)) {
+            buttons = 0;
+        }
+        t_console.setInput(0, static_cast<uint8_t>(buttons));
+        t_console.runFrame();
+    }
+
+    char reply[128];
+    std::snprintf(reply, sizeof(reply), "%llu %llu %016llx\n",
+            static_cast<unsigned long long>(t_console.getFrameCount()),
+            static_cast<unsigned long long>(t_console.getCycleCount()),
+            static_cast<unsigned long long>(RNES::hash64(t_console.getRAM())));
+    return reply;
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t bootFrames = 0;
+    bool validArguments = (argc == 3 || argc == 4);
+    if (argc == 4) {
+        const char* end = argv[3] + std::strlen(argv[3]);
+        const auto [parsedEnd, error] = std::from_chars(argv[3], end, bootFrames);
+        validArguments = (error == std::errc() && parsedEnd == end);
+    }
+    if (!validArguments) {
+        std::cerr << "Usage: <rom_path> <socket_path> [boot_frames]" << std::endl;
+        return 1;
+    }
+
+    // Loaded from the image so no battery file, and with it no flush thread, survives into the children
+    auto romOrError = RNES::Mapper::loadROMImage(argv[1]);
+    if (romOrError.is_error()) {
+        std::cerr << "Failed to load ROM (error " << romOrError.get_error().getErrorCode() << ")\n";
+        return EXIT_FAILURE;
+    }
+
+    auto consoleOrError = RNES::Console::fromImage(romOrError.get_value());
+    if (consoleOrError.is_error()) {
+        std::cerr << "Failed to create console (error " << consoleOrError.get_error().getErrorCode() << ")\n";
+        return EXIT_FAILURE;
+    }
+    std::unique_ptr<RNES::Console> console = std::move(consoleOrError).get_value();
+    console->setVideoSink(std::make_unique<RNES::Output::NullVideoSink>());
+
+    for (uint64_t i = 0; i < bootFrames; i++) {
+        console->runFrame();
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (std::strlen(argv[2]) >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path is too long\n";
+        return EXIT_FAILURE;
+    }
+    std::strcpy(address.sun_path, argv[2]);
+
+    const int server = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    unlink(argv[2]);
+    if (server < 0 || bind(server, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(server, SOMAXCONN) != 0) {
+        std::cerr << "Failed to listen on " << argv[2] << "\n";
+        return EXIT_FAILURE;
+    }
+
+    // Children are never waited for, so let the kernel reap them
+    signal(SIGCHLD, SIG_IGN);
+    // A client that hangs up before its reply only fails that write, instead of killing the server
+    signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "Booted " << bootFrames << " frames, listening on " << argv[2] << std::endl;
+    while (true) {
+        const int client = accept4(server, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            continue;
+        }
+
+        const pid_t child = fork();
+        if (child == 0) {
+            close(server);
+            writeAll(client, runJob(*console, readLine(client)));
+            close(client);
+            _exit(0);
+        }
+
+        if (child < 0) {
+            writeAll(client, "error fork failed\n");
+        }
+        close(client);
+    }
+}
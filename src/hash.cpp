@@ -0,0 +1,94 @@
+#include <bit>
+#include <cstring>
+
+#include "hash.hpp"
+
+namespace RNES {
+
+    static const uint64_t PRIME_1 = 0x9E3779B185EBCA87ULL;
+    static const uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+    static const uint64_t PRIME_3 = 0x165667B19E3779F9ULL;
+    static const uint64_t PRIME_4 = 0x85EBCA77C2B2AE63ULL;
+    static const uint64_t PRIME_5 = 0x27D4EB2F165667C5ULL;
+
+    static uint64_t read64(const uint8_t* t_data) {
+        uint64_t result = 0;
+        std::memcpy(&result, t_data, sizeof(result)); // assumes a little endian host
+        return result;
+    }
+
+    static uint32_t read32(const uint8_t* t_data) {
+        uint32_t result = 0;
+        std::memcpy(&result, t_data, sizeof(result));
+        return result;
+    }
+
+    static uint64_t round(uint64_t t_accumulator, uint64_t t_input) {
+        t_accumulator += t_input * PRIME_2;
+        t_accumulator = std::rotl(t_accumulator, 31);
+        return t_accumulator * PRIME_1;
+    }
+
+    static uint64_t mergeRound(uint64_t t_accumulator, uint64_t t_value) {
+        t_accumulator ^= round(0, t_value);
+        return t_accumulator * PRIME_1 + PRIME_4;
+    }
+
+    uint64_t hash64(std::span<const uint8_t> t_data, uint64_t t_seed) {
+        const uint8_t* data = t_data.data();
+        const uint8_t* const end = data + t_data.size();
+
+        uint64_t result = 0;
+
+        if (t_data.size() >= 32) {
+            uint64_t v1 = t_seed + PRIME_1 + PRIME_2;
+            uint64_t v2 = t_seed + PRIME_2;
+            uint64_t v3 = t_seed;
+            uint64_t v4 = t_seed - PRIME_1;
+
+            // Four independent lanes so the compiler can keep them all in flight
+            for (; data + 32 <= end; data += 32) {
+                v1 = round(v1, read64(data + 0));
+                v2 = round(v2, read64(data + 8));
+                v3 = round(v3, read64(data + 16));
+                v4 = round(v4, read64(data + 24));
+            }
+
+            result = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+            result = mergeRound(result, v1);
+            result = mergeRound(result, v2);
+            result = mergeRound(result, v3);
+            result = mergeRound(result, v4);
+        }
+        else {
+            result = t_seed + PRIME_5;
+        }
+
+        result += t_data.size();
+
+        for (; data + 8 <= end; data += 8) {
+            result ^= round(0, read64(data));
+            result = std::rotl(result, 27) * PRIME_1 + PRIME_4;
+        }
+
+        if (data + 4 <= end) {
+            result ^= static_cast<uint64_t>(read32(data)) * PRIME_1;
+            result = std::rotl(result, 23) * PRIME_2 + PRIME_3;
+            data += 4;
+        }
+
+        for (; data < end; data++) {
+            result ^= (*data) * PRIME_5;
+            result = std::rotl(result, 11) * PRIME_1;
+        }
+
+        result ^= result >> 33;
+        result *= PRIME_2;
+        result ^= result >> 29;
+        result *= PRIME_3;
+        result ^= result >> 32;
+
+        return result;
+    }
+
+}
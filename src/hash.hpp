@@ -0,0 +1,15 @@
+#ifndef RNES_HASH_INCLUDED
+#define RNES_HASH_INCLUDED
+
+#include <span>
+
+#include "defines.hpp"
+
+namespace RNES {
+
+    // 64-bit xxHash (XXH64) of t_data. Not cryptographic, only for detecting identical contents.
+    [[nodiscard]] uint64_t hash64(std::span<const uint8_t> t_data, uint64_t t_seed=0);
+
+}
+
+#endif
@@ -0,0 +1,98 @@
+#include "binary_parser.hpp"
+#include "hash.hpp"
+#include "hash_log.hpp"
+#include "save_state.hpp"
+#include "mapper/mapped_file.hpp"
+
+namespace RNES {
+
+    // "RNHL" when read as little endian
+    static const uint32_t HASH_LOG_MAGIC = 0x4C484E52;
+    static const uint16_t HASH_LOG_VERSION = 1;
+    // Magic, version, ROM hash and whether pictures are hashed
+    static const size_t HASH_LOG_HEADER_SIZE = 4 + 2 + 8 + 1;
+    // State and picture hashes
+    static const size_t MAX_FRAME_SIZE = 8 + 8;
+
+    FrameHasher::FrameHasher(const Console& t_console, bool t_hashPictures)
+        : m_hashPictures(t_hashPictures)
+        , m_state(t_console.getStateSize())
+    {
+        ;
+    }
+
+    FrameHashes FrameHasher::hash(const Console& t_console) {
+        const auto saved = t_console.saveState(m_state);
+        ASSERT(!saved.is_error(), "Console state doesn't match the hasher");
+
+        FrameHashes result{ hash64(m_state), 0 };
+        if (m_hashPictures) {
+            const std::span<const uint32_t> picture = t_console.getFrameBuffer();
+            if (!picture.empty()) {
+                result.picture = hash64({ reinterpret_cast<const uint8_t*>(picture.data()), picture.size_bytes() });
+            }
+        }
+        return result;
+    }
+
+    bool FrameHasher::hashesPictures() const {
+        return m_hashPictures;
+    }
+
+    HashLogWriter::HashLogWriter(std::ofstream t_file, bool t_hasPictures)
+        : m_file(std::move(t_file))
+        , m_hasPictures(t_hasPictures)
+    {
+        ;
+    }
+
+    ErrorOr<std::unique_ptr<HashLogWriter>> HashLogWriter::open(const char* t_filePath, uint64_t t_romHash, bool t_hasPictures) {
+        std::ofstream file(t_filePath, std::ios::binary | std::ios::trunc);
+        REQUIRE(file.is_open(), ERROR_FAILED_TO_OPEN_HASH_LOG);
+
+        std::array<uint8_t, HASH_LOG_HEADER_SIZE> header{};
+        StateWriter writer(header);
+        writer.value(HASH_LOG_MAGIC);
+        writer.value(HASH_LOG_VERSION);
+        writer.value(t_romHash);
+        writer.value(t_hasPictures);
+        file.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+        return std::unique_ptr<HashLogWriter>(new HashLogWriter(std::move(file), t_hasPictures));
+    }
+
+    void HashLogWriter::write(const FrameHashes& t_hashes) {
+        std::array<uint8_t, MAX_FRAME_SIZE> frame{};
+        StateWriter writer(frame);
+        writer.value(t_hashes.state);
+        if (m_hasPictures) {
+            writer.value(t_hashes.picture);
+        }
+        m_file.write(reinterpret_cast<const char*>(frame.data()), static_cast<std::streamsize>(writer.position()));
+    }
+
+    ErrorOr<HashLog> loadHashLog(const char* t_filePath) {
+        const auto file = Mapper::mapFile(t_filePath);
+        REQUIRE(!file.is_error(), ERROR_FAILED_TO_OPEN_HASH_LOG);
+
+        BinaryParser parser(file.get_value()->data());
+        REQUIRE(TRY(parser.read<uint32_t>()) == HASH_LOG_MAGIC, ERROR_INVALID_HASH_LOG);
+        REQUIRE(TRY(parser.read<uint16_t>()) == HASH_LOG_VERSION, ERROR_INVALID_HASH_LOG);
+
+        HashLog log{};
+        log.romHash = TRY(parser.read<uint64_t>());
+        log.hasPictures = TRY(parser.read<uint8_t>()) != 0;
+
+        // A run that was cut short may have left part of a frame at the end, which is ignored
+        const size_t frameSize = log.hasPictures ? MAX_FRAME_SIZE : 8;
+        const size_t frameCount = (file.get_value()->data().size() - parser.position()) / frameSize;
+        log.frames.resize(frameCount);
+        for (FrameHashes& frame : log.frames) {
+            frame.state = TRY(parser.read<uint64_t>());
+            frame.picture = log.hasPictures ? TRY(parser.read<uint64_t>()) : 0;
+        }
+
+        return log;
+    }
+
+}
@@ -0,0 +1,72 @@
+#ifndef RNES_HASH_LOG_INCLUDED
+#define RNES_HASH_LOG_INCLUDED
+
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "console.hpp"
+#include "defines.hpp"
+#include "error_or.hpp"
+
+namespace RNES {
+
+    enum HashLogError {
+        ERROR_FAILED_TO_OPEN_HASH_LOG = 0x600,
+        ERROR_INVALID_HASH_LOG,
+    };
+
+    struct FrameHashes {
+        // hash64 of the save state: CPU registers, RAM, VRAM, OAM, palette, APU and mapper
+        uint64_t state;
+        // hash64 of the frame buffer, or 0 if pictures aren't hashed or the frame wasn't drawn
+        uint64_t picture;
+
+        bool operator==(const FrameHashes&) const = default;
+    };
+
+    /* Hashes a console after each frame, so two runs that should match (two builds, or two ways of
+     * running the same movie) can be compared frame by frame to find where they first went apart.
+     * A state hash costs a save state and hashing ~15KB, a few microseconds. Pictures are 240KB and
+     * cost about ten times that, which is still well under 1% of a frame.
+     */
+    class FrameHasher {
+    public:
+        FrameHasher(const Console& t_console, bool t_hashPictures);
+
+        [[nodiscard]] FrameHashes hash(const Console& t_console);
+
+        [[nodiscard]] bool hashesPictures() const;
+
+    private:
+        bool m_hashPictures;
+        std::vector<uint8_t> m_state;
+    };
+
+    /* A stream of FrameHashes, one per frame from the first, after a header with the ROM hash and
+     * whether pictures were hashed. Each frame is 8 bytes, or 16 with pictures.
+     */
+    class HashLogWriter {
+    public:
+        static ErrorOr<std::unique_ptr<HashLogWriter>> open(const char* t_filePath, uint64_t t_romHash, bool t_hasPictures);
+
+        void write(const FrameHashes& t_hashes);
+
+    private:
+        HashLogWriter(std::ofstream t_file, bool t_hasPictures);
+
+        std::ofstream m_file;
+        bool m_hasPictures;
+    };
+
+    struct HashLog {
+        uint64_t romHash;
+        bool hasPictures; // picture hashes are all 0 otherwise
+        std::vector<FrameHashes> frames;
+    };
+
+    ErrorOr<HashLog> loadHashLog(const char* t_filePath);
+
+}
+
+#endif
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "console.hpp"
+#include "hash.hpp"
+#include "hash_log.hpp"
+#include "movie.hpp"
+#include "output/file_sink.hpp"
+
+/* Runs a ROM without any window or audio device and reports how fast it went, along with a hash
+ * of the final state for comparing runs. Frames and samples are thrown away unless paths are given
+ * to write them to, as raw RGBA video and a WAV file.
+ * --run-ahead <frames> measures the cost of run-ahead.
+ * --play <movie> replays a recorded movie, to the end of it if frame_count is 0.
+ * --hash-log <path> writes a hash of the state after every frame, and --check-hashes <path>
+ * compares against one and reports the first frame that differs. --hash-pictures draws and hashes
+ * the pictures too, which are only compared if the reference has them as well.
+ */
+int main(int argc, char* argv[]) {
+    std::vector<char*> args;
+    size_t runAheadFrames = 0;
+    const char* moviePath = nullptr;
+    const char* hashLogPath = nullptr;
+    const char* referenceLogPath = nullptr;
+    bool hashPictures = false;
+    for (int i = 0; i < argc; i++) {
+        if (std::string(argv[i]) == "--run-ahead" && i + 1 < argc) {
+            runAheadFrames = std::stoull(argv[++i]);
+        } else if (std::string(argv[i]) == "--play" && i + 1 < argc) {
+            moviePath = argv[++i];
+        } else if (std::string(argv[i]) == "--hash-log" && i + 1 < argc) {
+            hashLogPath = argv[++i];
+        } else if (std::string(argv[i]) == "--check-hashes" && i + 1 < argc) {
+            referenceLogPath = argv[++i];
+        } else if (std::string(argv[i]) == "--hash-pictures") {
+            hashPictures = true;
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
+    if (argc < 3 || argc > 5) {
+        std::cerr << "Usage: <rom_path> <frame_count> [video_path] [audio_path] [--run-ahead <frames>] [--play <movie>]"
+                  << " [--hash-log <path>] [--check-hashes <path>] [--hash-pictures]" << std::endl;
+        return 1;
+    }
+
+    std::optional<RNES::Movie> movie;
+    if (moviePath != nullptr) {
+        auto movieOrError = RNES::Movie::load(moviePath);
+        if (movieOrError.is_error()) {
+            std::cerr << "Failed to load movie (error " << movieOrError.get_error().getErrorCode() << ")\n";
+            return EXIT_FAILURE;
+        }
+        movie = std::move(movieOrError).get_value();
+    }
+
+    // Movies start without battery RAM, so they are played on a console that has none
+    const auto createConsole = [&]() -> ErrorOr<std::unique_ptr<RNES::Console>> {
+        if (movie.has_value()) {
+            return RNES::Console::fromImage(TRY(RNES::Mapper::loadROMImage(argv[1])));
+        }
+        return RNES::Console::fromFile(argv[1]);
+    };
+
+    auto consoleOrError = createConsole();
+    if (consoleOrError.is_error()) {
+        std::cerr << "Failed to load ROM (error " << consoleOrError.get_error().getErrorCode() << ")\n";
+        return EXIT_FAILURE;
+    }
+    std::unique_ptr<RNES::Console> console = std::move(consoleOrError).get_value();
+
+    if (movie.has_value() && movie->checkROM(*console).is_error()) {
+        std::cerr << "The movie was recorded on another ROM\n";
+        return EXIT_FAILURE;
+    }
+
+    if (argc >= 4) {
+        auto sink = RNES::Output::FileVideoSink::open(argv[3]);
+        if (sink.is_error()) {
+            std::cerr << "Failed to open " << argv[3] << "\n";
+            return EXIT_FAILURE;
+        }
+        console->setVideoSink(std::move(sink).get_value());
+    } else if (!hashPictures) {
+        console->setVideoSink(std::make_unique<RNES::Output::NullVideoSink>());
+    }
+
+    if (argc >= 5) {
+        auto sink = RNES::Output::WAVAudioSink::open(argv[4]);
+        if (sink.is_error()) {
+            std::cerr << "Failed to open " << argv[4] << "\n";
+            return EXIT_FAILURE;
+        }
+        console->setAudioSink(std::move(sink).get_value());
+    }
+
+    console->setRunAhead(runAheadFrames);
+    uint64_t frameCount = std::stoull(argv[2]);
+    if (movie.has_value() && frameCount == 0) {
+        frameCount = movie->getFrameCount();
+    }
+
+    RNES::FrameHasher hasher(*console, hashPictures);
+    std::unique_ptr<RNES::HashLogWriter> hashLog;
+    if (hashLogPath != nullptr) {
+        auto logOrError = RNES::HashLogWriter::open(hashLogPath, console->getROMHash(), hashPictures);
+        if (logOrError.is_error()) {
+            std::cerr << "Failed to open " << hashLogPath << "\n";
+            return EXIT_FAILURE;
+        }
+        hashLog = std::move(logOrError).get_value();
+    }
+
+    std::optional<RNES::HashLog> reference;
+    if (referenceLogPath != nullptr) {
+        auto logOrError = RNES::loadHashLog(referenceLogPath);
+        if (logOrError.is_error() || logOrError.get_value().romHash != console->getROMHash()) {
+            std::cerr << "Failed to load a hash log for this ROM from " << referenceLogPath << "\n";
+            return EXIT_FAILURE;
+        }
+        reference = std::move(logOrError).get_value();
+    }
+    const bool comparePictures = hashPictures && reference.has_value() && reference->hasPictures;
+    std::optional<uint64_t> firstDifference;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < frameCount; i++) {
+        if (movie.has_value()) {
+            movie->apply(*console);
+        }
+        console->runFrame();
+
+        if (hashLog == nullptr && !reference.has_value()) {
+            continue;
+        }
+
+        const RNES::FrameHashes hashes = hasher.hash(*console);
+        if (hashLog != nullptr) {
+            hashLog->write(hashes);
+        }
+
+        if (reference.has_value() && !firstDifference.has_value() && i < reference->frames.size()) {
+            const RNES::FrameHashes& expected = reference->frames[i];
+            if (hashes.state != expected.state || (comparePictures && hashes.picture != expected.picture)) {
+                firstDifference = i;
+            }
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << frameCount << " frames in " << seconds << " s (" << (frameCount / seconds) << " frames/second)\n";
+
+    std::vector<uint8_t> state(console->getStateSize());
+    (void)console->saveState(state);
+    std::cout << "State hash " << std::hex << std::setw(16) << std::setfill('0') << RNES::hash64(state) << std::dec << "\n";
+
+    if (reference.has_value()) {
+        const uint64_t checked = std::min<uint64_t>(frameCount, reference->frames.size());
+        if (firstDifference.has_value()) {
+            std::cout << "First difference from the reference after frame " << *firstDifference << "\n";
+        } else {
+            std::cout << "Matched the reference for " << checked << " frames\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "battery_ram.hpp"
+#include "mapper.hpp"
+
+namespace RNES::Mapper {
+
+    static const auto FLUSH_INTERVAL = std::chrono::seconds(5);
+
+    BatteryRAM::BatteryRAM(uint8_t* t_data, size_t t_size) : m_data(t_data), m_size(t_size), m_flushThread() {
+        m_flushThread = std::jthread([this](std::stop_token t_stopToken) {
+            std::mutex mutex;
+            std::condition_variable_any condition;
+
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!t_stopToken.stop_requested()) {
+                condition.wait_for(lock, t_stopToken, FLUSH_INTERVAL, [] { return false; });
+                flush();
+            }
+        });
+    }
+
+    BatteryRAM::~BatteryRAM() {
+        m_flushThread.request_stop();
+        m_flushThread.join();
+
+        msync(m_data, m_size, MS_SYNC);
+        munmap(m_data, m_size);
+    }
+
+    std::span<uint8_t> BatteryRAM::data() {
+        return { m_data, m_size };
+    }
+
+    void BatteryRAM::flush() {
+        msync(m_data, m_size, MS_ASYNC);
+    }
+
+    ErrorOr<std::unique_ptr<BatteryRAM>> openBatteryRAM(const char* t_filePath, size_t t_size) {
+        const int fd = open(t_filePath, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        REQUIRE(fd >= 0, ERROR_FAILED_TO_OPEN_FILE);
+
+        // Grow new (or truncated) save files to the full size, the extra bytes read as zero
+        struct stat fileInfo {};
+        if (fstat(fd, &fileInfo) != 0 || (static_cast<size_t>(fileInfo.st_size) < t_size && ftruncate(fd, t_size) != 0)) {
+            close(fd);
+            return ErrorCode(ERROR_FAILED_TO_OPEN_FILE);
+        }
+
+        void* data = mmap(nullptr, t_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        REQUIRE(data != MAP_FAILED, ERROR_FAILED_TO_MAP_FILE);
+
+        return std::make_unique<BatteryRAM>(static_cast<uint8_t*>(data), t_size);
+    }
+
+}
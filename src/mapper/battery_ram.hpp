@@ -0,0 +1,42 @@
+#ifndef RNES_BATTERY_RAM_INCLUDED
+#define RNES_BATTERY_RAM_INCLUDED
+
+#include <memory>
+#include <span>
+#include <thread>
+
+#include "defines.hpp"
+#include "error_or.hpp"
+
+namespace RNES::Mapper {
+
+    /* Battery backed RAM kept in a shared memory mapping of its save file. Writes go straight to the
+     * page cache, so nothing is lost if the process dies, and a background thread asks the kernel to
+     * write dirty pages back every few seconds without blocking emulation.
+     */
+    class BatteryRAM {
+    public:
+        BatteryRAM(uint8_t* t_data, size_t t_size);
+
+        BatteryRAM(const BatteryRAM&) = delete;
+        BatteryRAM& operator=(const BatteryRAM&) = delete;
+
+        ~BatteryRAM();
+
+        [[nodiscard]] std::span<uint8_t> data();
+
+        void flush();
+
+    private:
+        uint8_t* m_data;
+        size_t m_size;
+
+        std::jthread m_flushThread;
+    };
+
+    // Maps t_size bytes of t_filePath, creating the file if it doesn't exist
+    ErrorOr<std::unique_ptr<BatteryRAM>> openBatteryRAM(const char* t_filePath, size_t t_size);
+
+}
+
+#endif
@@ -0,0 +1,56 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "mapped_file.hpp"
+#include "mapper.hpp"
+
+namespace RNES::Mapper {
+
+    MappedFile::MappedFile(const uint8_t* t_data, size_t t_size) : m_data(t_data), m_size(t_size) {
+        ;
+    }
+
+    MappedFile::~MappedFile() {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+
+    std::span<const uint8_t> MappedFile::data() const {
+        return { m_data, m_size };
+    }
+
+    ErrorOr<std::shared_ptr<const MappedFile>> mapFile(const char* t_filePath) {
+        const int fd = open(t_filePath, O_RDONLY | O_CLOEXEC);
+        REQUIRE(fd >= 0, ERROR_FAILED_TO_OPEN_FILE);
+
+        struct stat fileInfo {};
+        if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size <= 0) {
+            close(fd);
+            return ErrorCode(ERROR_INVALID_FILE);
+        }
+
+        // Private pages: the file is only ever read, and the mapping stays valid after the descriptor is closed
+        const size_t size = fileInfo.st_size;
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        close(fd);
+        REQUIRE(data != MAP_FAILED, ERROR_FAILED_TO_MAP_FILE);
+
+        return std::make_shared<const MappedFile>(static_cast<const uint8_t*>(data), size);
+    }
+
+    ErrorOr<std::shared_ptr<const MappedFile>> mapBuffer(std::span<const uint8_t> t_data) {
+        REQUIRE(!t_data.empty(), ERROR_INVALID_FILE);
+
+        void* data = mmap(nullptr, t_data.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        REQUIRE(data != MAP_FAILED, ERROR_FAILED_TO_MAP_FILE);
+
+        std::memcpy(data, t_data.data(), t_data.size());
+        mprotect(data, t_data.size(), PROT_READ);
+
+        return std::make_shared<const MappedFile>(static_cast<const uint8_t*>(data), t_data.size());
+    }
+
+}
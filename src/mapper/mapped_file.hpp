@@ -0,0 +1,36 @@
+#ifndef RNES_MAPPED_FILE_INCLUDED
+#define RNES_MAPPED_FILE_INCLUDED
+
+#include <memory>
+#include <span>
+
+#include "defines.hpp"
+#include "error_or.hpp"
+
+namespace RNES::Mapper {
+
+    /* A non-copyable, read-only memory mapping of a whole file */
+    class MappedFile {
+    public:
+        MappedFile(const uint8_t* t_data, size_t t_size);
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile();
+
+        [[nodiscard]] std::span<const uint8_t> data() const;
+
+    private:
+        const uint8_t* m_data;
+        size_t m_size;
+    };
+
+    ErrorOr<std::shared_ptr<const MappedFile>> mapFile(const char* t_filePath);
+
+    // Copies t_data into a read-only anonymous mapping, for images that don't come from a file
+    ErrorOr<std::shared_ptr<const MappedFile>> mapBuffer(std::span<const uint8_t> t_data);
+
+}
+
+#endif
@@ -1,125 +1,23 @@
-#include <array>
+#include <filesystem>
 #include <iomanip>
 #include <iostream>
-#include <fstream>
+#include <span>
+#include <string>
 #include <utility>
-#include <vector>
 
 #include "assert.hpp"
+#include "battery_ram.hpp"
+#include "binary_parser.hpp"
 #include "defines.hpp"
 #include "error_or.hpp"
+#include "hash.hpp"
+#include "mapped_file.hpp"
 #include "mapper.hpp"
 #include "mapper0.hpp"
+#include "mapper4.hpp"
 
 namespace RNES::Mapper {
 
-    ErrorOr<std::vector<uint8_t>> readFile(const char *t_filePath);
-
-    class BinaryParser {
-    public:
-        explicit BinaryParser(std::vector<uint8_t> t_data) : m_data(std::move(t_data)), m_index(0) {
-            ;
-        }
-
-        template<typename T>
-        ErrorOr<T> read() {
-            REQUIRE(m_index + sizeof(T) <= m_data.size(), ERROR_INDEX_OUT_OF_RANGE);
-            T result = 0;
-            for (size_t i = 0; i < sizeof(T); i++) {
-                result |= m_data[m_index + i] << (sizeof(char) * i);
-            }
-
-            m_index += sizeof(T);
-            return result;
-        }
-
-        template<size_t N>
-        ErrorOr<std::array<uint8_t, N>> readBytes() {
-            REQUIRE(m_index + N <= m_data.size(), ERROR_INDEX_OUT_OF_RANGE);
-            std::array<uint8_t, N> result{};
-
-            for (size_t i = 0; i < N; i++) {
-                result[i] = m_data[m_index + i];
-            }
-
-            m_index += N;
-            return result;
-        }
-
-        ErrorOr<std::vector<uint8_t>> readBytes(size_t t_count) {
-            REQUIRE(m_index + t_count <= m_data.size(), ERROR_INDEX_OUT_OF_RANGE);
-            std::vector<uint8_t> result(t_count, 0);
-
-            for (size_t i = 0; i < t_count; i++) {
-                result[i] = m_data[m_index + i];
-            }
-
-            m_index += t_count;
-            return result;
-        }
-
-        ErrorOr<std::vector<uint8_t>> readRest() {
-            return readBytes(m_data.size() - m_index);
-        }
-
-        void skip(size_t t_amount) {
-            m_index += t_amount;
-        }
-
-    private:
-        std::vector<uint8_t> m_data;
-        size_t m_index;
-    };
-
-    enum class MirroringType : bool {
-        HORIZONTAL = false,
-        VERTICAL = true
-    };
-
-    enum class ConsoleType : uint8_t {
-        NES_OR_FAMICOM = 0,
-        NINTENDO_VS,
-        NINTENDO_PLAYCHOICE,
-        EXTENDED_CONSOLE_TYPE
-    };
-
-    enum class PPUTimingMode : uint8_t {
-        NTSC = 0,
-        PAL,
-        MULTI_REGION,
-        DENDY
-    };
-
-    struct INESHeader {
-        MirroringType mirroringType;
-        bool hasBattery;
-        bool hasTrainer;
-        bool usesFourScreenMode;
-
-        ConsoleType consoleType;
-        bool usesINES2Format;
-
-        PPUTimingMode cpuPpuTimingMode;
-
-        // TODO: Only NES/Famicom supported
-
-        uint16_t mapperNumber;
-        uint8_t subMapperNumber;
-
-        size_t prgRomSize;
-        size_t chrRomSize;
-
-        size_t prgRamSize;
-        size_t eepromSize;
-
-        size_t chrRamSize;
-        size_t chrNVRamSize;
-
-        size_t noMiscellaneousRoms;
-
-        size_t defaultExpansionDevice;
-    };
-
     ErrorOr<INESHeader> parseINESHeader(BinaryParser &t_parser) {
         const auto flags = TRY(t_parser.readBytes<16>());
         REQUIRE(
@@ -189,63 +87,97 @@ namespace RNES::Mapper {
         return header;
     }
 
-    // TODO: change return type back to ErrorOr<Mapper>
-    Mapper parseMapperFromINES(const char *t_filePath) {
-        const std::vector<uint8_t> fileData = readFile(t_filePath).get_value();
-        BinaryParser parser{fileData};
+    static ErrorOr<std::shared_ptr<const ROMImage>> parseROMImage(const std::shared_ptr<const MappedFile>& t_file) {
+        const uint64_t hash = hash64(t_file->data());
+
+        // Consoles running the same game share one image
+        std::shared_ptr<const ROMImage> cachedImage = findCachedROMImage(hash, t_file->data());
+        if (cachedImage != nullptr) {
+            return cachedImage;
+        }
 
-        INESHeader header = parseINESHeader(parser).get_value();
+        BinaryParser parser{t_file->data()};
 
-        std::array<uint8_t, 512> trainerArea{};
+        const INESHeader header = TRY(parseINESHeader(parser));
+
+        std::span<const uint8_t> trainerArea{};
         if (header.hasTrainer) {
-            trainerArea = parser.readBytes<512>().get_value();
+            trainerArea = TRY(parser.readBytes(512));
         }
 
         // TODO: check this works with VS system stuff
-        std::vector<uint8_t> prgRom{};
+        std::span<const uint8_t> prgRom{};
         if ((header.prgRomSize & 0x0F00) == 0x0F00) {
             const size_t multiplier = header.prgRomSize & 0x03;
             const size_t exponent = header.prgRomSize & 0xFC;
             const size_t trueSize = (1 << exponent) * (2 * multiplier + 1);
 
-            prgRom = parser.readBytes(trueSize).get_value();
+            prgRom = TRY(parser.readBytes(trueSize));
         } else {
-            prgRom = parser.readBytes(header.prgRomSize * 0x4000).get_value();
+            prgRom = TRY(parser.readBytes(header.prgRomSize * 0x4000));
         }
 
-        std::vector<uint8_t> chrRom{};
+        std::span<const uint8_t> chrRom{};
         if ((header.chrRomSize & 0x0F00) == 0x0F00) {
             const size_t multiplier = header.chrRomSize & 0x03;
             const size_t exponent = header.chrRomSize & 0xFC;
             const size_t trueSize = (1 << exponent) * (2 * multiplier + 1);
 
-            chrRom = parser.readBytes(trueSize).get_value();
+            chrRom = TRY(parser.readBytes(trueSize));
         } else {
-            chrRom = parser.readBytes(header.chrRomSize * 8192).get_value();
+            chrRom = TRY(parser.readBytes(header.chrRomSize * 8192));
         }
 
-        std::vector<uint8_t> miscRom = parser.readRest().get_value();
+        std::span<const uint8_t> miscRom = TRY(parser.readRest());
 
-        if (header.mapperNumber == 0) {
-            return createMapper0(prgRom, chrRom);
-        }
+        return cacheROMImage(std::make_shared<const ROMImage>(ROMImage{ header, hash, t_file, prgRom, chrRom }));
+    }
 
-        ASSERT(false, ":(");
+    ErrorOr<std::shared_ptr<const ROMImage>> loadROMImage(const char *t_filePath) {
+        const std::shared_ptr<const MappedFile> file = TRY(mapFile(t_filePath));
+        return parseROMImage(file);
     }
 
-    ErrorOr<std::vector<uint8_t>> readFile(const char *t_filePath) {
-        std::ifstream fileStream(t_filePath, std::ios::in | std::ios::binary | std::ios::ate);
-        REQUIRE(fileStream.is_open(), ERROR_FAILED_TO_OPEN_FILE);
+    ErrorOr<std::shared_ptr<const ROMImage>> loadROMImage(std::span<const uint8_t> t_fileData) {
+        const std::shared_ptr<const MappedFile> file = TRY(mapBuffer(t_fileData));
+        return parseROMImage(file);
+    }
+
+    ErrorOr<Mapper> createMapper(const std::shared_ptr<const ROMImage>& t_image, std::unique_ptr<BatteryRAM> t_battery) {
+        switch (t_image->header.mapperNumber) {
+            case 0:
+                return createMapper0(t_image, std::move(t_battery));
+            case 4:
+                return createMapper4(t_image, std::move(t_battery));
+            default:
+                return ErrorCode(ERROR_UNSUPPORTED_MAPPER);
+        }
+    }
 
-        const std::streampos fileSize = fileStream.tellg();
-        fileStream.seekg(std::ios::beg);
+    ErrorOr<Mapper> createMapperFromINES(const char *t_filePath) {
+        const std::shared_ptr<const ROMImage> image = TRY(loadROMImage(t_filePath));
 
-        std::vector<uint8_t> result;
-        result.resize(fileSize);
-        fileStream.read(reinterpret_cast<char *>(result.data()), fileSize);
+        std::unique_ptr<BatteryRAM> battery = nullptr;
+        if (image->header.hasBattery) {
+            const std::string savePath = std::filesystem::path(t_filePath).replace_extension(".sav").string();
 
-        return result;
+            auto batteryOrError = openBatteryRAM(savePath.c_str(), PRG_RAM_SIZE);
+            if (batteryOrError.is_error()) {
+                std::cerr << "Failed to open save file " << savePath << ", progress will not be saved\n";
+            }
+            else {
+                battery = std::move(batteryOrError).get_value();
+            }
+        }
+
+        return createMapper(image, std::move(battery));
     }
 
-}
+    Mapper parseMapperFromINES(const char *t_filePath) {
+        auto mapper = createMapperFromINES(t_filePath);
+        ASSERT(!mapper.is_error(), "Failed to load ROM");
 
+        return std::move(mapper).get_value();
+    }
+
+}
@@ -2,14 +2,21 @@
 #define RNES_MAPPER_INCLUDED
 
 #include <memory>
+#include <span>
 
+#include "battery_ram.hpp"
 #include "error_or.hpp"
 #include "cpu/cpu_memory_map.hpp"
 #include "ppu/ppu_memory_map.hpp"
+#include "rom_image.hpp"
 
 namespace RNES::Mapper {
 
+    static const size_t PRG_RAM_SIZE = 0x2000;
+    static const size_t CHR_RAM_SIZE = 0x2000;
+
     struct Mapper {
+        std::shared_ptr<const ROMImage> image;
         std::unique_ptr<CPU::CPUMemoryMap> cpuController;
         std::unique_ptr<PPU::PPUMemoryMap> ppuController;
     };
@@ -18,8 +25,18 @@ namespace RNES::Mapper {
         ERROR_INDEX_OUT_OF_RANGE,
         ERROR_INVALID_FILE,
         ERROR_FAILED_TO_OPEN_FILE,
+        ERROR_FAILED_TO_MAP_FILE,
+        ERROR_UNSUPPORTED_MAPPER,
     };
 
+    ErrorOr<std::shared_ptr<const ROMImage>> loadROMImage(const char* t_filePath);
+    ErrorOr<std::shared_ptr<const ROMImage>> loadROMImage(std::span<const uint8_t> t_fileData);
+
+    ErrorOr<Mapper> createMapper(const std::shared_ptr<const ROMImage>& t_image, std::unique_ptr<BatteryRAM> t_battery);
+
+    // Battery RAM is kept in a .sav file next to the ROM
+    ErrorOr<Mapper> createMapperFromINES(const char* t_filePath);
+
     Mapper parseMapperFromINES(const char* t_filePath);
 
 }
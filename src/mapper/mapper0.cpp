@@ -9,53 +9,94 @@
 
 namespace RNES::Mapper {
 
-    CPUMapper0::CPUMapper0(std::vector<uint8_t> t_prgRom)
-            : m_prgRom(std::move(t_prgRom)), m_prgRam({0}) {
+    CPUMapper0::CPUMapper0(std::shared_ptr<const ROMImage> t_image, std::unique_ptr<BatteryRAM> t_battery)
+            : m_image(std::move(t_image)), m_prgRam(std::move(t_battery)) {
 
-        ASSERT(m_prgRom.size() == 0x4000 || m_prgRom.size() == 0x8000, "Invalid PRG-ROM size");
+        ASSERT(m_image->prgRom.size() == 0x4000 || m_image->prgRom.size() == 0x8000, "Invalid PRG-ROM size");
     }
 
     RNES::Word CPUMapper0::readWord(RNES::Address t_address) const {
         ASSERT(t_address >= 0x6000, "Invalid Address");
         if (t_address < 0x8000) {
-            return m_prgRam[t_address - 0x6000];
+            return m_prgRam.read(t_address - 0x6000);
         }
 
-        return m_prgRom[(t_address - 0x8000) % m_prgRom.size()];
+        return m_image->prgRom[(t_address - 0x8000) % m_image->prgRom.size()];
     }
 
     void CPUMapper0::writeWord(RNES::Address t_address, RNES::Word t_value) {
         ASSERT(t_address >= 0x6000, "Invalid Address");
-        m_prgRam[t_address - 0x6000] = t_value;
+        if (t_address < 0x8000) {
+            m_prgRam.write(t_address - 0x6000, t_value);
+        }
+    }
+
+    bool CPUMapper0::isRegister(RNES::Address t_address) const {
+        // NROM has no registers, writes to ROM are ignored
+        (void)t_address;
+        return false;
+    }
+
+    void CPUMapper0::saveState(StateWriter& t_writer) const {
+        m_prgRam.saveState(t_writer);
+    }
+
+    void CPUMapper0::loadState(StateReader& t_reader) {
+        m_prgRam.loadState(t_reader);
+    }
+
+    void CPUMapper0::shareMemoryWith(const CPU::CPUMemoryMap& t_source) {
+        m_prgRam.shareWith(static_cast<const CPUMapper0&>(t_source).m_prgRam);
     }
 
 
-    CHRMapper0::CHRMapper0(std::array<Word, 0x2000> t_chrRom) : m_chrRom(t_chrRom) {
+    CHRMapper0::CHRMapper0(std::shared_ptr<const ROMImage> t_image)
+            : m_image(std::move(t_image)), m_mirroring(getHeaderMirroring(m_image->header)), m_chr(m_image->chrRom), m_chrRam() {
 
+        ASSERT(m_chr.empty() || m_chr.size() == 0x2000, "Invalid CHR-ROM size");
     }
 
     Word CHRMapper0::readWord(Address t_address) {
-        return m_chrRom[t_address];
+        if (m_chr.empty()) {
+            return m_chrRam.read(t_address);
+        }
+        return m_chr[t_address];
     }
 
     void CHRMapper0::writeWord(Address t_address, Word t_value) {
-        m_chrRom[t_address] = t_value;
+        // Writes to CHR-ROM are ignored
+        if (m_chr.empty()) {
+            m_chrRam.write(t_address, t_value);
+        }
     }
 
+    PPU::Mirroring CHRMapper0::getMirroring() const {
+        return m_mirroring;
+    }
 
-    Mapper createMapper0(std::vector<uint8_t> t_prgRom, std::vector<uint8_t> t_chrRom) {
-        ASSERT(t_chrRom.size() == 0x2000, "Invalid CHR-ROM size");
-
-        std::array<Word, 0x2000> chrRom{0};
+    void CHRMapper0::saveState(StateWriter& t_writer) const {
+        if (m_chr.empty()) {
+            m_chrRam.saveState(t_writer);
+        }
+    }
 
-        for (size_t i = 0; i < chrRom.size(); i++) {
-            chrRom[i] = t_chrRom[i];
+    void CHRMapper0::loadState(StateReader& t_reader) {
+        if (m_chr.empty()) {
+            m_chrRam.loadState(t_reader);
         }
+    }
+
+    void CHRMapper0::shareMemoryWith(const PPU::CHRMap& t_source) {
+        m_chrRam = static_cast<const CHRMapper0&>(t_source).m_chrRam;
+    }
+
 
+    Mapper createMapper0(const std::shared_ptr<const ROMImage>& t_image, std::unique_ptr<BatteryRAM> t_battery) {
         Mapper result{};
 
-        result.cpuController = std::make_unique<CPUMapper0>(std::move(t_prgRom));
-        result.ppuController = std::make_unique<PPU::PPUMemoryMap>(std::make_unique<CHRMapper0>(chrRom));
+        result.image = t_image;
+        result.cpuController = std::make_unique<CPUMapper0>(t_image, std::move(t_battery));
+        result.ppuController = std::make_unique<PPU::PPUMemoryMap>(std::make_unique<CHRMapper0>(t_image));
 
         return result;
     }
@@ -2,37 +2,57 @@
 #define RNES_MAPPER0_INCLUDED
 
 #include <array>
+#include <memory>
+#include <span>
 #include <vector>
 
+#include "battery_ram.hpp"
+#include "copy_on_write_memory.hpp"
 #include "defines.hpp"
 #include "mapper.hpp"
+#include "prg_ram.hpp"
+#include "rom_image.hpp"
 
 namespace RNES::Mapper {
 
     class CPUMapper0 : public CPU::CPUMemoryMap {
     public:
-        explicit CPUMapper0(std::vector<uint8_t> t_prgRom);
+        CPUMapper0(std::shared_ptr<const ROMImage> t_image, std::unique_ptr<BatteryRAM> t_battery);
         ~CPUMapper0() override = default;
 
         [[nodiscard]] Word readWord(Address t_address) const override;
         void writeWord(Address t_address, Word t_value) override;
+        [[nodiscard]] bool isRegister(Address t_address) const override;
+
+        void saveState(StateWriter& t_writer) const override;
+        void loadState(StateReader& t_reader) override;
+        void shareMemoryWith(const CPU::CPUMemoryMap& t_source) override;
 
     private:
-        const std::vector<uint8_t> m_prgRom;
-        std::array<uint8_t, 0x2000> m_prgRam{};
+        std::shared_ptr<const ROMImage> m_image;
+        PRGRAM m_prgRam;
     };
 
     class CHRMapper0 : public PPU::CHRMap {
     public:
-        explicit CHRMapper0(std::array<Word, 0x2000> t_chrRom);
+        explicit CHRMapper0(std::shared_ptr<const ROMImage> t_image);
 
         Word readWord(Address t_address) override;
         void writeWord(Address t_address, Word t_value) override;
+
+        [[nodiscard]] PPU::Mirroring getMirroring() const override;
+
+        void saveState(StateWriter& t_writer) const override;
+        void loadState(StateReader& t_reader) override;
+        void shareMemoryWith(const PPU::CHRMap& t_source) override;
     private:
-        std::array<Word, 0x2000> m_chrRom;
+        std::shared_ptr<const ROMImage> m_image;
+        PPU::Mirroring m_mirroring; // soldered on the board
+        std::span<const Word> m_chr; // the image's CHR-ROM, or empty for CHR-RAM
+        CopyOnWriteMemory<CHR_RAM_SIZE> m_chrRam; // only used by boards without CHR-ROM
     };
 
-    Mapper createMapper0(std::vector<uint8_t> t_prgRom, std::vector<uint8_t> t_chrRom);
+    Mapper createMapper0(const std::shared_ptr<const ROMImage>& t_image, std::unique_ptr<BatteryRAM> t_battery);
 
 }
 
@@ -0,0 +1,238 @@
+#include "assert.hpp"
+#include "mapper.hpp"
+#include "mapper4.hpp"
+#include "ppu/ppu_memory_map.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace RNES::Mapper {
+
+    static const size_t PRG_BANK_SIZE = 0x2000;
+    static const size_t CHR_BANK_SIZE = 0x0400;
+
+    CPUMapper4::CPUMapper4(std::shared_ptr<const ROMImage> t_image, std::unique_ptr<BatteryRAM> t_battery, std::shared_ptr<MMC3Registers> t_registers)
+            : m_image(std::move(t_image)), m_prgRam(std::move(t_battery)), m_registers(std::move(t_registers)) {
+
+        const size_t prgRomSize = m_image->prgRom.size();
+        ASSERT(prgRomSize >= 2 * PRG_BANK_SIZE && prgRomSize % PRG_BANK_SIZE == 0, "Invalid PRG-ROM size");
+    }
+
+    Word CPUMapper4::readWord(Address t_address) const {
+        ASSERT(t_address >= 0x6000, "Invalid Address");
+        if (t_address < 0x8000) {
+            return m_prgRam.read(t_address - 0x6000);
+        }
+
+        const size_t slot = (t_address - 0x8000) / PRG_BANK_SIZE;
+        return m_image->prgRom[getPRGBank(slot) * PRG_BANK_SIZE + (t_address % PRG_BANK_SIZE)];
+    }
+
+    void CPUMapper4::writeWord(Address t_address, Word t_value) {
+        ASSERT(t_address >= 0x6000, "Invalid Address");
+        if (t_address < 0x8000) {
+            // PRG-RAM protect ($A001) is ignored, as MMC6 boards interpret it differently
+            m_prgRam.write(t_address - 0x6000, t_value);
+            return;
+        }
+
+        MMC3Registers& registers = *m_registers;
+        const bool even = (t_address % 2) == 0;
+
+        if (t_address < 0xA000) {
+            if (even) {
+                registers.bankSelect = t_value;
+            }
+            else {
+                registers.bankData[registers.bankSelect & 0x07] = t_value;
+            }
+        }
+        else if (t_address < 0xC000) {
+            if (even) {
+                registers.horizontalMirroring = t_value & 0x01;
+            }
+        }
+        else if (t_address < 0xE000) {
+            if (even) {
+                registers.irqLatch = t_value;
+            }
+            else {
+                registers.irqCounter = 0;
+                registers.irqReload = true;
+            }
+        }
+        else {
+            if (even) {
+                registers.irqEnabled = false;
+                registers.irqAsserted = false; // acknowledge any pending interrupt
+            }
+            else {
+                registers.irqEnabled = true;
+            }
+        }
+    }
+
+    bool CPUMapper4::isIRQAsserted() const {
+        return m_registers->irqAsserted;
+    }
+
+    void CPUMapper4::saveState(StateWriter& t_writer) const {
+        const MMC3Registers& registers = *m_registers;
+
+        m_prgRam.saveState(t_writer);
+        t_writer.value(registers.bankSelect);
+        t_writer.bytes(registers.bankData);
+        t_writer.value(registers.horizontalMirroring);
+        t_writer.value(registers.irqLatch);
+        t_writer.value(registers.irqCounter);
+        t_writer.value(registers.irqReload);
+        t_writer.value(registers.irqEnabled);
+        t_writer.value(registers.irqAsserted);
+    }
+
+    void CPUMapper4::loadState(StateReader& t_reader) {
+        MMC3Registers& registers = *m_registers;
+
+        m_prgRam.loadState(t_reader);
+
+        t_reader.value(registers.bankSelect);
+        t_reader.bytes(registers.bankData);
+        t_reader.value(registers.horizontalMirroring);
+        t_reader.value(registers.irqLatch);
+        t_reader.value(registers.irqCounter);
+        t_reader.value(registers.irqReload);
+        t_reader.value(registers.irqEnabled);
+        t_reader.value(registers.irqAsserted);
+    }
+
+    void CPUMapper4::shareMemoryWith(const CPU::CPUMemoryMap& t_source) {
+        m_prgRam.shareWith(static_cast<const CPUMapper4&>(t_source).m_prgRam);
+    }
+
+    size_t CPUMapper4::getPRGBank(size_t t_slot) const {
+        const size_t bankCount = m_image->prgRom.size() / PRG_BANK_SIZE;
+        const bool swapSlots = m_registers->bankSelect & 0x40;
+
+        switch (t_slot) {
+            case 0:
+                return swapSlots ? (bankCount - 2) : (m_registers->bankData[6] % bankCount);
+            case 1:
+                return m_registers->bankData[7] % bankCount;
+            case 2:
+                return swapSlots ? (m_registers->bankData[6] % bankCount) : (bankCount - 2);
+            case 3:
+                return bankCount - 1;
+            default:
+                ASSERT(false, "Invalid PRG slot");
+        }
+    }
+
+
+    CHRMapper4::CHRMapper4(std::shared_ptr<const ROMImage> t_image, std::shared_ptr<MMC3Registers> t_registers)
+            : m_image(std::move(t_image)), m_fourScreen(m_image->header.usesFourScreenMode), m_chr(m_image->chrRom), m_chrRam(), m_registers(std::move(t_registers)) {
+
+        ASSERT(m_chr.size() % CHR_BANK_SIZE == 0, "Invalid CHR-ROM size");
+    }
+
+    Word CHRMapper4::readWord(Address t_address) {
+        if (m_chr.empty()) {
+            return m_chrRam.read(getCHRAddress(t_address));
+        }
+        return m_chr[getCHRAddress(t_address)];
+    }
+
+    void CHRMapper4::writeWord(Address t_address, Word t_value) {
+        // Writes to CHR-ROM are ignored
+        if (m_chr.empty()) {
+            m_chrRam.write(getCHRAddress(t_address), t_value);
+        }
+    }
+
+    PPU::Mirroring CHRMapper4::getMirroring() const {
+        if (m_fourScreen) {
+            return PPU::Mirroring::FOUR_SCREEN;
+        }
+        return m_registers->horizontalMirroring ? PPU::Mirroring::HORIZONTAL : PPU::Mirroring::VERTICAL;
+    }
+
+    void CHRMapper4::clockScanlineCounter() {
+        MMC3Registers& registers = *m_registers;
+
+        if (registers.irqCounter == 0 || registers.irqReload) {
+            registers.irqCounter = registers.irqLatch;
+            registers.irqReload = false;
+        }
+        else {
+            registers.irqCounter--;
+        }
+
+        if (registers.irqCounter == 0 && registers.irqEnabled) {
+            registers.irqAsserted = true;
+        }
+    }
+
+    std::optional<size_t> CHRMapper4::getClocksUntilIRQ() const {
+        const MMC3Registers& registers = *m_registers;
+        if (!registers.irqEnabled || registers.irqAsserted) {
+            return std::nullopt;
+        }
+
+        // A counter that is about to be reloaded takes one clock to reload and then counts down the
+        // latch. With a latch of 0 it reloads to 0 and fires on every clock.
+        if (registers.irqCounter == 0 || registers.irqReload) {
+            return 1 + registers.irqLatch;
+        }
+        return registers.irqCounter;
+    }
+
+    void CHRMapper4::saveState(StateWriter& t_writer) const {
+        if (m_chr.empty()) {
+            m_chrRam.saveState(t_writer);
+        }
+    }
+
+    void CHRMapper4::loadState(StateReader& t_reader) {
+        if (m_chr.empty()) {
+            m_chrRam.loadState(t_reader);
+        }
+    }
+
+    void CHRMapper4::shareMemoryWith(const PPU::CHRMap& t_source) {
+        m_chrRam = static_cast<const CHRMapper4&>(t_source).m_chrRam;
+    }
+
+    size_t CHRMapper4::getCHRAddress(Address t_address) const {
+        ASSERT(t_address < 0x2000, "Invalid Address");
+
+        // Bit 7 of the bank select swaps the 2KB and 1KB halves of the pattern tables
+        const size_t invert = (m_registers->bankSelect & 0x80) ? 4 : 0;
+        const size_t slot = (t_address / CHR_BANK_SIZE) ^ invert;
+
+        size_t bank = 0;
+        if (slot < 4) {
+            bank = (m_registers->bankData[slot / 2] & 0xFE) + (slot % 2);
+        }
+        else {
+            bank = m_registers->bankData[slot - 2];
+        }
+
+        const size_t bankCount = (m_chr.empty() ? CHR_RAM_SIZE : m_chr.size()) / CHR_BANK_SIZE;
+        return (bank % bankCount) * CHR_BANK_SIZE + (t_address % CHR_BANK_SIZE);
+    }
+
+
+    Mapper createMapper4(const std::shared_ptr<const ROMImage>& t_image, std::unique_ptr<BatteryRAM> t_battery) {
+        auto registers = std::make_shared<MMC3Registers>();
+        // Until the game sets it, start out with the mirroring the header asks for
+        registers->horizontalMirroring = getHeaderMirroring(t_image->header) == PPU::Mirroring::HORIZONTAL;
+
+        Mapper result{};
+
+        result.image = t_image;
+        result.cpuController = std::make_unique<CPUMapper4>(t_image, std::move(t_battery), registers);
+        result.ppuController = std::make_unique<PPU::PPUMemoryMap>(std::make_unique<CHRMapper4>(t_image, registers));
+
+        return result;
+    }
+
+}
@@ -0,0 +1,84 @@
+#ifndef RNES_MAPPER4_INCLUDED
+#define RNES_MAPPER4_INCLUDED
+
+#include <array>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "battery_ram.hpp"
+#include "copy_on_write_memory.hpp"
+#include "defines.hpp"
+#include "mapper.hpp"
+#include "prg_ram.hpp"
+#include "rom_image.hpp"
+
+namespace RNES::Mapper {
+
+    /* MMC3 registers, shared between the CPU and PPU halves of the cartridge */
+    struct MMC3Registers {
+        uint8_t bankSelect;
+        std::array<uint8_t, 8> bankData;
+        bool horizontalMirroring; // ignored by four-screen boards
+
+        uint8_t irqLatch;
+        uint8_t irqCounter;
+        bool irqReload;
+        bool irqEnabled;
+        bool irqAsserted;
+    };
+
+    class CPUMapper4 : public CPU::CPUMemoryMap {
+    public:
+        CPUMapper4(std::shared_ptr<const ROMImage> t_image, std::unique_ptr<BatteryRAM> t_battery, std::shared_ptr<MMC3Registers> t_registers);
+        ~CPUMapper4() override = default;
+
+        [[nodiscard]] Word readWord(Address t_address) const override;
+        void writeWord(Address t_address, Word t_value) override;
+
+        [[nodiscard]] bool isIRQAsserted() const override;
+
+        // PRG-RAM and the registers shared with CHRMapper4
+        void saveState(StateWriter& t_writer) const override;
+        void loadState(StateReader& t_reader) override;
+        void shareMemoryWith(const CPU::CPUMemoryMap& t_source) override;
+
+    private:
+        [[nodiscard]] size_t getPRGBank(size_t t_slot) const;
+
+        std::shared_ptr<const ROMImage> m_image;
+        PRGRAM m_prgRam;
+        std::shared_ptr<MMC3Registers> m_registers;
+    };
+
+    class CHRMapper4 : public PPU::CHRMap {
+    public:
+        CHRMapper4(std::shared_ptr<const ROMImage> t_image, std::shared_ptr<MMC3Registers> t_registers);
+
+        Word readWord(Address t_address) override;
+        void writeWord(Address t_address, Word t_value) override;
+
+        [[nodiscard]] PPU::Mirroring getMirroring() const override;
+
+        void clockScanlineCounter() override;
+        [[nodiscard]] std::optional<size_t> getClocksUntilIRQ() const override;
+
+        void saveState(StateWriter& t_writer) const override;
+        void loadState(StateReader& t_reader) override;
+        void shareMemoryWith(const PPU::CHRMap& t_source) override;
+
+    private:
+        [[nodiscard]] size_t getCHRAddress(Address t_address) const;
+
+        std::shared_ptr<const ROMImage> m_image;
+        bool m_fourScreen;
+        std::span<const uint8_t> m_chr; // the image's CHR-ROM, or empty for CHR-RAM
+        CopyOnWriteMemory<CHR_RAM_SIZE> m_chrRam; // only used by boards without CHR-ROM
+        std::shared_ptr<MMC3Registers> m_registers;
+    };
+
+    Mapper createMapper4(const std::shared_ptr<const ROMImage>& t_image, std::unique_ptr<BatteryRAM> t_battery);
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+#include <cstring>
+#include <utility>
+
+#include "assert.hpp"
+#include "prg_ram.hpp"
+
+namespace RNES::Mapper {
+
+    // Loading compares this much at a time, and only writes what changed
+    static const size_t BATTERY_COMPARE_SIZE = 0x100;
+
+    PRGRAM::PRGRAM(std::unique_ptr<BatteryRAM> t_battery) : m_battery(std::move(t_battery)), m_batteryData(), m_memory() {
+        if (m_battery != nullptr) {
+            m_batteryData = m_battery->data();
+            ASSERT(m_batteryData.size() == PRG_RAM_SIZE, "Battery RAM is the wrong size");
+        }
+    }
+
+    void PRGRAM::saveState(StateWriter& t_writer) const {
+        if (m_battery != nullptr) {
+            t_writer.bytes(std::span<const uint8_t>(m_batteryData));
+        }
+        else {
+            m_memory.saveState(t_writer);
+        }
+    }
+
+    void PRGRAM::loadState(StateReader& t_reader) {
+        if (m_battery == nullptr) {
+            m_memory.loadState(t_reader);
+            return;
+        }
+
+        // Unchanged pages of the save file aren't dirtied, so there's nothing new to write back
+        const std::span<const uint8_t> saved = t_reader.view(PRG_RAM_SIZE);
+        for (size_t i = 0; i < PRG_RAM_SIZE; i += BATTERY_COMPARE_SIZE) {
+            if (std::memcmp(m_batteryData.data() + i, saved.data() + i, BATTERY_COMPARE_SIZE) != 0) {
+                std::memcpy(m_batteryData.data() + i, saved.data() + i, BATTERY_COMPARE_SIZE);
+            }
+        }
+    }
+
+    void PRGRAM::shareWith(const PRGRAM& t_source) {
+        ASSERT(m_battery == nullptr, "Battery RAM can't be shared");
+        if (t_source.m_battery == nullptr) {
+            m_memory = t_source.m_memory;
+        }
+    }
+
+}
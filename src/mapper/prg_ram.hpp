@@ -0,0 +1,52 @@
+#ifndef RNES_PRG_RAM_INCLUDED
+#define RNES_PRG_RAM_INCLUDED
+
+#include <memory>
+#include <span>
+
+#include "battery_ram.hpp"
+#include "copy_on_write_memory.hpp"
+#include "defines.hpp"
+#include "mapper.hpp"
+#include "save_state.hpp"
+
+namespace RNES::Mapper {
+
+    /* The cartridge's PRG-RAM at $6000-$7FFF. With a battery the save file's mapping is the only
+     * copy, read and written in place. Without one, as in forked consoles, it's copy-on-write memory
+     * shared with the console it was forked from.
+     */
+    class PRGRAM {
+    public:
+        explicit PRGRAM(std::unique_ptr<BatteryRAM> t_battery);
+
+        [[nodiscard]] Word read(size_t t_index) const {
+            return m_battery != nullptr ? m_batteryData[t_index] : m_memory.read(t_index);
+        }
+
+        void write(size_t t_index, Word t_value) {
+            if (m_battery != nullptr) {
+                m_batteryData[t_index] = t_value;
+            }
+            else {
+                m_memory.write(t_index, t_value);
+            }
+        }
+
+        // Both kinds save the same bytes, so states move freely between them
+        void saveState(StateWriter& t_writer) const;
+        void loadState(StateReader& t_reader);
+
+        // Shares t_source's pages. A battery's can't be shared, so a child of a battery cart is left
+        // for loadState() to fill.
+        void shareWith(const PRGRAM& t_source);
+
+    private:
+        std::unique_ptr<BatteryRAM> m_battery;
+        std::span<uint8_t> m_batteryData;
+        CopyOnWriteMemory<PRG_RAM_SIZE> m_memory; // only used without a battery
+    };
+
+}
+
+#endif
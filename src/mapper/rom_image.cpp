@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "rom_image.hpp"
+
+namespace RNES::Mapper {
+
+    PPU::Mirroring getHeaderMirroring(const INESHeader& t_header) {
+        if (t_header.usesFourScreenMode) {
+            return PPU::Mirroring::FOUR_SCREEN;
+        }
+        return (t_header.mirroringType == MirroringType::VERTICAL) ? PPU::Mirroring::VERTICAL : PPU::Mirroring::HORIZONTAL;
+    }
+
+    // Only holds weak references, an image is unmapped once the last console using it is destroyed
+    static std::mutex s_cacheMutex;
+    static std::unordered_map<uint64_t, std::weak_ptr<const ROMImage>> s_cache;
+
+    static bool sameContents(const ROMImage& t_image, std::span<const uint8_t> t_fileData) {
+        const std::span<const uint8_t> imageData = t_image.file->data();
+        return std::equal(imageData.begin(), imageData.end(), t_fileData.begin(), t_fileData.end());
+    }
+
+    std::shared_ptr<const ROMImage> findCachedROMImage(uint64_t t_hash, std::span<const uint8_t> t_fileData) {
+        const std::lock_guard<std::mutex> lock(s_cacheMutex);
+
+        const auto it = s_cache.find(t_hash);
+        if (it == s_cache.end()) {
+            return nullptr;
+        }
+
+        std::shared_ptr<const ROMImage> image = it->second.lock();
+        if (image == nullptr || !sameContents(*image, t_fileData)) {
+            return nullptr;
+        }
+
+        return image;
+    }
+
+    std::shared_ptr<const ROMImage> cacheROMImage(std::shared_ptr<const ROMImage> t_image) {
+        const std::lock_guard<std::mutex> lock(s_cacheMutex);
+
+        std::erase_if(s_cache, [](const auto& t_entry) { return t_entry.second.expired(); });
+
+        const auto [it, inserted] = s_cache.try_emplace(t_image->hash, t_image);
+        if (!inserted) {
+            std::shared_ptr<const ROMImage> existing = it->second.lock();
+            if (existing != nullptr && sameContents(*existing, t_image->file->data())) {
+                return existing;
+            }
+
+            // On a hash collision the newest image replaces the old one, which stays valid for its users
+            it->second = t_image;
+        }
+
+        return t_image;
+    }
+
+}
@@ -0,0 +1,85 @@
+#ifndef RNES_ROM_IMAGE_INCLUDED
+#define RNES_ROM_IMAGE_INCLUDED
+
+#include <memory>
+#include <span>
+
+#include "defines.hpp"
+#include "mapped_file.hpp"
+#include "ppu/chr_map.hpp"
+
+namespace RNES::Mapper {
+
+    enum class MirroringType : bool {
+        HORIZONTAL = false,
+        VERTICAL = true
+    };
+
+    enum class ConsoleType : uint8_t {
+        NES_OR_FAMICOM = 0,
+        NINTENDO_VS,
+        NINTENDO_PLAYCHOICE,
+        EXTENDED_CONSOLE_TYPE
+    };
+
+    enum class PPUTimingMode : uint8_t {
+        NTSC = 0,
+        PAL,
+        MULTI_REGION,
+        DENDY
+    };
+
+    struct INESHeader {
+        MirroringType mirroringType;
+        bool hasBattery;
+        bool hasTrainer;
+        bool usesFourScreenMode;
+
+        ConsoleType consoleType;
+        bool usesINES2Format;
+
+        PPUTimingMode cpuPpuTimingMode;
+
+        // TODO: Only NES/Famicom supported
+
+        uint16_t mapperNumber;
+        uint8_t subMapperNumber;
+
+        size_t prgRomSize;
+        size_t chrRomSize;
+
+        size_t prgRamSize;
+        size_t eepromSize;
+
+        size_t chrRamSize;
+        size_t chrNVRamSize;
+
+        size_t noMiscellaneousRoms;
+
+        size_t defaultExpansionDevice;
+    };
+
+    /* The immutable parts of a cartridge. Images are shared by every console built from the same
+     * file contents, so anything a mapper can write to has to live in the mapper itself.
+     */
+    struct ROMImage {
+        INESHeader header;
+        uint64_t hash; // hash of the whole file
+
+        std::shared_ptr<const MappedFile> file;
+        std::span<const uint8_t> prgRom; // views into file
+        std::span<const uint8_t> chrRom;
+    };
+
+    // The mirroring set by the header, which mappers without a mirroring register use throughout
+    [[nodiscard]] PPU::Mirroring getHeaderMirroring(const INESHeader& t_header);
+
+    // Returns a live image with the same file contents as t_fileData, if one exists
+    std::shared_ptr<const ROMImage> findCachedROMImage(uint64_t t_hash, std::span<const uint8_t> t_fileData);
+
+    // Adds t_image to the cache. If another thread cached the same contents first that image is returned instead.
+    std::shared_ptr<const ROMImage> cacheROMImage(std::shared_ptr<const ROMImage> t_image);
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <fstream>
+
+#include "binary_parser.hpp"
+#include "movie.hpp"
+#include "save_state.hpp"
+#include "mapper/mapped_file.hpp"
+
+namespace RNES {
+
+    // "RNMV" when read as little endian
+    static const uint32_t MOVIE_MAGIC = 0x564D4E52;
+    static const uint16_t MOVIE_VERSION = 1;
+    // Magic, version, ROM hash and frame count
+    static const size_t MOVIE_HEADER_SIZE = 4 + 2 + 8 + 8;
+
+    Movie::Movie(uint64_t t_romHash) : m_romHash(t_romHash), m_frames() {
+        ;
+    }
+
+    ErrorOr<Movie> Movie::load(const char* t_filePath) {
+        const auto file = Mapper::mapFile(t_filePath);
+        REQUIRE(!file.is_error(), ERROR_FAILED_TO_OPEN_MOVIE);
+
+        const std::span<const uint8_t> data = file.get_value()->data();
+        BinaryParser parser(data);
+        REQUIRE(TRY(parser.read<uint32_t>()) == MOVIE_MAGIC, ERROR_INVALID_MOVIE);
+        REQUIRE(TRY(parser.read<uint16_t>()) == MOVIE_VERSION, ERROR_MOVIE_VERSION_MISMATCH);
+
+        Movie movie(TRY(parser.read<uint64_t>()));
+        const uint64_t frameCount = TRY(parser.read<uint64_t>());
+        REQUIRE(frameCount <= (data.size() - MOVIE_HEADER_SIZE) / sizeof(InputFrame), ERROR_INVALID_MOVIE);
+
+        movie.m_frames.resize(frameCount);
+        for (InputFrame& frame : movie.m_frames) {
+            const std::span<const uint8_t, sizeof(InputFrame)> bytes = TRY(parser.readBytes<sizeof(InputFrame)>());
+            std::copy(bytes.begin(), bytes.end(), frame.begin());
+        }
+
+        return movie;
+    }
+
+    ErrorOr<void> Movie::save(const char* t_filePath) const {
+        std::ofstream file(t_filePath, std::ios::binary | std::ios::trunc);
+        REQUIRE(file.is_open(), ERROR_FAILED_TO_OPEN_MOVIE);
+
+        std::vector<uint8_t> data(MOVIE_HEADER_SIZE + m_frames.size() * sizeof(InputFrame));
+        StateWriter writer(data);
+        writer.value(MOVIE_MAGIC);
+        writer.value(MOVIE_VERSION);
+        writer.value(m_romHash);
+        writer.value(static_cast<uint64_t>(m_frames.size()));
+        for (const InputFrame& frame : m_frames) {
+            writer.bytes(frame);
+        }
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+        file.close();
+        REQUIRE(!file.fail(), ERROR_FAILED_TO_WRITE_MOVIE);
+        return {};
+    }
+
+    void Movie::record(uint64_t t_frame, const InputFrame& t_input) {
+        m_frames.resize(t_frame + 1);
+        m_frames[t_frame] = t_input;
+    }
+
+    InputFrame Movie::getInput(uint64_t t_frame) const {
+        return (t_frame < m_frames.size()) ? m_frames[t_frame] : InputFrame{};
+    }
+
+    void Movie::apply(Console& t_console) const {
+        const InputFrame input = getInput(t_console.getFrameCount());
+        for (size_t port = 0; port < input.size(); port++) {
+            t_console.setInput(port, input[port]);
+        }
+    }
+
+    ErrorOr<void> Movie::checkROM(const Console& t_console) const {
+        REQUIRE(t_console.getROMHash() == m_romHash, ERROR_MOVIE_ROM_MISMATCH);
+        return {};
+    }
+
+    uint64_t Movie::getROMHash() const {
+        return m_romHash;
+    }
+
+    uint64_t Movie::getFrameCount() const {
+        return m_frames.size();
+    }
+
+}
@@ -0,0 +1,59 @@
+#ifndef RNES_MOVIE_INCLUDED
+#define RNES_MOVIE_INCLUDED
+
+#include <span>
+#include <vector>
+
+#include "console.hpp"
+#include "defines.hpp"
+#include "error_or.hpp"
+
+namespace RNES {
+
+    enum MovieError {
+        ERROR_FAILED_TO_OPEN_MOVIE = 0x500,
+        ERROR_FAILED_TO_WRITE_MOVIE,
+        ERROR_INVALID_MOVIE,
+        ERROR_MOVIE_VERSION_MISMATCH,
+        ERROR_MOVIE_ROM_MISMATCH,
+    };
+
+    /* The buttons held on both controllers for every frame of a run, which is all it takes to
+     * replay it exactly, as the console is deterministic. Movies start from power on with no
+     * battery RAM, so they should be recorded and played on consoles made with fromImage() or
+     * fromBuffer().
+     *
+     * Files are a small header (magic, version, ROM hash and frame count) followed by one byte per
+     * controller per frame.
+     */
+    class Movie {
+    public:
+        explicit Movie(uint64_t t_romHash);
+
+        static ErrorOr<Movie> load(const char* t_filePath);
+        ErrorOr<void> save(const char* t_filePath) const;
+
+        // Sets the input for t_frame and drops everything after it, so recording again over frames
+        // that were rewound replaces them. Frames skipped over hold no buttons.
+        void record(uint64_t t_frame, const InputFrame& t_input);
+
+        // No buttons are held past the end
+        [[nodiscard]] InputFrame getInput(uint64_t t_frame) const;
+
+        // Sets the console's input for the frame it is about to run
+        void apply(Console& t_console) const;
+
+        // Fails if the movie was recorded on another ROM
+        [[nodiscard]] ErrorOr<void> checkROM(const Console& t_console) const;
+
+        [[nodiscard]] uint64_t getROMHash() const;
+        [[nodiscard]] uint64_t getFrameCount() const;
+
+    private:
+        uint64_t m_romHash;
+        std::vector<InputFrame> m_frames;
+    };
+
+}
+
+#endif
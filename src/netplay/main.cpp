@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "console.hpp"
+#include "hash.hpp"
+#include "mapper/mapper.hpp"
+#include "netplay/rollback_session.hpp"
+#include "netplay/transport.hpp"
+#include "output/video_sink.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+// One NTSC frame, at 60.0988 frames a second. A frame that takes longer, rollback included, would
+// make a real client drop a frame.
+static const auto HOST_FRAME_BUDGET = std::chrono::microseconds(16639);
+
+struct Player {
+    std::unique_ptr<RNES::Console> console;
+    std::unique_ptr<RNES::Netplay::RollbackSession> session;
+    std::mt19937 random;
+    uint8_t buttons = 0;
+
+    double slowestFrame = 0.0; // seconds, including any rollback
+    uint64_t framesOverBudget = 0;
+};
+
+static uint64_t hashState(const RNES::Console& t_console) {
+    std::vector<uint8_t> state(t_console.getStateSize());
+    (void)t_console.saveState(state);
+    return RNES::hash64(state);
+}
+
+/* Plays both sides of a netplay session in one process, each pressing random buttons, over a
+ * loopback link with the given latency or over UDP on localhost. Reports how often each side had to
+ * roll back, how long its slowest frame took and how many frames went over a host frame, then checks
+ * that both ended in the same state.
+ */
+int main(int argc, char* argv[]) {
+    std::vector<char*> args;
+    bool udp = false;
+    uint16_t udpPort = 0;
+    for (int i = 0; i < argc; i++) {
+        if (std::string(argv[i]) == "--udp" && i + 1 < argc) {
+            udp = true;
+            udpPort = static_cast<uint16_t>(std::stoul(argv[++i]));
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
+    if (argc < 3 || argc > 5) {
+        std::cerr << "Usage: <rom_path> <frame_count> [latency_ms] [max_rollback_frames] [--udp <port>]" << std::endl;
+        return 1;
+    }
+
+    auto romOrError = RNES::Mapper::loadROMImage(argv[1]);
+    if (romOrError.is_error()) {
+        std::cerr << "Failed to load ROM (error " << romOrError.get_error().getErrorCode() << ")\n";
+        return EXIT_FAILURE;
+    }
+
+    const uint64_t frameCount = std::stoull(argv[2]);
+    const auto latency = std::chrono::milliseconds((argc >= 4) ? std::stoull(argv[3]) : 50);
+
+    std::unique_ptr<RNES::Netplay::Transport> transports[2];
+    if (udp) {
+        // Both ends live here, on two neighbouring ports, so the link has the kernel's latency
+        for (size_t i = 0; i < 2; i++) {
+            auto transport = RNES::Netplay::UDPTransport::open(udpPort + i, udpPort + (1 - i));
+            if (transport.is_error()) {
+                std::cerr << "Failed to open UDP port " << (udpPort + i) << "\n";
+                return EXIT_FAILURE;
+            }
+            transports[i] = std::move(transport).get_value();
+        }
+    } else {
+        auto [first, second] = RNES::Netplay::LoopbackTransport::createPair(latency);
+        transports[0] = std::move(first);
+        transports[1] = std::move(second);
+    }
+
+    std::vector<Player> players(2);
+    for (size_t i = 0; i < players.size(); i++) {
+        RNES::Netplay::RollbackOptions options;
+        options.localPort = i;
+        if (argc >= 5) {
+            options.maxRollbackFrames = std::stoull(argv[4]);
+        }
+
+        players[i].console = RNES::Console::fromImage(romOrError.get_value()).get_value();
+        players[i].console->setVideoSink(std::make_unique<RNES::Output::NullVideoSink>());
+        players[i].session = std::make_unique<RNES::Netplay::RollbackSession>(*players[i].console, std::move(transports[i]), options);
+        players[i].random.seed(static_cast<uint32_t>(i + 1));
+    }
+
+    // Each side runs as fast as it can and waits only when too far ahead of the other
+    const auto start = Clock::now();
+    while (std::any_of(players.begin(), players.end(), [&](const Player& t_player) { return t_player.session->getFrame() < frameCount; })) {
+        bool advanced = false;
+        for (Player& player : players) {
+            if (player.session->getFrame() >= frameCount) {
+                player.session->poll();
+                continue;
+            }
+
+            // Buttons change every few frames, like a player's would
+            if (player.session->getFrame() % 8 == 0) {
+                player.buttons = static_cast<uint8_t>(player.random());
+            }
+
+            const auto frameStart = Clock::now();
+            if (player.session->advanceFrame(player.buttons)) {
+                const auto frameTime = Clock::now() - frameStart;
+                advanced = true;
+                player.slowestFrame = std::max(player.slowestFrame, std::chrono::duration<double>(frameTime).count());
+                if (frameTime > HOST_FRAME_BUDGET) {
+                    player.framesOverBudget++;
+                }
+            }
+        }
+
+        if (!advanced) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    // The last few frames were still guesses until the other side's input for them arrives
+    while (std::any_of(players.begin(), players.end(), [](const Player& t_player) { return t_player.session->getConfirmedFrame() < t_player.session->getFrame(); })) {
+        for (Player& player : players) {
+            player.session->poll();
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (size_t i = 0; i < players.size(); i++) {
+        const Player& player = players[i];
+        std::cout << "player " << (i + 1) << ": " << player.session->getFrame() << " frames, "
+                  << player.session->getRollbackCount() << " rollbacks, "
+                  << player.session->getResimulatedFrameCount() << " frames resimulated, slowest frame "
+                  << (player.slowestFrame * 1000.0) << " ms, " << player.framesOverBudget << " over the "
+                  << std::chrono::duration<double, std::milli>(HOST_FRAME_BUDGET).count() << " ms budget, state hash "
+                  << std::hex << std::setw(16) << std::setfill('0') << hashState(*player.console) << std::dec << std::setfill(' ') << "\n";
+    }
+    std::cout << frameCount << " frames in " << seconds << " s\n";
+
+    if (hashState(*players[0].console) != hashState(*players[1].console)) {
+        std::cout << "Desynced\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "In sync\n";
+    return 0;
+}
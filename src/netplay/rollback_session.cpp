@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <array>
+
+#include "assert.hpp"
+#include "binary_parser.hpp"
+#include "rollback_session.hpp"
+
+namespace RNES::Netplay {
+
+    // Acknowledged frame count, first frame, input count
+    static const size_t PACKET_HEADER_SIZE = 8 + 8 + 2;
+    // Bounds a packet when the other side has heard nothing for a long time
+    static const size_t MAX_PACKET_INPUTS = 1024;
+
+    RollbackSession::RollbackSession(Console& t_console, std::unique_ptr<Transport> t_transport, const RollbackOptions& t_options)
+        : m_console(t_console)
+        , m_transport(std::move(t_transport))
+        , m_options(t_options)
+        , m_frame(0)
+        , m_localInput(t_options.inputDelay, 0)
+        , m_remoteInput()
+        , m_usedRemoteInput()
+        , m_checkedFrame(0)
+        , m_remoteAcknowledged(0)
+        , m_states((t_options.maxRollbackFrames + 1) * t_console.getStateSize())
+        , m_stateSize(t_console.getStateSize())
+        , m_rollbackCount(0)
+        , m_resimulatedFrameCount(0)
+    {
+        ASSERT(m_options.localPort < 2, "Invalid controller port");
+    }
+
+    bool RollbackSession::advanceFrame(uint8_t t_buttons) {
+        receivePackets();
+        rollBack();
+
+        // The state from before the oldest unconfirmed frame has to stay in the ring
+        if (m_frame > m_remoteInput.size() + m_options.maxRollbackFrames) {
+            sendInput();
+            return false;
+        }
+
+        m_localInput.push_back(t_buttons);
+        sendInput();
+
+        const auto saved = m_console.saveState(stateSlot(m_frame));
+        ASSERT(!saved.is_error(), "Failed to save a rollback state");
+        applyInput(m_frame);
+        m_console.runFrame();
+        m_frame++;
+
+        return true;
+    }
+
+    void RollbackSession::poll() {
+        receivePackets();
+        rollBack();
+        sendInput();
+    }
+
+    uint64_t RollbackSession::getFrame() const {
+        return m_frame;
+    }
+
+    uint64_t RollbackSession::getConfirmedFrame() const {
+        return std::min<uint64_t>(m_remoteInput.size(), m_frame);
+    }
+
+    uint64_t RollbackSession::getRollbackCount() const {
+        return m_rollbackCount;
+    }
+
+    uint64_t RollbackSession::getResimulatedFrameCount() const {
+        return m_resimulatedFrameCount;
+    }
+
+    void RollbackSession::receivePackets() {
+        std::array<uint8_t, PACKET_HEADER_SIZE + MAX_PACKET_INPUTS> buffer{};
+
+        while (true) {
+            const size_t size = m_transport->receive(buffer);
+            if (size == 0) {
+                return;
+            }
+
+            // Anything malformed is dropped, like any other lost packet
+            BinaryParser parser(std::span<const uint8_t>(buffer).first(size));
+            const auto acknowledged = parser.read<uint64_t>();
+            const auto first = parser.read<uint64_t>();
+            const auto count = parser.read<uint16_t>();
+            if (acknowledged.is_error() || first.is_error() || count.is_error()) {
+                continue;
+            }
+
+            const auto input = parser.readBytes(count.get_value());
+            if (input.is_error()) {
+                continue;
+            }
+
+            m_remoteAcknowledged = std::max(m_remoteAcknowledged, std::min<uint64_t>(acknowledged.get_value(), m_localInput.size()));
+
+            // Packets start at the first frame we hadn't acknowledged when they were sent, so one
+            // that starts past what we have is from the future of a lost one
+            const uint64_t start = first.get_value();
+            if (start > m_remoteInput.size()) {
+                continue;
+            }
+            for (size_t i = m_remoteInput.size() - start; i < input.get_value().size(); i++) {
+                m_remoteInput.push_back(input.get_value()[i]);
+            }
+        }
+    }
+
+    void RollbackSession::rollBack() {
+        const uint64_t confirmed = getConfirmedFrame();
+
+        uint64_t frame = m_checkedFrame;
+        while (frame < confirmed && m_usedRemoteInput[frame] == m_remoteInput[frame]) {
+            frame++;
+        }
+        m_checkedFrame = confirmed;
+
+        if (frame == confirmed) {
+            return;
+        }
+
+        // Everything from the first wrong frame on is run again, with the input now known, and
+        // with fresh guesses past it
+        const auto loaded = m_console.loadState(stateSlot(frame));
+        ASSERT(!loaded.is_error(), "Failed to load a rollback state");
+        m_rollbackCount++;
+
+        for (; frame < m_frame; frame++) {
+            const auto saved = m_console.saveState(stateSlot(frame));
+            ASSERT(!saved.is_error(), "Failed to save a rollback state");
+
+            applyInput(frame);
+            m_console.skipFrame();
+            m_resimulatedFrameCount++;
+        }
+    }
+
+    void RollbackSession::sendInput() {
+        const uint64_t first = m_remoteAcknowledged;
+        const size_t count = std::min<size_t>(m_localInput.size() - first, MAX_PACKET_INPUTS);
+
+        std::array<uint8_t, PACKET_HEADER_SIZE + MAX_PACKET_INPUTS> packet{};
+        StateWriter writer(packet);
+        writer.value(static_cast<uint64_t>(m_remoteInput.size()));
+        writer.value(first);
+        writer.value(static_cast<uint16_t>(count));
+        writer.bytes(std::span<const uint8_t>(m_localInput).subspan(first, count));
+
+        m_transport->send(std::span<const uint8_t>(packet).first(writer.position()));
+    }
+
+    void RollbackSession::applyInput(uint64_t t_frame) {
+        // Until anything arrives the other player is guessed to hold nothing
+        uint8_t remote = 0;
+        if (t_frame < m_remoteInput.size()) {
+            remote = m_remoteInput[t_frame];
+        }
+        else if (!m_remoteInput.empty()) {
+            remote = m_remoteInput.back();
+        }
+
+        m_usedRemoteInput.resize(std::max<size_t>(m_usedRemoteInput.size(), t_frame + 1));
+        m_usedRemoteInput[t_frame] = remote;
+
+        m_console.setInput(m_options.localPort, m_localInput[t_frame]);
+        m_console.setInput(1 - m_options.localPort, remote);
+    }
+
+    std::span<uint8_t> RollbackSession::stateSlot(uint64_t t_frame) {
+        const size_t slot = t_frame % (m_options.maxRollbackFrames + 1);
+        return std::span<uint8_t>(m_states).subspan(slot * m_stateSize, m_stateSize);
+    }
+
+}
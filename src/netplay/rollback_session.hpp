@@ -0,0 +1,88 @@
+#ifndef RNES_ROLLBACK_SESSION_INCLUDED
+#define RNES_ROLLBACK_SESSION_INCLUDED
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "console.hpp"
+#include "defines.hpp"
+#include "netplay/transport.hpp"
+
+namespace RNES::Netplay {
+
+    struct RollbackOptions {
+        size_t localPort = 0; // controller port of this player; the other player has the other one
+        size_t inputDelay = 0; // frames before local input takes effect, to make rollbacks rarer
+        // How far ahead of the other player's input this side may run. A rollback runs up to one
+        // more than this many frames again, on top of the new one, and all of that has to fit in a
+        // host frame: at about 4ms a frame, 1 takes 12ms of the 16.6ms. Longer links need
+        // inputDelay, or a faster host for a larger value.
+        size_t maxRollbackFrames = 1;
+    };
+
+    /* Two player netplay that hides latency by guessing. Each frame runs at once with the other
+     * player's input predicted to be the same as the last one received. When the real input arrives
+     * and differs, the console goes back to the state saved before the first wrong frame and runs
+     * every frame since again, without drawing or audio, all within one call to advanceFrame().
+     *
+     * The states of the last maxRollbackFrames + 1 frames are kept in a ring. Running further ahead
+     * of the other player than that would overwrite a state that might still be needed, so the
+     * session waits instead.
+     *
+     * Every packet carries all the local input the other side hasn't acknowledged yet, so lost and
+     * reordered packets only delay things. Both consoles have to start out in the same state, such as
+     * power on or a shared save state, and run the same ROM.
+     */
+    class RollbackSession {
+    public:
+        RollbackSession(Console& t_console, std::unique_ptr<Transport> t_transport, const RollbackOptions& t_options = {});
+
+        // Runs the next frame with t_buttons held by this player. Returns false without running
+        // anything if this side is too far ahead, in which case the same frame should be tried again
+        // later, typically on the next host frame.
+        bool advanceFrame(uint8_t t_buttons);
+
+        // Takes in the other player's input and corrects any wrong guesses, without running a new
+        // frame. For waiting, and for settling the last frames when a session ends.
+        void poll();
+
+        // Frames run since the session started, not counting resimulation
+        [[nodiscard]] uint64_t getFrame() const;
+        // Frames whose input from both players is known, and so can't be rolled back anymore
+        [[nodiscard]] uint64_t getConfirmedFrame() const;
+
+        [[nodiscard]] uint64_t getRollbackCount() const;
+        [[nodiscard]] uint64_t getResimulatedFrameCount() const;
+
+    private:
+        void receivePackets();
+        // Goes back to the first frame that ran with a wrong guess and runs everything since again
+        void rollBack();
+        void sendInput();
+
+        // Sets both ports for t_frame, remembering what was guessed for the other player
+        void applyInput(uint64_t t_frame);
+        [[nodiscard]] std::span<uint8_t> stateSlot(uint64_t t_frame);
+
+        Console& m_console;
+        std::unique_ptr<Transport> m_transport;
+        RollbackOptions m_options;
+
+        uint64_t m_frame;
+        std::vector<uint8_t> m_localInput; // every frame this player's input is known for
+        std::vector<uint8_t> m_remoteInput; // every frame the other player's input has arrived for
+        std::vector<uint8_t> m_usedRemoteInput; // what was actually run with, guessed or not
+        uint64_t m_checkedFrame; // frames before this ran with the right input
+        uint64_t m_remoteAcknowledged; // frames of local input the other side has received
+
+        std::vector<uint8_t> m_states; // ring of states from before each of the last few frames
+        size_t m_stateSize;
+
+        uint64_t m_rollbackCount;
+        uint64_t m_resimulatedFrameCount;
+    };
+
+}
+
+#endif
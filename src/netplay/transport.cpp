@@ -0,0 +1,91 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "transport.hpp"
+
+namespace RNES::Netplay {
+
+    std::pair<std::unique_ptr<LoopbackTransport>, std::unique_ptr<LoopbackTransport>> LoopbackTransport::createPair(std::chrono::microseconds t_latency) {
+        auto forward = std::make_shared<Queue>();
+        auto backward = std::make_shared<Queue>();
+
+        return {
+            std::unique_ptr<LoopbackTransport>(new LoopbackTransport(backward, forward, t_latency)),
+            std::unique_ptr<LoopbackTransport>(new LoopbackTransport(forward, backward, t_latency)),
+        };
+    }
+
+    LoopbackTransport::LoopbackTransport(std::shared_ptr<Queue> t_incoming, std::shared_ptr<Queue> t_outgoing, std::chrono::microseconds t_latency)
+        : m_incoming(std::move(t_incoming))
+        , m_outgoing(std::move(t_outgoing))
+        , m_latency(t_latency)
+    {
+        ;
+    }
+
+    void LoopbackTransport::send(std::span<const uint8_t> t_packet) {
+        const std::lock_guard<std::mutex> lock(m_outgoing->mutex);
+        m_outgoing->packets.push_back({ Clock::now() + m_latency, { t_packet.begin(), t_packet.end() } });
+    }
+
+    size_t LoopbackTransport::receive(std::span<uint8_t> t_buffer) {
+        const std::lock_guard<std::mutex> lock(m_incoming->mutex);
+        if (m_incoming->packets.empty() || m_incoming->packets.front().arrival > Clock::now()) {
+            return 0;
+        }
+
+        // Like a datagram socket, whatever doesn't fit is cut off
+        const std::vector<uint8_t> data = std::move(m_incoming->packets.front().data);
+        m_incoming->packets.pop_front();
+
+        const size_t size = std::min(data.size(), t_buffer.size());
+        std::memcpy(t_buffer.data(), data.data(), size);
+        return size;
+    }
+
+    static sockaddr_in localhost(uint16_t t_port) {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(t_port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return address;
+    }
+
+    ErrorOr<std::unique_ptr<UDPTransport>> UDPTransport::open(uint16_t t_localPort, uint16_t t_remotePort) {
+        const int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        REQUIRE(fd >= 0, ERROR_FAILED_TO_OPEN_SOCKET);
+
+        const sockaddr_in address = localhost(t_localPort);
+        if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            close(fd);
+            return ErrorCode(ERROR_FAILED_TO_OPEN_SOCKET);
+        }
+
+        return std::unique_ptr<UDPTransport>(new UDPTransport(fd, t_remotePort));
+    }
+
+    UDPTransport::UDPTransport(int t_socket, uint16_t t_remotePort) : m_socket(t_socket), m_remotePort(t_remotePort) {
+        ;
+    }
+
+    UDPTransport::~UDPTransport() {
+        close(m_socket);
+    }
+
+    void UDPTransport::send(std::span<const uint8_t> t_packet) {
+        // Losing a packet is expected, so failures to send are too
+        const sockaddr_in address = localhost(m_remotePort);
+        (void)sendto(m_socket, t_packet.data(), t_packet.size(), 0, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    }
+
+    size_t UDPTransport::receive(std::span<uint8_t> t_buffer) {
+        const ssize_t size = recv(m_socket, t_buffer.data(), t_buffer.size(), 0);
+        return (size > 0) ? static_cast<size_t>(size) : 0;
+    }
+
+}
@@ -0,0 +1,86 @@
+#ifndef RNES_TRANSPORT_INCLUDED
+#define RNES_TRANSPORT_INCLUDED
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "defines.hpp"
+#include "error_or.hpp"
+
+namespace RNES::Netplay {
+
+    enum TransportError {
+        ERROR_FAILED_TO_OPEN_SOCKET = 0x700,
+    };
+
+    /* Carries packets to the other player. Delivery is unreliable, as with UDP: packets may be
+     * lost, delayed or reordered, and the session has to cope with all of them.
+     */
+    class Transport {
+    public:
+        virtual ~Transport() = default;
+
+        virtual void send(std::span<const uint8_t> t_packet) = 0;
+        // Copies the next packet that has arrived into t_buffer and returns its size, or 0 if there
+        // is none. Never blocks.
+        [[nodiscard]] virtual size_t receive(std::span<uint8_t> t_buffer) = 0;
+    };
+
+    /* Two ends of an in-process link that hold every packet back for a fixed time, for testing on
+     * one machine. The ends can be used from different threads.
+     */
+    class LoopbackTransport : public Transport {
+    public:
+        static std::pair<std::unique_ptr<LoopbackTransport>, std::unique_ptr<LoopbackTransport>> createPair(std::chrono::microseconds t_latency);
+
+        void send(std::span<const uint8_t> t_packet) override;
+        [[nodiscard]] size_t receive(std::span<uint8_t> t_buffer) override;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Packet {
+            Clock::time_point arrival;
+            std::vector<uint8_t> data;
+        };
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Packet> packets; // in order of arrival, as the latency is fixed
+        };
+
+        LoopbackTransport(std::shared_ptr<Queue> t_incoming, std::shared_ptr<Queue> t_outgoing, std::chrono::microseconds t_latency);
+
+        std::shared_ptr<Queue> m_incoming;
+        std::shared_ptr<Queue> m_outgoing;
+        std::chrono::microseconds m_latency;
+    };
+
+    // Unconnected UDP between two ports on 127.0.0.1
+    class UDPTransport : public Transport {
+    public:
+        static ErrorOr<std::unique_ptr<UDPTransport>> open(uint16_t t_localPort, uint16_t t_remotePort);
+
+        UDPTransport(const UDPTransport&) = delete;
+        UDPTransport& operator=(const UDPTransport&) = delete;
+
+        ~UDPTransport() override;
+
+        void send(std::span<const uint8_t> t_packet) override;
+        [[nodiscard]] size_t receive(std::span<uint8_t> t_buffer) override;
+
+    private:
+        UDPTransport(int t_socket, uint16_t t_remotePort);
+
+        int m_socket;
+        uint16_t m_remotePort;
+    };
+
+}
+
+#endif
@@ -0,0 +1,25 @@
+#include "audio_sink.hpp"
+
+namespace RNES::Output {
+
+    void BufferAudioSink::writeSamples(std::span<const int16_t> t_samples) {
+        m_samples.insert(m_samples.end(), t_samples.begin(), t_samples.end());
+    }
+
+    std::span<const int16_t> BufferAudioSink::getSamples() const {
+        return m_samples;
+    }
+
+    void BufferAudioSink::clear() {
+        m_samples.clear();
+    }
+
+    void NullAudioSink::writeSamples(std::span<const int16_t>) {
+        ;
+    }
+
+    bool NullAudioSink::wantsSamples() const {
+        return false;
+    }
+
+}
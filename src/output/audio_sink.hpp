@@ -0,0 +1,51 @@
+#ifndef RNES_AUDIO_SINK_INCLUDED
+#define RNES_AUDIO_SINK_INCLUDED
+
+#include <span>
+#include <vector>
+
+#include "defines.hpp"
+
+namespace RNES::Output {
+
+    // Where each frame's samples go, mono signed 16-bit at APU::SAMPLE_RATE
+    class AudioSink {
+    public:
+        virtual ~AudioSink() = default;
+
+        virtual void writeSamples(std::span<const int16_t> t_samples) = 0;
+
+        // Sinks that play in real time can ask for slightly more or fewer samples per frame to
+        // track their device's clock. 1.0 leaves the APU's output rate alone.
+        [[nodiscard]] virtual double getRateAdjustment() const {
+            return 1.0;
+        }
+
+        // Sinks that throw every sample away say so, and the console doesn't synthesize any audio
+        [[nodiscard]] virtual bool wantsSamples() const {
+            return true;
+        }
+    };
+
+    // Collects samples until the caller takes them
+    class BufferAudioSink : public AudioSink {
+    public:
+        void writeSamples(std::span<const int16_t> t_samples) override;
+
+        [[nodiscard]] std::span<const int16_t> getSamples() const;
+        void clear();
+
+    private:
+        std::vector<int16_t> m_samples;
+    };
+
+    // Discards every sample
+    class NullAudioSink : public AudioSink {
+    public:
+        void writeSamples(std::span<const int16_t> t_samples) override;
+        [[nodiscard]] bool wantsSamples() const override;
+    };
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include <array>
+#include <cstring>
+
+#include "file_sink.hpp"
+#include "apu/apu.hpp"
+#include "ppu/ppu.hpp"
+
+namespace RNES::Output {
+
+    FileVideoSink::FileVideoSink(std::ofstream t_file)
+        : m_file(std::move(t_file))
+        , m_frame(PPU::OUTPUT_WIDTH * PPU::OUTPUT_HEIGHT, 0)
+    {
+        ;
+    }
+
+    ErrorOr<std::unique_ptr<FileVideoSink>> FileVideoSink::open(const char* t_filePath) {
+        std::ofstream file(t_filePath, std::ios::binary | std::ios::trunc);
+        REQUIRE(file.is_open(), ERROR_FAILED_TO_OPEN_OUTPUT);
+
+        return std::unique_ptr<FileVideoSink>(new FileVideoSink(std::move(file)));
+    }
+
+    std::span<uint32_t> FileVideoSink::beginFrame() {
+        return m_frame;
+    }
+
+    void FileVideoSink::endFrame() {
+        // The packed pixels are R, G, B, A in memory on little-endian machines
+        m_file.write(reinterpret_cast<const char*>(m_frame.data()), static_cast<std::streamsize>(m_frame.size() * sizeof(uint32_t)));
+    }
+
+    static const size_t WAV_HEADER_SIZE = 44;
+
+    WAVAudioSink::WAVAudioSink(std::ofstream t_file)
+        : m_file(std::move(t_file))
+        , m_sampleCount(0)
+    {
+        ;
+    }
+
+    WAVAudioSink::~WAVAudioSink() {
+        m_file.seekp(0);
+        writeHeader();
+    }
+
+    ErrorOr<std::unique_ptr<WAVAudioSink>> WAVAudioSink::open(const char* t_filePath) {
+        std::ofstream file(t_filePath, std::ios::binary | std::ios::trunc);
+        REQUIRE(file.is_open(), ERROR_FAILED_TO_OPEN_OUTPUT);
+
+        std::unique_ptr<WAVAudioSink> sink(new WAVAudioSink(std::move(file)));
+        sink->writeHeader();
+        return sink;
+    }
+
+    void WAVAudioSink::writeSamples(std::span<const int16_t> t_samples) {
+        m_file.write(reinterpret_cast<const char*>(t_samples.data()), static_cast<std::streamsize>(t_samples.size_bytes()));
+        m_sampleCount += t_samples.size();
+    }
+
+    // WAV is little-endian, like the machines this runs on, so values are copied as they are
+    void WAVAudioSink::writeHeader() {
+        const uint32_t sampleRate = static_cast<uint32_t>(APU::SAMPLE_RATE);
+        const uint32_t dataSize = m_sampleCount * sizeof(int16_t);
+
+        std::array<uint8_t, WAV_HEADER_SIZE> header{};
+        size_t offset = 0;
+        const auto put = [&](const void* t_data, size_t t_size) {
+            std::memcpy(header.data() + offset, t_data, t_size);
+            offset += t_size;
+        };
+        const auto put16 = [&](uint16_t t_value) { put(&t_value, sizeof(t_value)); };
+        const auto put32 = [&](uint32_t t_value) { put(&t_value, sizeof(t_value)); };
+
+        put("RIFF", 4);
+        put32(WAV_HEADER_SIZE - 8 + dataSize);
+        put("WAVE", 4);
+        put("fmt ", 4);
+        put32(16);                          // format chunk size
+        put16(1);                           // PCM
+        put16(1);                           // mono
+        put32(sampleRate);
+        put32(sampleRate * sizeof(int16_t)); // bytes per second
+        put16(sizeof(int16_t));             // bytes per sample frame
+        put16(16);                          // bits per sample
+        put("data", 4);
+        put32(dataSize);
+
+        m_file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    }
+
+}
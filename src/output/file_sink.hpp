@@ -0,0 +1,59 @@
+#ifndef RNES_FILE_SINK_INCLUDED
+#define RNES_FILE_SINK_INCLUDED
+
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "defines.hpp"
+#include "error_or.hpp"
+#include "audio_sink.hpp"
+#include "video_sink.hpp"
+
+namespace RNES::Output {
+
+    enum Error {
+        ERROR_FAILED_TO_OPEN_OUTPUT = 0x300,
+    };
+
+    /* Appends every frame to a file as raw RGBA, which ffmpeg can read with
+     * -f rawvideo -pixel_format rgba -video_size 256x240 -framerate 60
+     */
+    class FileVideoSink : public VideoSink {
+    public:
+        static ErrorOr<std::unique_ptr<FileVideoSink>> open(const char* t_filePath);
+
+        std::span<uint32_t> beginFrame() override;
+        void endFrame() override;
+
+    private:
+        explicit FileVideoSink(std::ofstream t_file);
+
+        std::ofstream m_file;
+        std::vector<uint32_t> m_frame;
+    };
+
+    // Writes a mono 16-bit WAV file. The header's sizes are filled in when the sink is destroyed.
+    class WAVAudioSink : public AudioSink {
+    public:
+        static ErrorOr<std::unique_ptr<WAVAudioSink>> open(const char* t_filePath);
+
+        WAVAudioSink(const WAVAudioSink&) = delete;
+        WAVAudioSink& operator=(const WAVAudioSink&) = delete;
+
+        ~WAVAudioSink() override;
+
+        void writeSamples(std::span<const int16_t> t_samples) override;
+
+    private:
+        explicit WAVAudioSink(std::ofstream t_file);
+
+        void writeHeader();
+
+        std::ofstream m_file;
+        uint32_t m_sampleCount;
+    };
+
+}
+
+#endif
@@ -0,0 +1,57 @@
+#include "assert.hpp"
+#include "video_sink.hpp"
+#include "ppu/ppu.hpp"
+
+namespace RNES::Output {
+
+    BufferVideoSink::BufferVideoSink()
+        : m_ownedBuffer(PPU::OUTPUT_WIDTH * PPU::OUTPUT_HEIGHT, 0)
+        , m_buffer(m_ownedBuffer)
+    {
+        ;
+    }
+
+    BufferVideoSink::BufferVideoSink(std::span<uint32_t> t_buffer)
+        : m_ownedBuffer()
+        , m_buffer(t_buffer)
+    {
+        ASSERT(t_buffer.size() == PPU::OUTPUT_WIDTH * PPU::OUTPUT_HEIGHT, "Frame buffer is the wrong size");
+    }
+
+    std::span<uint32_t> BufferVideoSink::beginFrame() {
+        return m_buffer;
+    }
+
+    void BufferVideoSink::endFrame() {
+        ;
+    }
+
+    std::span<const uint32_t> BufferVideoSink::getFrame() const {
+        return m_buffer;
+    }
+
+    IndexedVideoSink::IndexedVideoSink(std::span<uint8_t> t_buffer) : m_buffer(t_buffer) {
+        ASSERT(t_buffer.size() == PPU::OUTPUT_WIDTH * PPU::OUTPUT_HEIGHT, "Frame buffer is the wrong size");
+    }
+
+    std::span<uint32_t> IndexedVideoSink::beginFrame() {
+        return {};
+    }
+
+    std::span<uint8_t> IndexedVideoSink::beginIndexedFrame() {
+        return m_buffer;
+    }
+
+    void IndexedVideoSink::endFrame() {
+        ;
+    }
+
+    std::span<uint32_t> NullVideoSink::beginFrame() {
+        return {};
+    }
+
+    void NullVideoSink::endFrame() {
+        ;
+    }
+
+}
@@ -0,0 +1,69 @@
+#ifndef RNES_VIDEO_SINK_INCLUDED
+#define RNES_VIDEO_SINK_INCLUDED
+
+#include <span>
+#include <vector>
+
+#include "defines.hpp"
+
+namespace RNES::Output {
+
+    /* Where finished pictures go. The sink hands out the memory the PPU draws the next frame into,
+     * so a sink that can expose its destination directly (a locked texture, a mapped file, a
+     * training batch) receives frames without any copies.
+     */
+    class VideoSink {
+    public:
+        virtual ~VideoSink() = default;
+
+        // Memory for the next frame, OUTPUT_WIDTH * OUTPUT_HEIGHT packed RGBA pixels. An empty span
+        // means the frame isn't wanted and the PPU skips drawing it.
+        virtual std::span<uint32_t> beginFrame() = 0;
+        // Sinks that would rather have each pixel's 6-bit colour index, one byte each, return memory
+        // for it here. When this isn't empty, beginFrame() isn't called for the frame.
+        virtual std::span<uint8_t> beginIndexedFrame() {
+            return {};
+        }
+        // The span from beginFrame() now holds a complete picture
+        virtual void endFrame() = 0;
+    };
+
+    // Keeps the latest frame in memory, either its own or memory owned by the caller
+    class BufferVideoSink : public VideoSink {
+    public:
+        BufferVideoSink();
+        explicit BufferVideoSink(std::span<uint32_t> t_buffer);
+
+        std::span<uint32_t> beginFrame() override;
+        void endFrame() override;
+
+        [[nodiscard]] std::span<const uint32_t> getFrame() const;
+
+    private:
+        std::vector<uint32_t> m_ownedBuffer;
+        std::span<uint32_t> m_buffer;
+    };
+
+    // Keeps the latest frame as colour indices, in memory owned by the caller
+    class IndexedVideoSink : public VideoSink {
+    public:
+        explicit IndexedVideoSink(std::span<uint8_t> t_buffer);
+
+        std::span<uint32_t> beginFrame() override;
+        std::span<uint8_t> beginIndexedFrame() override;
+        void endFrame() override;
+
+    private:
+        std::span<uint8_t> m_buffer;
+    };
+
+    // Discards every frame without drawing it
+    class NullVideoSink : public VideoSink {
+    public:
+        std::span<uint32_t> beginFrame() override;
+        void endFrame() override;
+    };
+
+}
+
+#endif
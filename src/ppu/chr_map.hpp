@@ -1,16 +1,56 @@
 #ifndef RNES_CHR_MAP_INCLUDED
 #define RNES_CHR_MAP_INCLUDED
 
+#include <optional>
+
 #include "defines.hpp"
+#include "save_state.hpp"
 
 namespace RNES::PPU {
 
+    // How the four nametables at $2000-$2FFF map onto the console's nametable RAM
+    enum class Mirroring : uint8_t {
+        HORIZONTAL, // $2000 = $2400 and $2800 = $2C00, for vertical scrolling
+        VERTICAL, // $2000 = $2800 and $2400 = $2C00, for horizontal scrolling
+        FOUR_SCREEN, // all four are separate, with extra RAM on the cartridge
+    };
+
     class CHRMap {
     public:
         virtual ~CHRMap() = default;
 
         virtual Word readWord(Address t_address) = 0;
         virtual void writeWord(Address t_address, Word t_value) = 0;
+
+        // Read on every nametable access, so mappers that switch it take effect immediately
+        [[nodiscard]] virtual Mirroring getMirroring() const {
+            return Mirroring::FOUR_SCREEN;
+        }
+
+        // Called by the PPU once for each (filtered) rising edge of PPU address line A12
+        virtual void clockScanlineCounter() {
+            ;
+        }
+
+        // Scanline counter clocks left before the mapper raises its IRQ, or nullopt if it won't with
+        // its current settings. Lets the IRQ be scheduled rather than found by running the PPU.
+        [[nodiscard]] virtual std::optional<size_t> getClocksUntilIRQ() const {
+            return std::nullopt;
+        }
+
+        // Only CHR-RAM needs saving; bank registers belong to the CPU half of the cartridge
+        virtual void saveState(StateWriter& t_writer) const {
+            (void)t_writer;
+        }
+
+        virtual void loadState(StateReader& t_reader) {
+            (void)t_reader;
+        }
+
+        // As CPUMemoryMap::shareMemoryWith(); t_source is the same kind of map
+        virtual void shareMemoryWith(const CHRMap& t_source) {
+            (void)t_source;
+        }
     };
 
 }
@@ -1,6 +1,9 @@
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <utility>
 
 #include "assert.hpp"
 #include "ppu.hpp"
@@ -12,6 +15,13 @@ namespace RNES::PPU {
     static const size_t TILE_SIZE = TILE_WIDTH * TILE_HEIGHT;
 
     static const size_t PATTERN_TABLE_TILE_COUNT = 512;
+    static const size_t NAMETABLE_SIZE = 0x0400;
+
+    static const size_t A12_NO_RISE = SIZE_MAX;
+    static const size_t A12_TRACK_FETCHES = SIZE_MAX - 1;
+    static const size_t A12_FILTER_DOTS = 10; // A12 has to be low for ~3 CPU cycles before a rise is counted
+
+    static const size_t VBLANK_START_DOT = 241 * DOTS_PER_SCANLINE + 1;
 
     static const std::array<RGBAPixel, 64> PALETTE_MAP = {{
         { 0x52, 0x52, 0x52, 0xff },
@@ -93,9 +103,15 @@ namespace RNES::PPU {
 
         , m_lastUpdatedCycle(0)
         , m_currentCycle(0)
+        , m_ioLatch(0)
+        , m_nmiPending(false)
 
         , m_sprites()
-        , m_outputSurface(OUTPUT_WIDTH, OUTPUT_HEIGHT)
+        , m_a12RiseDot(A12_NO_RISE)
+        , m_a12High(false)
+        , m_a12LowSinceCycle(0)
+        , m_frameBuffer()
+        , m_indexBuffer()
     {
 
     }
@@ -103,8 +119,9 @@ namespace RNES::PPU {
     CycleInfo PPU::cycle() {
         CycleInfo cycleInfo{false};
 
-        const size_t scanline = m_currentCycle / 342;
-        const size_t scanlineCycle = m_currentCycle % 342;
+        const size_t frameDot = m_currentCycle % DOTS_PER_FRAME;
+        const size_t scanline = frameDot / DOTS_PER_SCANLINE;
+        const size_t scanlineCycle = frameDot % DOTS_PER_SCANLINE;
 
         // Read sprites from OAM
         if (scanline == 0 && scanlineCycle == 0) {
@@ -112,6 +129,13 @@ namespace RNES::PPU {
         }
 
         if (scanline <= 239 || scanline == 261) {
+            if (scanlineCycle == 0) {
+                m_a12RiseDot = findA12RiseDot();
+            }
+            else if (scanlineCycle == m_a12RiseDot) {
+                m_controller->clockScanlineCounter();
+            }
+
             if (1 <= scanlineCycle && scanlineCycle <= 256) {
                 if (scanlineCycle == 1 && scanline == 261) {
                     m_registers.ppuStatus &= 0x3F; // reset sprite 0 and vblank flags
@@ -122,53 +146,75 @@ namespace RNES::PPU {
 
                 const size_t coarseXScroll = (m_registers.v >> 0) & 0x001F;
                 const size_t coarseYScroll = (m_registers.v >> 5) & 0x001F;
+                const size_t nametable = (m_registers.v >> 10) & 0x0003;
                 const size_t fineXScroll = m_registers.x;
                 const size_t fineYScroll = (m_registers.v >> 12) & 0x0007;
 
-                const uint8_t tileIndex = getTileIndex(coarseXScroll, coarseYScroll);
+                const uint8_t tileIndex = getTileIndex(nametable, coarseXScroll, coarseYScroll);
 
                 const size_t bgNametableAddress = (m_registers.ppuCtrl & 0x10) ? 0x1000 : 0x0000;
                 const uint8_t bgPaletteIndex = getPaletteIndex(bgNametableAddress, tileIndex, (screenX + fineXScroll) % 8, fineYScroll);
-                const size_t bgPalette = getPalette(screenX, screenY);
+                const size_t bgPalette = getPalette(nametable, coarseXScroll, coarseYScroll);
 
                 if (scanline <= 240) {
-                    const SpritePixelData topPixel = findTopSpritePixelData(screenX, screenY);
-
-                    const size_t spritePalette = (topPixel.spriteIndex < SPRITE_COUNT) ? (4 + (m_sprites[topPixel.spriteIndex].attributes & 0x03)) : 0;
-                    RGBAPixel c = { 0, 0, 0, 0 };
-                    if (bgPaletteIndex == 0 && topPixel.paletteIndex == 0) {
-                        c = getColour(0, 0);
+                    // When nothing is drawn the only visible effect of sprites is the sprite 0 hit,
+                    // and sprite 0 is always on top if it has a pixel here
+                    const bool drawing = !m_frameBuffer.empty() || !m_indexBuffer.empty();
+                    const size_t spriteCount = drawing ? SPRITE_COUNT : 1;
+                    const SpritePixelData topPixel = findTopSpritePixelData(screenX, screenY, spriteCount);
+
+                    if (bgPaletteIndex != 0 && topPixel.paletteIndex != 0 && topPixel.spriteIndex == 0) {
+                        m_registers.ppuStatus |= 0x40; // sprite 0 hit
                     }
-                    else if (bgPaletteIndex == 0 && topPixel.paletteIndex != 0) {
-                        c = getColour(spritePalette, topPixel.paletteIndex);
-                    }
-                    else if (bgPaletteIndex != 0 && topPixel.paletteIndex == 0) {
-                        c = getColour(bgPalette, bgPaletteIndex);
-                    }
-                    else {
-                        if (topPixel.spriteIndex == 0) {
-                            m_registers.ppuStatus |= 0x40; // sprite 0 hit
+
+                    if (drawing) {
+                        const size_t spritePalette = (topPixel.spriteIndex < SPRITE_COUNT) ? (4 + (m_sprites[topPixel.spriteIndex].attributes & 0x03)) : 0;
+                        uint8_t colour = 0;
+                        if (bgPaletteIndex == 0 && topPixel.paletteIndex == 0) {
+                            colour = getColourIndex(0, 0);
+                        }
+                        else if (bgPaletteIndex == 0 && topPixel.paletteIndex != 0) {
+                            colour = getColourIndex(spritePalette, topPixel.paletteIndex);
+                        }
+                        else if (bgPaletteIndex != 0 && topPixel.paletteIndex == 0) {
+                            colour = getColourIndex(bgPalette, bgPaletteIndex);
+                        }
+                        else {
+                            // Check sprite priority (0 = infront, 1 = behind)
+                            if (m_sprites[topPixel.spriteIndex].attributes & 0x20) {
+                                colour = getColourIndex(bgPalette, bgPaletteIndex);
+                            }
+                            else {
+                                colour = getColourIndex(spritePalette, topPixel.paletteIndex);
+                            }
                         }
 
-                        // Check sprite priority (0 = infront, 1 = behind)
-                        if (m_sprites[topPixel.spriteIndex].attributes & 0x20) {
-                            c = getColour(bgPalette, bgPaletteIndex);
+                        if (!m_indexBuffer.empty()) {
+                            m_indexBuffer[screenY * OUTPUT_WIDTH + screenX] = colour;
                         }
                         else {
-                            c = getColour(spritePalette, topPixel.paletteIndex);
+                            const RGBAPixel c = PALETTE_MAP[colour];
+                            m_frameBuffer[screenY * OUTPUT_WIDTH + screenX] = (c.r << 0) | (c.g << 8) | (c.b << 16) | (static_cast<uint32_t>(c.a) << 24);
                         }
                     }
-                    m_outputSurface.setPixel(screenX, screenY, c.r, c.g, c.b, c.a);
                 }
 
                 // FIXME: checks for scanlines 257 and above even though we only call when it is between 1 and 256
                 incrementScroll(scanline, scanlineCycle);
             }
             else if (scanlineCycle <= 320) {
-                // TODO: (maybe we can leave this empty?)
+                // Sprite pattern fetches for the next scanline (8x16 sprites fetch the dummy tile 0xFF)
+                if (m_a12RiseDot == A12_TRACK_FETCHES && scanlineCycle % 8 == 5) {
+                    const bool tallSprites = m_registers.ppuCtrl & 0x20;
+                    const bool highTable = tallSprites || (m_registers.ppuCtrl & 0x08);
+                    trackA12(highTable ? 0x1000 : 0x0000);
+                }
             }
             else if (scanlineCycle <= 336) {
-                // TODO: (maybe we can leave this empty?)
+                // Background pattern fetches for the first two tiles of the next scanline
+                if (m_a12RiseDot == A12_TRACK_FETCHES && scanlineCycle % 8 == 5) {
+                    trackA12((m_registers.ppuCtrl & 0x10) ? 0x1000 : 0x0000);
+                }
             }
             else if (scanlineCycle <= 340) {
                 if (scanlineCycle % 2 == 1) {
@@ -190,6 +236,76 @@ namespace RNES::PPU {
         return cycleInfo;
     }
 
+    void PPU::catchUp(uint64_t t_cpuCycle) {
+        const uint64_t targetDot = t_cpuCycle * DOTS_PER_CPU_CYCLE;
+
+        while (m_currentCycle < targetDot) {
+            const CycleInfo info = cycle();
+            if (info.nmi && (m_registers.ppuCtrl & 0x80)) {
+                m_nmiPending = true;
+            }
+        }
+    }
+
+    uint64_t PPU::nextNMICycle() const {
+        return (m_registers.ppuCtrl & 0x80) ? nextVBlankCycle() : UINT64_MAX;
+    }
+
+    uint64_t PPU::nextVBlankCycle() const {
+        // m_currentCycle is the next dot to be run, so the flag is raised once that dot has been
+        const size_t frameDot = m_currentCycle % DOTS_PER_FRAME;
+        const size_t dotsUntilVBlank = (VBLANK_START_DOT + DOTS_PER_FRAME - frameDot) % DOTS_PER_FRAME;
+        const uint64_t vblankDot = m_currentCycle + dotsUntilVBlank;
+
+        return (vblankDot / DOTS_PER_CPU_CYCLE) + 1;
+    }
+
+    uint64_t PPU::nextMapperIRQCycle() const {
+        const std::optional<size_t> clocks = m_controller->getClocksUntilIRQ();
+        if (!clocks.has_value()) {
+            return UINT64_MAX;
+        }
+
+        const uint64_t line = m_currentCycle / DOTS_PER_SCANLINE;
+        const size_t scanline = line % SCANLINES_PER_FRAME;
+        const size_t scanlineCycle = m_currentCycle % DOTS_PER_SCANLINE;
+        const bool renderLine = scanline <= 239 || scanline == 261;
+
+        // This scanline's rise dot was picked on its dot 0; later ones will use the registers as they are now
+        const size_t riseDot = findA12RiseDot();
+        const size_t currentRiseDot = !renderLine ? A12_NO_RISE : (scanlineCycle > 0) ? m_a12RiseDot : riseDot;
+        if (riseDot == A12_TRACK_FETCHES || currentRiseDot == A12_TRACK_FETCHES) {
+            return ((line + 1) * DOTS_PER_SCANLINE) / DOTS_PER_CPU_CYCLE + 1;
+        }
+
+        size_t remaining = *clocks;
+        if (currentRiseDot != A12_NO_RISE && scanlineCycle <= currentRiseDot) {
+            if (remaining == 1) {
+                return (line * DOTS_PER_SCANLINE + currentRiseDot) / DOTS_PER_CPU_CYCLE + 1;
+            }
+            remaining--;
+        }
+        if (riseDot == A12_NO_RISE) {
+            return UINT64_MAX;
+        }
+
+        /* Rises happen once on each of the 241 rendering scanlines in a frame. Numbering lines from
+         * the pre-render line puts those first in every block of 262, so the n-th rendering line
+         * since power on is found by division rather than by walking the scanlines.
+         */
+        const auto renderLinesBefore = [](uint64_t t_shiftedLine) -> uint64_t {
+            return (t_shiftedLine / SCANLINES_PER_FRAME) * 241 + std::min<uint64_t>(t_shiftedLine % SCANLINES_PER_FRAME, 241);
+        };
+        const uint64_t index = renderLinesBefore(line + 2) + remaining - 1;
+        const uint64_t riseLine = (index / 241) * SCANLINES_PER_FRAME + (index % 241) - 1;
+
+        return (riseLine * DOTS_PER_SCANLINE + riseDot) / DOTS_PER_CPU_CYCLE + 1;
+    }
+
+    bool PPU::takeNMI() {
+        return std::exchange(m_nmiPending, false);
+    }
+
     void PPU::loadSprites() {
         for (size_t i = 0; i < SPRITE_COUNT; i++) {
             const Sprite s = {
@@ -202,27 +318,32 @@ namespace RNES::PPU {
         }
     }
 
-    uint8_t PPU::getTileIndex(size_t t_coarseXScroll, size_t t_coarseYScroll) {
+    uint8_t PPU::getTileIndex(size_t t_nametable, size_t t_coarseXScroll, size_t t_coarseYScroll) {
         const size_t nametableIndex = t_coarseYScroll * 32 + t_coarseXScroll;
-        const size_t nametableAddress = 0x2000; // TODO: change this
+        const size_t nametableAddress = 0x2000 + NAMETABLE_SIZE * t_nametable;
 
         return m_controller->readWord(nametableAddress + nametableIndex);
     }
 
     uint8_t PPU::getPaletteIndex(size_t t_baseAddress, size_t t_tileIndex, size_t t_tileX, size_t t_tileY) {
         const size_t tileAddress = t_baseAddress + 16 * t_tileIndex + t_tileY;
+        if (m_a12RiseDot == A12_TRACK_FETCHES) {
+            trackA12(tileAddress);
+        }
+
         const size_t paletteIndexLowBit  = (m_controller->readWord(tileAddress + 0) >> (7 - t_tileX)) & 1;
         const size_t paletteIndexHighBit = (m_controller->readWord(tileAddress + 8) >> (7 - t_tileX)) & 1;
         return (paletteIndexHighBit << 1) | (paletteIndexLowBit << 0);
     }
 
-    size_t PPU::getPalette(size_t t_x, size_t t_y) {
-        const size_t attributeTableAddress = 0x23C0; // TODO: change this
-        const size_t attributeTableX = t_x / 32;
-        const size_t attributeTableY = t_y / 32;
+    size_t PPU::getPalette(size_t t_nametable, size_t t_coarseXScroll, size_t t_coarseYScroll) {
+        // Each attribute byte covers 4x4 tiles, two bits for each 2x2 quadrant
+        const size_t attributeTableAddress = 0x23C0 + NAMETABLE_SIZE * t_nametable;
+        const size_t attributeTableX = t_coarseXScroll / 4;
+        const size_t attributeTableY = t_coarseYScroll / 4;
 
-        const size_t attributeTableHorizontal = (t_x % 32) / 16; // get horizontal quadrant
-        const size_t attributeTableVertical = (t_y % 32) / 16; // get vertical quadrant
+        const size_t attributeTableHorizontal = (t_coarseXScroll % 4) / 2; // get horizontal quadrant
+        const size_t attributeTableVertical = (t_coarseYScroll % 4) / 2; // get vertical quadrant
 
         const size_t attributeTableQuadrant = 2 * attributeTableVertical + attributeTableHorizontal;
         ASSERT(attributeTableQuadrant < 4, "Out of range");
@@ -233,20 +354,20 @@ namespace RNES::PPU {
         return palette;
     }
 
-    RGBAPixel PPU::getColour(size_t t_palette, size_t t_paletteIndex) {
+    uint8_t PPU::getColourIndex(size_t t_palette, size_t t_paletteIndex) {
         if (t_paletteIndex != 0) {
-            return PALETTE_MAP[m_controller->readWord(0x3F00 + 4 * t_palette + t_paletteIndex)];
+            return m_controller->readWord(0x3F00 + 4 * t_palette + t_paletteIndex) & 0x3F;
         }
         else {
-            return PALETTE_MAP[m_controller->readWord(0x3F00)];
+            return m_controller->readWord(0x3F00) & 0x3F;
         }
     }
 
-    PPU::SpritePixelData PPU::findTopSpritePixelData(size_t t_x, size_t t_y) {
+    PPU::SpritePixelData PPU::findTopSpritePixelData(size_t t_x, size_t t_y, size_t t_spriteCount) {
         // TODO: handle 8x16 sprites
         SpritePixelData topSprite = { SPRITE_COUNT, 0 };
 
-        for (size_t i = 0; i < SPRITE_COUNT; i++) {
+        for (size_t i = 0; i < t_spriteCount; i++) {
             if (m_sprites[i].contains(t_x, t_y)) {
                 const size_t localX = t_x - m_sprites[i].x;
                 const size_t localY = t_y - m_sprites[i].y;
@@ -320,29 +441,100 @@ namespace RNES::PPU {
         }
     }
 
+    size_t PPU::findA12RiseDot() const {
+        if ((m_registers.ppuMask & 0x18) == 0) {
+            return A12_NO_RISE; // no fetches happen while rendering is disabled
+        }
+
+        const bool backgroundHigh = m_registers.ppuCtrl & 0x10;
+        const bool spritesHigh = m_registers.ppuCtrl & 0x08;
+        const bool tallSprites = m_registers.ppuCtrl & 0x20;
+
+        if (tallSprites) {
+            return A12_TRACK_FETCHES; // the pattern table depends on each sprite's tile index
+        }
+        else if (!backgroundHigh && spritesHigh) {
+            return 260; // first sprite fetch
+        }
+        else if (backgroundHigh && !spritesHigh) {
+            return 324; // first background fetch for the next scanline
+        }
+        else if (!backgroundHigh && !spritesHigh) {
+            return A12_NO_RISE;
+        }
+        else {
+            return A12_TRACK_FETCHES;
+        }
+    }
+
+    void PPU::trackA12(size_t t_address) {
+        const bool high = t_address & 0x1000;
+
+        if (high && !m_a12High && (m_currentCycle - m_a12LowSinceCycle) >= A12_FILTER_DOTS) {
+            m_controller->clockScanlineCounter();
+        }
+        else if (!high && m_a12High) {
+            m_a12LowSinceCycle = m_currentCycle;
+        }
+
+        m_a12High = high;
+    }
+
     uint8_t PPU::readPPUStatus() {
-        const uint8_t result = m_registers.ppuStatus;
+        // Only the top three bits are driven, the rest is whatever was left on the bus
+        const uint8_t result = (m_registers.ppuStatus & 0xE0) | (m_ioLatch & 0x1F);
         m_registers.ppuStatus &= 0x7F;
         m_registers.w = 0; // reset address latch
+
+        m_ioLatch = result;
         return result;
     }
 
     uint8_t PPU::readOAMData() {
-        return m_oam[m_registers.oamAddr];
+        m_ioLatch = m_oam[m_registers.oamAddr];
+        return m_ioLatch;
     }
 
     uint8_t PPU::readPPUData() {
-        const uint8_t result = m_controller->readWord(m_registers.v);
+        const uint16_t address = m_registers.v & 0x3FFF;
+
+        // Reads return the contents of an internal buffer, which is then refilled from VRAM.
+        // Palette reads skip the buffer, but still fill it with the nametable byte underneath.
+        uint8_t result = 0;
+        if (address < 0x3F00) {
+            result = m_registers.ppuData;
+            m_registers.ppuData = m_controller->readWord(address);
+        }
+        else {
+            result = (m_controller->readWord(address) & 0x3F) | (m_ioLatch & 0xC0);
+            m_registers.ppuData = m_controller->readWord(address - 0x1000);
+        }
+
         if (m_registers.ppuCtrl & 0x04) {
             m_registers.v += 32;
         }
         else {
             m_registers.v += 1;
         }
+
+        m_ioLatch = result;
         return result;
     }
 
+    uint8_t PPU::readIOLatch() {
+        return m_ioLatch;
+    }
+
+    void PPU::writeIOLatch(uint8_t t_value) {
+        m_ioLatch = t_value;
+    }
+
     void PPU::writePPUCTRL(uint8_t t_value) {
+        // Enabling NMIs while the vblank flag is set raises one straight away
+        if (!(m_registers.ppuCtrl & 0x80) && (t_value & 0x80) && (m_registers.ppuStatus & 0x80)) {
+            m_nmiPending = true;
+        }
+
         m_registers.ppuCtrl = t_value;
         m_registers.t = (m_registers.t & 0b11110011'11111111) | ((t_value & 0b00000011) << 10);
     }
@@ -395,8 +587,7 @@ namespace RNES::PPU {
     }
 
     void PPU::writePPUData(uint8_t t_value) {
-        // TODO: set internal register here
-        m_controller->writeWord(m_registers.v, t_value);
+        m_controller->writeWord(m_registers.v & 0x3FFF, t_value);
         if (m_registers.ppuCtrl & 0x04) {
             m_registers.v += 32;
         }
@@ -409,8 +600,112 @@ namespace RNES::PPU {
         m_oam[t_index] = t_value;
     }
 
-    SDL_Surface* PPU::getScreenOutput() {
-        return m_outputSurface.getUnderlyingSurface();
+    void PPU::writeOAMDMA(std::span<const Word, OAM_SIZE> t_page) {
+        // The transfer goes through OAMDATA, so it starts at OAMADDR and wraps back around to it
+        const size_t start = m_registers.oamAddr;
+        std::copy(t_page.begin(), t_page.end() - start, m_oam.begin() + start);
+        std::copy(t_page.end() - start, t_page.end(), m_oam.begin());
+    }
+
+    void PPU::setFrameBuffer(std::span<uint32_t> t_frameBuffer) {
+        ASSERT(t_frameBuffer.empty() || t_frameBuffer.size() == OUTPUT_WIDTH * OUTPUT_HEIGHT, "Frame buffer is the wrong size");
+        m_frameBuffer = t_frameBuffer;
+    }
+
+    std::span<const uint32_t> PPU::getFrameBuffer() const {
+        return m_frameBuffer;
+    }
+
+    void PPU::setIndexBuffer(std::span<uint8_t> t_indexBuffer) {
+        ASSERT(t_indexBuffer.empty() || t_indexBuffer.size() == OUTPUT_WIDTH * OUTPUT_HEIGHT, "Index buffer is the wrong size");
+        m_indexBuffer = t_indexBuffer;
+    }
+
+    void PPU::saveState(StateWriter& t_writer) const {
+        t_writer.bytes(m_oam);
+
+        t_writer.value(m_registers.ppuCtrl);
+        t_writer.value(m_registers.ppuMask);
+        t_writer.value(m_registers.ppuStatus);
+        t_writer.value(m_registers.oamAddr);
+        t_writer.value(m_registers.oamData);
+        t_writer.value(m_registers.ppuScrollX);
+        t_writer.value(m_registers.ppuScrollY);
+        t_writer.value(m_registers.ppuAddr);
+        t_writer.value(m_registers.ppuData);
+        t_writer.value(m_registers.v);
+        t_writer.value(m_registers.t);
+        t_writer.value(m_registers.x);
+        t_writer.value(m_registers.w);
+
+        // Counters are size_t in memory but always 64 bits in the state
+        t_writer.value(static_cast<uint64_t>(m_lastUpdatedCycle));
+        t_writer.value(static_cast<uint64_t>(m_currentCycle));
+        t_writer.value(m_ioLatch);
+        t_writer.value(m_nmiPending);
+
+        // The current scanline's sprites, which OAM may no longer match, packed so they go in one copy
+        std::array<uint8_t, 4 * SPRITE_COUNT> sprites;
+        for (size_t i = 0; i < SPRITE_COUNT; i++) {
+            sprites[4*i + 0] = m_sprites[i].x;
+            sprites[4*i + 1] = m_sprites[i].y;
+            sprites[4*i + 2] = m_sprites[i].tileIndex;
+            sprites[4*i + 3] = m_sprites[i].attributes;
+        }
+        t_writer.bytes(sprites);
+
+        t_writer.value(static_cast<uint64_t>(m_a12RiseDot));
+        t_writer.value(m_a12High);
+        t_writer.value(static_cast<uint64_t>(m_a12LowSinceCycle));
+
+        m_controller->saveState(t_writer);
+    }
+
+    void PPU::loadState(StateReader& t_reader) {
+        const auto readSize = [&t_reader](size_t& t_value) {
+            uint64_t value = 0;
+            t_reader.value(value);
+            t_value = static_cast<size_t>(value);
+        };
+
+        t_reader.bytes(m_oam);
+
+        t_reader.value(m_registers.ppuCtrl);
+        t_reader.value(m_registers.ppuMask);
+        t_reader.value(m_registers.ppuStatus);
+        t_reader.value(m_registers.oamAddr);
+        t_reader.value(m_registers.oamData);
+        t_reader.value(m_registers.ppuScrollX);
+        t_reader.value(m_registers.ppuScrollY);
+        t_reader.value(m_registers.ppuAddr);
+        t_reader.value(m_registers.ppuData);
+        t_reader.value(m_registers.v);
+        t_reader.value(m_registers.t);
+        t_reader.value(m_registers.x);
+        t_reader.value(m_registers.w);
+
+        readSize(m_lastUpdatedCycle);
+        readSize(m_currentCycle);
+        t_reader.value(m_ioLatch);
+        t_reader.value(m_nmiPending);
+
+        const auto sprites = t_reader.view(4 * SPRITE_COUNT);
+        for (size_t i = 0; i < SPRITE_COUNT; i++) {
+            m_sprites[i].x          = sprites[4*i + 0];
+            m_sprites[i].y          = sprites[4*i + 1];
+            m_sprites[i].tileIndex  = sprites[4*i + 2];
+            m_sprites[i].attributes = sprites[4*i + 3];
+        }
+
+        readSize(m_a12RiseDot);
+        t_reader.value(m_a12High);
+        readSize(m_a12LowSinceCycle);
+
+        m_controller->loadState(t_reader);
+    }
+
+    void PPU::shareMemoryWith(const PPU& t_source) {
+        m_controller->shareMemoryWith(*t_source.m_controller);
     }
 
 }
@@ -3,10 +3,10 @@
 
 #include <array>
 #include <memory>
+#include <span>
 
 #include "defines.hpp"
 #include "ppu_memory_map.hpp"
-#include "surface_wrapper.hpp"
 
 namespace RNES::PPU {
 
@@ -16,6 +16,15 @@ namespace RNES::PPU {
     static const size_t OUTPUT_WIDTH = 256;
     static const size_t OUTPUT_HEIGHT = 240;
 
+    static const size_t DOTS_PER_SCANLINE = 341;
+    static const size_t SCANLINES_PER_FRAME = 262;
+    static const size_t DOTS_PER_FRAME = DOTS_PER_SCANLINE * SCANLINES_PER_FRAME;
+    static const size_t DOTS_PER_CPU_CYCLE = 3;
+
+    struct RGBAPixel {
+        uint8_t r, g, b, a;
+    };
+
     struct CycleInfo {
         bool nmi;
     };
@@ -27,10 +36,29 @@ namespace RNES::PPU {
 
         CycleInfo cycle();
 
+        // Runs the PPU up to the given CPU cycle. Register accesses must be preceded by this.
+        void catchUp(uint64_t t_cpuCycle);
+
+        // The CPU cycle by which the next vblank will have started and the picture is complete
+        [[nodiscard]] uint64_t nextVBlankCycle() const;
+        // As above, or UINT64_MAX if NMIs are off
+        [[nodiscard]] uint64_t nextNMICycle() const;
+        [[nodiscard]] bool takeNMI();
+        /* The CPU cycle by which the mapper will have raised its scanline IRQ, or UINT64_MAX if it
+         * won't. Assumes the PPU registers stay as they are, so it has to be asked again after they
+         * or the mapper change. When the A12 rises can't be predicted this is the start of the next
+         * scanline instead, so the PPU is caught up and asked again once per scanline.
+         */
+        [[nodiscard]] uint64_t nextMapperIRQCycle() const;
+
         uint8_t readPPUStatus();
         uint8_t readOAMData();
         uint8_t readPPUData();
 
+        // Write-only registers read back whatever was last driven onto the PPU's data bus
+        uint8_t readIOLatch();
+        void writeIOLatch(uint8_t t_value);
+
         void writePPUCTRL(uint8_t t_value);
         void writePPUMask(uint8_t t_value);
         void writeOAMAddress(uint8_t t_value);
@@ -40,8 +68,23 @@ namespace RNES::PPU {
         void writePPUData(uint8_t t_value);
 
         void writeOAMByte(uint8_t t_index, uint8_t t_value);
-
-        [[nodiscard]] SDL_Surface* getScreenOutput();
+        void writeOAMDMA(std::span<const Word, OAM_SIZE> t_page);
+
+        /* Pixels are drawn straight into caller-owned memory of OUTPUT_WIDTH * OUTPUT_HEIGHT pixels,
+         * each packed as R | G << 8 | B << 16 | A << 24. With no buffer set nothing is drawn, but
+         * everything the CPU can observe (sprite 0 hits, mapper IRQs) still happens.
+         */
+        void setFrameBuffer(std::span<uint32_t> t_frameBuffer);
+        [[nodiscard]] std::span<const uint32_t> getFrameBuffer() const;
+        // Instead of the frame buffer, one byte a pixel holding its 6-bit colour index, for consumers
+        // that apply a palette themselves or not at all
+        void setIndexBuffer(std::span<uint8_t> t_indexBuffer);
+
+        // Everything but the frame buffer, including the memory map
+        void saveState(StateWriter& t_writer) const;
+        void loadState(StateReader& t_reader);
+        // Shares t_source's nametables and CHR-RAM copy-on-write, ahead of loading its state
+        void shareMemoryWith(const PPU& t_source);
     private:
         std::array<Word, OAM_SIZE> m_oam;
         std::unique_ptr<PPUMemoryMap> m_controller;
@@ -77,7 +120,10 @@ namespace RNES::PPU {
         } m_registers;
 
         size_t m_lastUpdatedCycle;
-        size_t m_currentCycle;
+        size_t m_currentCycle; // dots since power on
+
+        uint8_t m_ioLatch;
+        bool m_nmiPending;
 
         struct Sprite {
             uint8_t x, y;
@@ -91,23 +137,37 @@ namespace RNES::PPU {
         };
         std::array<Sprite, SPRITE_COUNT> m_sprites{};
 
-        SurfaceWrapper m_outputSurface;
+        /* Mappers such as the MMC3 count scanlines by watching PPU address line A12. With the usual
+         * pattern table setup the rising edge lands on a fixed dot every scanline, so it is reported
+         * directly on that dot. Other setups fall back to checking A12 on every pattern fetch.
+         */
+        size_t m_a12RiseDot;
+        bool m_a12High;
+        size_t m_a12LowSinceCycle;
+
+        std::span<uint32_t> m_frameBuffer;
+        std::span<uint8_t> m_indexBuffer;
 
         //----- Helpers -----//
         void loadSprites();
 
-        uint8_t getTileIndex(size_t t_coarseXScroll, size_t t_coarseYScroll);
+        // t_nametable is the nametable select from v, 0 = $2000 to 3 = $2C00
+        uint8_t getTileIndex(size_t t_nametable, size_t t_coarseXScroll, size_t t_coarseYScroll);
         uint8_t getPaletteIndex(size_t t_baseAddress, size_t t_tileIndex, size_t t_tileX, size_t t_tileY);
-        size_t getPalette(size_t t_x, size_t t_y);
-        RGBAPixel getColour(size_t t_palette, size_t t_paletteIndex);
+        size_t getPalette(size_t t_nametable, size_t t_coarseXScroll, size_t t_coarseYScroll);
+        uint8_t getColourIndex(size_t t_palette, size_t t_paletteIndex);
 
         struct SpritePixelData {
             size_t spriteIndex;
             size_t paletteIndex;
         };
-        SpritePixelData findTopSpritePixelData(size_t t_x, size_t t_y);
+        // Only the first t_spriteCount sprites in OAM are considered
+        SpritePixelData findTopSpritePixelData(size_t t_x, size_t t_y, size_t t_spriteCount);
 
         void incrementScroll(size_t t_scanline, size_t t_scanlineCycle);
+
+        [[nodiscard]] size_t findA12RiseDot() const;
+        void trackA12(size_t t_address);
     };
 
 }
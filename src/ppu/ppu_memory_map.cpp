@@ -15,9 +15,8 @@ namespace RNES::PPU {
     Word PPUMemoryMap::readWord(Address t_address) {
         if (t_address < 0x2000) {
             return m_chrMap->readWord(t_address);
-        } else if (t_address < 0x3EFF) {
-            // TODO: allow for different mirroring modes
-            return m_internalVRam[(t_address - 0x2000) % 0x1000];
+        } else if (t_address < 0x3F00) {
+            return m_internalVRam.read(getNametableIndex(t_address));
         } else if (t_address < 0x4000) {
             return m_paletteRamIndexes[(t_address - 0x3F00) % 0x20];
         } else {
@@ -28,12 +27,56 @@ namespace RNES::PPU {
     void PPUMemoryMap::writeWord(RNES::Address t_address, RNES::Word t_value) {
         if (t_address < 0x2000) {
             m_chrMap->writeWord(t_address, t_value);
-        } else if (t_address < 0x3EFF) {
-            // TODO: allow for different mirroring modes
-            m_internalVRam[(t_address - 0x2000) % 0x1000] = t_value;
+        } else if (t_address < 0x3F00) {
+            m_internalVRam.write(getNametableIndex(t_address), t_value);
         } else if (t_address < 0x4000) {
             m_paletteRamIndexes[(t_address - 0x3F00) % 0x20] = t_value;
         }
     }
 
+    size_t PPUMemoryMap::getNametableIndex(Address t_address) const {
+        // $3000-$3EFF mirror $2000-$2EFF
+        const size_t offset = (t_address - 0x2000) % 0x1000;
+        const size_t table = offset / NAMETABLE_SIZE;
+
+        size_t physicalTable = table;
+        switch (m_chrMap->getMirroring()) {
+            case Mirroring::HORIZONTAL:
+                physicalTable = table / 2;
+                break;
+            case Mirroring::VERTICAL:
+                physicalTable = table % 2;
+                break;
+            case Mirroring::FOUR_SCREEN:
+                break;
+        }
+
+        return physicalTable * NAMETABLE_SIZE + (offset % NAMETABLE_SIZE);
+    }
+
+    void PPUMemoryMap::clockScanlineCounter() {
+        m_chrMap->clockScanlineCounter();
+    }
+
+    std::optional<size_t> PPUMemoryMap::getClocksUntilIRQ() const {
+        return m_chrMap->getClocksUntilIRQ();
+    }
+
+    void PPUMemoryMap::saveState(StateWriter& t_writer) const {
+        m_internalVRam.saveState(t_writer);
+        t_writer.bytes(m_paletteRamIndexes);
+        m_chrMap->saveState(t_writer);
+    }
+
+    void PPUMemoryMap::loadState(StateReader& t_reader) {
+        m_internalVRam.loadState(t_reader);
+        t_reader.bytes(m_paletteRamIndexes);
+        m_chrMap->loadState(t_reader);
+    }
+
+    void PPUMemoryMap::shareMemoryWith(const PPUMemoryMap& t_source) {
+        m_internalVRam = t_source.m_internalVRam;
+        m_chrMap->shareMemoryWith(*t_source.m_chrMap);
+    }
+
 }
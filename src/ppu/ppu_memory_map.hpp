@@ -4,6 +4,7 @@
 #include <array>
 #include <memory>
 
+#include "copy_on_write_memory.hpp"
 #include "defines.hpp"
 #include "ppu/chr_map.hpp"
 
@@ -17,8 +18,23 @@ namespace RNES::PPU {
         Word readWord(Address t_address);
         void writeWord(Address t_address, Word t_value);
 
+        void clockScanlineCounter();
+        [[nodiscard]] std::optional<size_t> getClocksUntilIRQ() const;
+
+        // Nametables, palette and the cartridge's CHR side
+        void saveState(StateWriter& t_writer) const;
+        void loadState(StateReader& t_reader);
+
+        // Shares the nametables and the cartridge's CHR-RAM, as CPUMemoryMap::shareMemoryWith()
+        void shareMemoryWith(const PPUMemoryMap& t_source);
+
     private:
-        std::array<Word, 0x1000> m_internalVRam;
+        static const size_t NAMETABLE_SIZE = 0x0400;
+
+        // Where a $2000-$3EFF address lands in m_internalVRam under the cartridge's mirroring
+        [[nodiscard]] size_t getNametableIndex(Address t_address) const;
+
+        CopyOnWriteMemory<0x1000> m_internalVRam; // room for four nametables, though most games use two
         std::array<Word, 0x20> m_paletteRamIndexes;
         std::unique_ptr<CHRMap> m_chrMap;
     };
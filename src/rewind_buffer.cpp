@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <cstring>
+
+#include "assert.hpp"
+#include "rewind_buffer.hpp"
+
+namespace RNES {
+
+    // Unchanged runs shorter than this are cheaper to keep inside a changed run than to encode separately
+    static const size_t MIN_UNCHANGED_RUN = 4;
+
+    // Sixteen bytes in one vector register, as in apu/simd.hpp
+    using Byte16 = uint8_t __attribute__((vector_size(16)));
+
+    static void xorBytes(const uint8_t* t_a, const uint8_t* t_b, uint8_t* t_output, size_t t_size) {
+        size_t i = 0;
+        for (; i + sizeof(Byte16) <= t_size; i += sizeof(Byte16)) {
+            Byte16 a;
+            Byte16 b;
+            std::memcpy(&a, t_a + i, sizeof(a));
+            std::memcpy(&b, t_b + i, sizeof(b));
+
+            const Byte16 result = a ^ b;
+            std::memcpy(t_output + i, &result, sizeof(result));
+        }
+
+        for (; i < t_size; i++) {
+            t_output[i] = t_a[i] ^ t_b[i];
+        }
+    }
+
+    static bool anyBits(Byte16 t_value) {
+        uint64_t halves[2];
+        std::memcpy(halves, &t_value, sizeof(halves));
+        return (halves[0] | halves[1]) != 0;
+    }
+
+    // Index of the first byte at or after t_index where the two differ, comparing 32 bytes at a time
+    static size_t skipEqual(const uint8_t* t_a, const uint8_t* t_b, size_t t_size, size_t t_index) {
+        while (t_index + 2 * sizeof(Byte16) <= t_size) {
+            Byte16 a[2];
+            Byte16 b[2];
+            std::memcpy(a, t_a + t_index, sizeof(a));
+            std::memcpy(b, t_b + t_index, sizeof(b));
+
+            if (anyBits((a[0] ^ b[0]) | (a[1] ^ b[1]))) {
+                break;
+            }
+            t_index += 2 * sizeof(Byte16);
+        }
+
+        while (t_index < t_size && t_a[t_index] == t_b[t_index]) {
+            t_index++;
+        }
+        return t_index;
+    }
+
+    // End of the changed run starting at t_index, which is the start of the next long unchanged run
+    static size_t findChangedEnd(const uint8_t* t_a, const uint8_t* t_b, size_t t_size, size_t t_index) {
+        while (t_index < t_size) {
+            if (t_a[t_index] != t_b[t_index]) {
+                t_index++;
+                continue;
+            }
+
+            const size_t equalEnd = skipEqual(t_a, t_b, t_size, t_index);
+            if (equalEnd - t_index >= MIN_UNCHANGED_RUN || equalEnd == t_size) {
+                break;
+            }
+            t_index = equalEnd;
+        }
+        return t_index;
+    }
+
+    static size_t writeVarint(uint8_t* t_output, size_t t_value) {
+        size_t size = 0;
+        while (t_value >= 0x80) {
+            t_output[size++] = static_cast<uint8_t>(t_value | 0x80);
+            t_value >>= 7;
+        }
+        t_output[size++] = static_cast<uint8_t>(t_value);
+        return size;
+    }
+
+    static size_t readVarint(std::span<const uint8_t> t_data, size_t& t_index) {
+        size_t value = 0;
+        for (size_t shift = 0; t_index < t_data.size(); shift += 7) {
+            const uint8_t byte = t_data[t_index++];
+            value |= static_cast<size_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                break;
+            }
+        }
+        return value;
+    }
+
+    RewindBuffer::RewindBuffer(size_t t_stateSize, const RewindOptions& t_options)
+        : m_stateSize(t_stateSize)
+        , m_options(t_options)
+        , m_storage(t_options.memoryBudget)
+        , m_entries()
+        , m_memoryUsed(0)
+        , m_delta(2 * t_stateSize + 16) // alternating single bytes are the worst case, at 1.5x
+        , m_state(t_stateSize)
+    {
+        ASSERT(m_options.memoryBudget >= 2 * m_stateSize, "Rewind budget can't hold two states");
+        ASSERT(m_options.keyframeInterval > 0, "Keyframe interval must be at least 1");
+    }
+
+    void RewindBuffer::push(std::span<const uint8_t> t_state) {
+        ASSERT(t_state.size() == m_stateSize, "State is the wrong size");
+
+        if (!m_entries.empty() && m_entries.back().sinceKeyframe + 1 < m_options.keyframeInterval) {
+            const Entry previous = m_entries.back();
+            const size_t size = encodeDelta(t_state, std::span<const uint8_t>(m_storage).subspan(previous.keyframeOffset, m_stateSize));
+            const size_t offset = allocate(size);
+
+            // Making room may have dropped the keyframe as well, in which case this becomes one
+            if (!m_entries.empty()) {
+                std::memcpy(m_storage.data() + offset, m_delta.data(), size);
+                m_entries.push_back({ offset, size, previous.keyframeOffset, previous.sinceKeyframe + 1 });
+                m_memoryUsed += size;
+                return;
+            }
+        }
+
+        const size_t offset = allocate(m_stateSize);
+        std::memcpy(m_storage.data() + offset, t_state.data(), m_stateSize);
+        m_entries.push_back({ offset, m_stateSize, offset, 0 });
+        m_memoryUsed += m_stateSize;
+    }
+
+    bool RewindBuffer::pop(std::span<uint8_t> t_state) {
+        ASSERT(t_state.size() == m_stateSize, "State is the wrong size");
+        if (m_entries.empty()) {
+            return false;
+        }
+
+        const Entry entry = m_entries.back();
+        m_entries.pop_back();
+        m_memoryUsed -= entry.size;
+
+        std::memcpy(t_state.data(), m_storage.data() + entry.keyframeOffset, m_stateSize);
+        if (entry.sinceKeyframe > 0) {
+            decodeDelta(std::span<const uint8_t>(m_storage).subspan(entry.offset, entry.size), t_state);
+        }
+        return true;
+    }
+
+    void RewindBuffer::push(const Console& t_console) {
+        const auto written = t_console.saveState(m_state);
+        ASSERT(!written.is_error(), "Console state doesn't match the rewind buffer");
+        push(std::span<const uint8_t>(m_state));
+    }
+
+    bool RewindBuffer::pop(Console& t_console) {
+        if (!pop(std::span<uint8_t>(m_state))) {
+            return false;
+        }
+
+        const auto loaded = t_console.loadState(m_state);
+        ASSERT(!loaded.is_error(), "Console state doesn't match the rewind buffer");
+        return true;
+    }
+
+    void RewindBuffer::clear() {
+        m_entries.clear();
+        m_memoryUsed = 0;
+    }
+
+    size_t RewindBuffer::size() const {
+        return m_entries.size();
+    }
+
+    bool RewindBuffer::empty() const {
+        return m_entries.empty();
+    }
+
+    size_t RewindBuffer::memoryUsed() const {
+        return m_memoryUsed;
+    }
+
+    /* A delta is a list of runs covering the whole state: the number of unchanged bytes, the number
+     * of changed bytes, then the changed bytes XORed with the keyframe. Both counts are LEB128.
+     */
+    size_t RewindBuffer::encodeDelta(std::span<const uint8_t> t_state, std::span<const uint8_t> t_keyframe) {
+        const uint8_t* state = t_state.data();
+        const uint8_t* keyframe = t_keyframe.data();
+
+        // Runs are found by comparing directly, so only the changed bytes are ever XORed
+        size_t size = 0;
+        size_t index = 0;
+        while (index < m_stateSize) {
+            const size_t changedStart = skipEqual(state, keyframe, m_stateSize, index);
+            const size_t changedEnd = findChangedEnd(state, keyframe, m_stateSize, changedStart);
+            const size_t changedCount = changedEnd - changedStart;
+
+            size += writeVarint(m_delta.data() + size, changedStart - index);
+            size += writeVarint(m_delta.data() + size, changedCount);
+            xorBytes(state + changedStart, keyframe + changedStart, m_delta.data() + size, changedCount);
+            size += changedCount;
+
+            index = changedEnd;
+        }
+
+        return size;
+    }
+
+    void RewindBuffer::decodeDelta(std::span<const uint8_t> t_delta, std::span<uint8_t> t_state) {
+        size_t index = 0;
+        size_t position = 0;
+
+        while (index < t_delta.size()) {
+            position += readVarint(t_delta, index);
+            const size_t literalCount = readVarint(t_delta, index);
+
+            xorBytes(t_state.data() + position, t_delta.data() + index, t_state.data() + position, literalCount);
+            position += literalCount;
+            index += literalCount;
+        }
+    }
+
+    size_t RewindBuffer::allocate(size_t t_size) {
+        size_t offset = 0;
+        size_t skippedFrom = m_storage.size();
+        if (!m_entries.empty()) {
+            const Entry& newest = m_entries.back();
+            offset = newest.offset + newest.size;
+
+            // Entries are never split across the end of the ring, so whatever is left past the
+            // newest one is skipped, and has to go before anything at the start can be reused
+            if (offset + t_size > m_storage.size()) {
+                skippedFrom = offset;
+                offset = 0;
+            }
+        }
+
+        // Everything older than the newest entry lies ahead of it in the ring, oldest first
+        while (!m_entries.empty()) {
+            const Entry& oldest = m_entries.front();
+            const bool overlaps = (oldest.offset < offset + t_size) && (offset < oldest.offset + oldest.size);
+            if (!overlaps && oldest.offset < skippedFrom) {
+                break;
+            }
+            dropOldest();
+        }
+
+        return offset;
+    }
+
+    void RewindBuffer::dropOldest() {
+        // Deltas are useless without their keyframe, so they go with it
+        do {
+            m_memoryUsed -= m_entries.front().size;
+            m_entries.pop_front();
+        } while (!m_entries.empty() && m_entries.front().sinceKeyframe > 0);
+    }
+
+}
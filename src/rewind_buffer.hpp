@@ -0,0 +1,78 @@
+#ifndef RNES_REWIND_BUFFER_INCLUDED
+#define RNES_REWIND_BUFFER_INCLUDED
+
+#include <deque>
+#include <span>
+#include <vector>
+
+#include "console.hpp"
+#include "defines.hpp"
+
+namespace RNES {
+
+    struct RewindOptions {
+        // Total memory for stored states. The oldest are dropped to stay inside it.
+        size_t memoryBudget = 32 * 1024 * 1024;
+        // States between two full copies. Longer intervals compress better but start slower.
+        size_t keyframeInterval = 60;
+    };
+
+    /* The last few minutes of save states, usually one per frame, for stepping backwards in time.
+     *
+     * Every keyframeInterval-th state is stored whole. The ones in between are XORed against their
+     * keyframe, which leaves zeros everywhere but the bytes that changed since, and the zero runs are
+     * run-length encoded. A frame usually changes a few hundred bytes out of ~15KB, so most states
+     * cost well under 1KB. Decoding only needs the keyframe, so stepping back costs the same at any
+     * distance from it.
+     *
+     * Keyframes and the deltas that depend on them are dropped together, oldest first, when the
+     * budget runs out. Nothing is allocated after construction except the small index of states.
+     */
+    class RewindBuffer {
+    public:
+        RewindBuffer(size_t t_stateSize, const RewindOptions& t_options = {});
+
+        void push(std::span<const uint8_t> t_state);
+        // Removes the newest state and writes it to t_state. Returns false if there are none.
+        [[nodiscard]] bool pop(std::span<uint8_t> t_state);
+
+        // Shortcuts for saving the console's state and loading it back
+        void push(const Console& t_console);
+        [[nodiscard]] bool pop(Console& t_console);
+
+        void clear();
+
+        [[nodiscard]] size_t size() const;
+        [[nodiscard]] bool empty() const;
+        [[nodiscard]] size_t memoryUsed() const;
+
+    private:
+        struct Entry {
+            size_t offset; // into m_storage
+            size_t size;
+            size_t keyframeOffset;
+            size_t sinceKeyframe; // 0 for keyframes
+        };
+
+        // Encodes into m_delta and returns the encoded size
+        [[nodiscard]] size_t encodeDelta(std::span<const uint8_t> t_state, std::span<const uint8_t> t_keyframe);
+        static void decodeDelta(std::span<const uint8_t> t_delta, std::span<uint8_t> t_state);
+
+        // Finds room for t_size bytes after the newest entry, dropping the oldest ones in the way
+        [[nodiscard]] size_t allocate(size_t t_size);
+        void dropOldest();
+
+        size_t m_stateSize;
+        RewindOptions m_options;
+
+        std::vector<uint8_t> m_storage; // a ring of encoded states
+        std::deque<Entry> m_entries; // oldest first
+        size_t m_memoryUsed;
+
+        std::vector<uint8_t> m_delta; // scratch for encoding
+        std::vector<uint8_t> m_state; // scratch for the console shortcuts
+    };
+
+}
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef RNES_SAVE_STATE_INCLUDED
+#define RNES_SAVE_STATE_INCLUDED
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#include "assert.hpp"
+#include "defines.hpp"
+
+namespace RNES {
+
+    /* Save states are a flat little endian blob with no padding or per-field tags. Components write
+     * their fields in a fixed order and read them back in the same order, so each component's
+     * saveState() and loadState() have to be kept in step, and any change to either needs a new
+     * STATE_VERSION in console.cpp.
+     *
+     * The buffer is sized and checked once up front by Console, so individual writes and reads only
+     * assert that they stay inside it.
+     */
+    class StateWriter {
+    public:
+        explicit StateWriter(std::span<uint8_t> t_buffer) : m_buffer(t_buffer), m_index(0), m_measuring(false) {
+            ;
+        }
+
+        // A writer that only counts the bytes that would be written
+        [[nodiscard]] static StateWriter measure() {
+            StateWriter writer({});
+            writer.m_measuring = true;
+            return writer;
+        }
+
+        // Integers, bools and enums, as the width of their underlying type
+        template<typename T>
+        void value(T t_value) {
+            if constexpr (std::is_enum_v<T>) {
+                value(static_cast<std::underlying_type_t<T>>(t_value));
+            }
+            else if constexpr (std::is_same_v<T, bool>) {
+                value(static_cast<uint8_t>(t_value));
+            }
+            else {
+                static_assert(std::is_integral_v<T>, "Only integers can be written");
+                if (m_measuring) {
+                    m_index += sizeof(T);
+                    return;
+                }
+
+                ASSERT(m_index + sizeof(T) <= m_buffer.size(), "Save state buffer overrun");
+                if constexpr (std::endian::native == std::endian::little) {
+                    std::memcpy(m_buffer.data() + m_index, &t_value, sizeof(T));
+                }
+                else {
+                    for (size_t i = 0; i < sizeof(T); i++) {
+                        m_buffer[m_index + i] = static_cast<uint8_t>(t_value >> (8 * i));
+                    }
+                }
+                m_index += sizeof(T);
+            }
+        }
+
+        void bytes(std::span<const uint8_t> t_bytes) {
+            if (!m_measuring) {
+                ASSERT(m_index + t_bytes.size() <= m_buffer.size(), "Save state buffer overrun");
+                std::memcpy(m_buffer.data() + m_index, t_bytes.data(), t_bytes.size());
+            }
+            m_index += t_bytes.size();
+        }
+
+        [[nodiscard]] size_t position() const {
+            return m_index;
+        }
+
+    private:
+        std::span<uint8_t> m_buffer;
+        size_t m_index;
+        bool m_measuring;
+    };
+
+    class StateReader {
+    public:
+        explicit StateReader(std::span<const uint8_t> t_buffer) : m_buffer(t_buffer), m_index(0) {
+            ;
+        }
+
+        template<typename T>
+        void value(T& t_value) {
+            if constexpr (std::is_enum_v<T>) {
+                std::underlying_type_t<T> raw{};
+                value(raw);
+                t_value = static_cast<T>(raw);
+            }
+            else if constexpr (std::is_same_v<T, bool>) {
+                uint8_t raw = 0;
+                value(raw);
+                t_value = (raw != 0);
+            }
+            else {
+                static_assert(std::is_integral_v<T>, "Only integers can be read");
+                ASSERT(m_index + sizeof(T) <= m_buffer.size(), "Save state buffer overrun");
+
+                if constexpr (std::endian::native == std::endian::little) {
+                    std::memcpy(&t_value, m_buffer.data() + m_index, sizeof(T));
+                }
+                else {
+                    t_value = 0;
+                    for (size_t i = 0; i < sizeof(T); i++) {
+                        t_value |= static_cast<T>(m_buffer[m_index + i]) << (8 * i);
+                    }
+                }
+                m_index += sizeof(T);
+            }
+        }
+
+        void bytes(std::span<uint8_t> t_bytes) {
+            ASSERT(m_index + t_bytes.size() <= m_buffer.size(), "Save state buffer overrun");
+            std::memcpy(t_bytes.data(), m_buffer.data() + m_index, t_bytes.size());
+            m_index += t_bytes.size();
+        }
+
+        // The next t_size bytes in place, for readers that want to compare before copying
+        [[nodiscard]] std::span<const uint8_t> view(size_t t_size) {
+            ASSERT(m_index + t_size <= m_buffer.size(), "Save state buffer overrun");
+            const auto result = m_buffer.subspan(m_index, t_size);
+            m_index += t_size;
+            return result;
+        }
+
+        [[nodiscard]] size_t position() const {
+            return m_index;
+        }
+
+    private:
+        std::span<const uint8_t> m_buffer;
+        size_t m_index;
+    };
+
+}
+
+#endif
@@ -0,0 +1,53 @@
+#include <algorithm>
+
+#include "scheduler.hpp"
+
+namespace RNES {
+
+    Scheduler::Scheduler() : m_currentCycle(0), m_nextEventCycle(NO_EVENT), m_pendingStall(0), m_eventCycles() {
+        m_eventCycles.fill(NO_EVENT);
+    }
+
+    void Scheduler::schedule(Event t_event, uint64_t t_cycle) {
+        m_eventCycles[static_cast<size_t>(t_event)] = t_cycle;
+        updateNextEvent();
+    }
+
+    void Scheduler::cancel(Event t_event) {
+        schedule(t_event, NO_EVENT);
+    }
+
+    std::optional<Event> Scheduler::popDueEvent() {
+        if (m_nextEventCycle > m_currentCycle) {
+            return std::nullopt;
+        }
+
+        const auto it = std::min_element(m_eventCycles.begin(), m_eventCycles.end());
+        const Event event = static_cast<Event>(it - m_eventCycles.begin());
+
+        cancel(event);
+        return event;
+    }
+
+    void Scheduler::updateNextEvent() {
+        m_nextEventCycle = *std::min_element(m_eventCycles.begin(), m_eventCycles.end());
+    }
+
+    void Scheduler::saveState(StateWriter& t_writer) const {
+        t_writer.value(m_currentCycle);
+        t_writer.value(m_pendingStall);
+        for (const uint64_t cycle : m_eventCycles) {
+            t_writer.value(cycle);
+        }
+    }
+
+    void Scheduler::loadState(StateReader& t_reader) {
+        t_reader.value(m_currentCycle);
+        t_reader.value(m_pendingStall);
+        for (uint64_t& cycle : m_eventCycles) {
+            t_reader.value(cycle);
+        }
+        updateNextEvent();
+    }
+
+}
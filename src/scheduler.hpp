@@ -0,0 +1,74 @@
+#ifndef RNES_SCHEDULER_INCLUDED
+#define RNES_SCHEDULER_INCLUDED
+
+#include <array>
+#include <optional>
+#include <utility>
+
+#include "defines.hpp"
+#include "save_state.hpp"
+
+namespace RNES {
+
+    enum class Event : size_t {
+        APU_IRQ,
+        DMC_FETCH,
+        PPU_NMI,
+        MAPPER_IRQ,
+
+        COUNT
+    };
+    constexpr size_t EVENT_COUNT = static_cast<size_t>(Event::COUNT);
+
+    constexpr uint64_t NO_EVENT = UINT64_MAX;
+
+    /* The master clock, counted in CPU cycles, and the times of upcoming events. Components that
+     * are emulated lazily schedule an event for the next time they can affect the CPU, so the main
+     * loop only has to compare against nextEventCycle() after each instruction.
+     */
+    class Scheduler {
+    public:
+        Scheduler();
+
+        [[nodiscard]] uint64_t now() const {
+            return m_currentCycle;
+        }
+
+        void setCurrentCycle(uint64_t t_cycle) {
+            m_currentCycle = t_cycle;
+        }
+
+        [[nodiscard]] uint64_t nextEventCycle() const {
+            return m_nextEventCycle;
+        }
+
+        // Cycles the CPU loses to DMA, charged to it once the current instruction finishes
+        void stall(uint64_t t_cycles) {
+            m_pendingStall += t_cycles;
+        }
+
+        [[nodiscard]] uint64_t takeStallCycles() {
+            return std::exchange(m_pendingStall, 0);
+        }
+
+        void schedule(Event t_event, uint64_t t_cycle);
+        void cancel(Event t_event);
+
+        // Removes and returns the earliest event that is due, if there is one
+        [[nodiscard]] std::optional<Event> popDueEvent();
+
+        void saveState(StateWriter& t_writer) const;
+        void loadState(StateReader& t_reader);
+
+    private:
+        void updateNextEvent();
+
+        uint64_t m_currentCycle;
+        uint64_t m_nextEventCycle;
+        uint64_t m_pendingStall;
+        std::array<uint64_t, EVENT_COUNT> m_eventCycles;
+    };
+
+}
+
+#endif
@@ -0,0 +1,200 @@
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include "console.hpp"
+#include "mapper/mapper.hpp"
+#include "output/video_sink.hpp"
+#include "ppu/ppu.hpp"
+#include "shm_server/rnes_shm.h"
+
+static_assert(offsetof(rnes_shm, ram) % 64 == 0, "RAM should start on a cache line");
+static_assert(offsetof(rnes_shm, frame) % 64 == 0, "The picture should start on a cache line");
+static_assert(RNES_SHM_FRAME_WIDTH == RNES::PPU::OUTPUT_WIDTH && RNES_SHM_FRAME_HEIGHT == RNES::PPU::OUTPUT_HEIGHT, "Picture size mismatch");
+static_assert(RNES_SHM_RAM_SIZE == decltype(std::declval<const RNES::Console&>().getRAM())::extent, "RAM size mismatch");
+
+// Idle waits wake up this often, in case a signal landed just before one started
+static const timespec STOP_CHECK_INTERVAL = { 1, 0 };
+
+static std::atomic<bool> s_stopRequested = false;
+static_assert(std::atomic<bool>::is_always_lock_free, "The stop flag is set from a signal handler");
+
+static void requestStop(int) {
+    s_stopRequested.store(true, std::memory_order_relaxed);
+}
+
+static std::atomic_ref<uint32_t> atomicWord(uint32_t& t_word) {
+    return std::atomic_ref<uint32_t>(t_word);
+}
+
+// Tells the client the step t_request is over, whether it ran or the server is going away
+static void completeStep(rnes_shm& t_shm, uint32_t t_request) {
+    atomicWord(t_shm.step_done).store(t_request, std::memory_order_release);
+    syscall(SYS_futex, &t_shm.step_done, FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+
+static ErrorOr<std::unique_ptr<RNES::Console>> powerOn(const std::shared_ptr<const RNES::Mapper::ROMImage>& t_rom, rnes_shm& t_shm) {
+    std::unique_ptr<RNES::Console> console = TRY(RNES::Console::fromImage(t_rom));
+    console->setVideoSink(std::make_unique<RNES::Output::IndexedVideoSink>(std::span<uint8_t>(t_shm.frame)));
+    return console;
+}
+
+// Creates the region, replacing one left behind by a server that's no longer running
+static int createRegion(const char* t_name) {
+    const int fd = shm_open(t_name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd >= 0 || errno != EEXIST) {
+        return fd;
+    }
+
+    // Servers write their pid as soon as the region is mapped, so a region without one is stale too
+    uint32_t pid = 0;
+    const int existing = shm_open(t_name, O_RDONLY, 0);
+    struct stat info {};
+    if (existing >= 0 && fstat(existing, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(rnes_shm)) {
+        const void* data = mmap(nullptr, sizeof(rnes_shm), PROT_READ, MAP_SHARED, existing, 0);
+        if (data != MAP_FAILED) {
+            pid = static_cast<const rnes_shm*>(data)->server_pid;
+            munmap(const_cast<void*>(data), sizeof(rnes_shm));
+        }
+    }
+    if (existing >= 0) {
+        close(existing);
+    }
+
+    if (pid != 0 && (kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM)) {
+        std::cerr << "Shared memory " << t_name << " is in use by process " << pid << "\n";
+        errno = EEXIST;
+        return -1;
+    }
+
+    std::cerr << "Replacing stale shared memory " << t_name << "\n";
+    shm_unlink(t_name);
+    return shm_open(t_name, O_CREAT | O_EXCL | O_RDWR, 0600);
+}
+
+/* Runs a ROM for an agent in another process, through a POSIX shared memory region laid out as in
+ * rnes_shm.h. Each step holds the client's actions for frame_skip frames and draws only the last,
+ * straight into the shared picture as colour indices, so observations cost the client nothing to
+ * read. RAM is copied out at the end of each step, as it's only 2KB. SIGINT and SIGTERM stop the
+ * server between steps, and the region is unlinked on the way out.
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 3 || argc > 4) {
+        std::cerr << "Usage: <rom_path> <shm_name> [frame_skip]" << std::endl;
+        return 1;
+    }
+
+    auto romOrError = RNES::Mapper::loadROMImage(argv[1]);
+    if (romOrError.is_error()) {
+        std::cerr << "Failed to load ROM (error " << romOrError.get_error().getErrorCode() << ")\n";
+        return EXIT_FAILURE;
+    }
+    const auto rom = romOrError.get_value();
+    const uint64_t frameSkip = std::max<uint64_t>((argc == 4) ? std::stoull(argv[3]) : 1, 1);
+
+    const int fd = createRegion(argv[2]);
+    if (fd < 0) {
+        std::cerr << "Failed to create shared memory " << argv[2] << "\n";
+        return EXIT_FAILURE;
+    }
+    if (ftruncate(fd, sizeof(rnes_shm)) != 0) {
+        close(fd);
+        shm_unlink(argv[2]);
+        std::cerr << "Failed to size shared memory " << argv[2] << "\n";
+        return EXIT_FAILURE;
+    }
+    void* data = mmap(nullptr, sizeof(rnes_shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        shm_unlink(argv[2]);
+        std::cerr << "Failed to map shared memory\n";
+        return EXIT_FAILURE;
+    }
+    rnes_shm& shm = *static_cast<rnes_shm*>(data);
+    shm.server_pid = static_cast<uint32_t>(getpid());
+
+    // Without SA_RESTART, so that a signal also cuts an idle wait short
+    struct sigaction stopAction {};
+    stopAction.sa_handler = requestStop;
+    sigemptyset(&stopAction.sa_mask);
+    sigaction(SIGINT, &stopAction, nullptr);
+    sigaction(SIGTERM, &stopAction, nullptr);
+
+    auto consoleOrError = powerOn(rom, shm);
+    if (consoleOrError.is_error()) {
+        shm_unlink(argv[2]);
+        std::cerr << "Failed to create console (error " << consoleOrError.get_error().getErrorCode() << ")\n";
+        return EXIT_FAILURE;
+    }
+    std::unique_ptr<RNES::Console> console = std::move(consoleOrError).get_value();
+
+    // New mappings are zeroed, so only the identification is left, and it goes last
+    shm.version = RNES_SHM_VERSION;
+    std::memcpy(shm.ram, console->getRAM().data(), RNES_SHM_RAM_SIZE);
+    atomicWord(shm.magic).store(RNES_SHM_MAGIC, std::memory_order_release);
+
+    std::cout << "Serving " << argv[1] << " on " << argv[2] << std::endl;
+    int status = 0;
+    uint32_t done = 0;
+    while (true) {
+        // Sleeps only while there's nothing new, so a request made before the wait isn't missed
+        uint32_t request = 0;
+        while ((request = atomicWord(shm.step_request).load(std::memory_order_acquire)) == done && !s_stopRequested.load(std::memory_order_relaxed)) {
+            syscall(SYS_futex, &shm.step_request, FUTEX_WAIT, done, &STOP_CHECK_INTERVAL, nullptr, 0);
+        }
+        if (s_stopRequested.load(std::memory_order_relaxed)) {
+            std::cout << "Stopping" << std::endl;
+            break;
+        }
+
+        const uint32_t flags = atomicWord(shm.flags).exchange(0, std::memory_order_acq_rel);
+        if (flags & RNES_SHM_QUIT) {
+            completeStep(shm, request);
+            break;
+        }
+
+        if (flags & RNES_SHM_RESET) {
+            auto resetOrError = powerOn(rom, shm);
+            if (resetOrError.is_error()) {
+                std::cerr << "Failed to reset the console (error " << resetOrError.get_error().getErrorCode() << ")\n";
+                status = EXIT_FAILURE;
+                completeStep(shm, request);
+                break;
+            }
+            console = std::move(resetOrError).get_value();
+        }
+
+        for (size_t port = 0; port < 2; port++) {
+            console->setInput(port, shm.actions[port]);
+        }
+        for (uint64_t i = 1; i < frameSkip; i++) {
+            console->skipFrame();
+        }
+        console->runFrame();
+
+        std::memcpy(shm.ram, console->getRAM().data(), RNES_SHM_RAM_SIZE);
+        shm.frame_count = console->getFrameCount();
+        shm.cycle_count = console->getCycleCount();
+
+        done = request;
+        completeStep(shm, done);
+    }
+
+    munmap(data, sizeof(rnes_shm));
+    shm_unlink(argv[2]);
+    return status;
+}
@@ -0,0 +1,100 @@
+#ifndef RNES_SHM_H_INCLUDED
+#define RNES_SHM_H_INCLUDED
+
+/* The shared memory channel of shm_server, for clients in C or anything that can call C. Linux only,
+ * as the handshake uses futexes.
+ *
+ * The server creates the region under a POSIX shared memory name and sets magic and version once
+ * everything else is ready. A client writes the buttons for both controllers into actions, then
+ * calls rnes_shm_step(), which returns once the server has run a step. The picture, RAM and counters
+ * then describe the end of that step, and stay put until the next one. Everything else in the
+ * region belongs to the server.
+ *
+ * The server unlinks the region when it quits or is interrupted. One left behind by a server that
+ * died is replaced by the next server started under the same name.
+ */
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define RNES_SHM_MAGIC 0x4D48534EU /* "NSHM" when read as little endian */
+#define RNES_SHM_VERSION 2U
+
+#define RNES_SHM_FRAME_WIDTH 256
+#define RNES_SHM_FRAME_HEIGHT 240
+#define RNES_SHM_RAM_SIZE 0x0800
+
+/* Flags for the next step, cleared by the server once it has seen them */
+#define RNES_SHM_RESET 0x1U /* power cycle before running the step */
+#define RNES_SHM_QUIT 0x2U /* stop the server instead of running the step */
+
+struct rnes_shm {
+    uint32_t magic;
+    uint32_t version;
+
+    /* The client bumps step_request to ask for a step, and the server sets step_done to match
+     * when it's finished. Both are futex words. */
+    uint32_t step_request;
+    uint32_t step_done;
+
+    uint32_t flags;
+    uint8_t actions[2]; /* bit 0 = A, then B, Select, Start, Up, Down, Left, Right */
+    uint8_t reserved0[2];
+
+    uint64_t frame_count;
+    uint64_t cycle_count;
+    uint32_t server_pid; /* so a later server can tell whether this region is still in use */
+    uint8_t reserved1[20];
+
+    uint8_t ram[RNES_SHM_RAM_SIZE];
+    /* The 6-bit NES colour index of each pixel, drawn here directly by the emulator. Clients that
+     * want colours apply a palette of their own. */
+    uint8_t frame[RNES_SHM_FRAME_HEIGHT * RNES_SHM_FRAME_WIDTH];
+};
+
+/* Maps the server's region, or returns NULL if it doesn't exist or isn't ready */
+static inline struct rnes_shm* rnes_shm_open(const char* name) {
+    const int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    void* data = mmap(NULL, sizeof(struct rnes_shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+
+    struct rnes_shm* shm = (struct rnes_shm*)data;
+    if (__atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) != RNES_SHM_MAGIC || shm->version != RNES_SHM_VERSION) {
+        munmap(data, sizeof(struct rnes_shm));
+        return NULL;
+    }
+    return shm;
+}
+
+static inline void rnes_shm_close(struct rnes_shm* shm) {
+    munmap(shm, sizeof(struct rnes_shm));
+}
+
+/* Runs one step with the current actions and flags, and waits for it to finish */
+static inline void rnes_shm_step(struct rnes_shm* shm) {
+    const uint32_t request = __atomic_load_n(&shm->step_request, __ATOMIC_RELAXED) + 1;
+    __atomic_store_n(&shm->step_request, request, __ATOMIC_RELEASE);
+    syscall(SYS_futex, &shm->step_request, FUTEX_WAKE, 1, NULL, NULL, 0);
+
+    while (1) {
+        const uint32_t done = __atomic_load_n(&shm->step_done, __ATOMIC_ACQUIRE);
+        if (done == request) {
+            return;
+        }
+        syscall(SYS_futex, &shm->step_done, FUTEX_WAIT, done, NULL, NULL, 0);
+    }
+}
+
+#endif
@@ -0,0 +1,106 @@
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "console.hpp"
+#include "hash.hpp"
+#include "test_rom.hpp"
+#include "batch/batch_runner.hpp"
+#include "mapper/mapper.hpp"
+
+/* Jobs run by BatchRunner have to end exactly where the same input played on one console at a time
+ * ends, however many workers share them out and steal from each other. The ROM folds the first
+ * controller into RAM all the time, so every job's input shows in its RAM hash, and the jobs are of
+ * very different lengths so that workers run out and steal.
+ */
+static const size_t JOB_COUNT = 12;
+static const std::array<size_t, 3> THREAD_COUNTS = { 1, 3, 8 };
+
+static const std::array<uint8_t, 30> PROGRAM = {
+    0xA9, 0x01,             // E000  LDA #$01
+    0x8D, 0x16, 0x40,       // E002  STA $4016
+    0xA9, 0x00,             // E005  LDA #$00
+    0x8D, 0x16, 0x40,       // E007  STA $4016
+    0xA2, 0x08,             // E00A  LDX #$08
+    0xAD, 0x16, 0x40,       // E00C  LDA $4016
+    0x4A,                   // E00F  LSR A
+    0x26, 0x00,             // E010  ROL $00
+    0xCA,                   // E012  DEX
+    0xD0, 0xF7,             // E013  BNE $E00C
+    0xA5, 0x00,             // E015  LDA $00
+    0x65, 0x01,             // E017  ADC $01
+    0x85, 0x01,             // E019  STA $01
+    0x4C, 0x00, 0xE0,       // E01B  JMP $E000
+};
+
+// The same job on a console of its own, without the runner
+static RNES::Batch::JobResult runSerially(const RNES::Batch::Job& t_job) {
+    auto console = RNES::Console::fromImage(t_job.rom).get_value();
+    for (uint64_t frame = 0; frame < t_job.frameCount; frame++) {
+        const RNES::InputFrame input = (frame < t_job.input.size()) ? t_job.input[frame] : RNES::InputFrame{};
+        for (size_t port = 0; port < input.size(); port++) {
+            console->setInput(port, input[port]);
+        }
+        console->runFrame();
+    }
+
+    RNES::Batch::JobResult result{};
+    result.frameCount = console->getFrameCount();
+    result.cycleCount = console->getCycleCount();
+    result.ramHash = RNES::hash64(console->getRAM());
+    return result;
+}
+
+int main() {
+    auto romOrError = RNES::Mapper::loadROMImage(RNES::Test::makeTestROM(0, PROGRAM, {}));
+    if (romOrError.is_error()) {
+        std::cerr << "Failed to load the ROM (error " << romOrError.get_error().getErrorCode() << ")\n";
+        return EXIT_FAILURE;
+    }
+    const auto rom = romOrError.get_value();
+
+    // Some jobs run past the end of their input, which holds no buttons
+    std::mt19937 random(11);
+    std::vector<RNES::Batch::Job> jobs(JOB_COUNT);
+    for (RNES::Batch::Job& job : jobs) {
+        job.rom = rom;
+        job.frameCount = 10 + random() % 40;
+        job.input.resize(job.frameCount - random() % 10);
+        for (RNES::InputFrame& input : job.input) {
+            input = { static_cast<uint8_t>(random()), static_cast<uint8_t>(random()) };
+        }
+    }
+
+    std::vector<RNES::Batch::JobResult> expected;
+    for (const RNES::Batch::Job& job : jobs) {
+        expected.push_back(runSerially(job));
+    }
+
+    for (size_t threadCount : THREAD_COUNTS) {
+        const RNES::Batch::BatchRunner runner({ .threadCount = threadCount });
+        const RNES::Batch::BatchResult result = runner.run(jobs);
+
+        uint64_t frames = 0;
+        for (size_t i = 0; i < jobs.size(); i++) {
+            const RNES::Batch::JobResult& job = result.jobs[i];
+            if (job.error.has_value() || job.frameCount != expected[i].frameCount || job.cycleCount != expected[i].cycleCount
+                    || job.ramHash != expected[i].ramHash) {
+                std::cerr << "Job " << i << " with " << threadCount << " threads ended at frame " << job.frameCount
+                          << ", cycle " << job.cycleCount << ", RAM hash " << job.ramHash << ", expected frame "
+                          << expected[i].frameCount << ", cycle " << expected[i].cycleCount << ", RAM hash " << expected[i].ramHash << "\n";
+                return EXIT_FAILURE;
+            }
+            frames += jobs[i].frameCount;
+        }
+
+        if (result.emulatedFrames != frames || result.restoredFrames != 0) {
+            std::cerr << "With " << threadCount << " threads the batch counted " << result.emulatedFrames << " frames, expected " << frames << "\n";
+            return EXIT_FAILURE;
+        }
+        std::cout << JOB_COUNT << " jobs on " << threadCount << " threads matched the serial runs\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+#ifndef RNES_TEST_ROM_INCLUDED
+#define RNES_TEST_ROM_INCLUDED
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "assert.hpp"
+
+namespace RNES::Test {
+
+    // Where code passed to makeTestROM() ends up. With 16KB of PRG-ROM this is the last 8KB on both
+    // NROM and MMC3, so the same address works for either.
+    static const uint16_t TEST_ROM_CODE_ADDRESS = 0xE000;
+
+    struct TestROMVectors {
+        uint16_t nmi = TEST_ROM_CODE_ADDRESS;
+        uint16_t reset = TEST_ROM_CODE_ADDRESS;
+        uint16_t irq = TEST_ROM_CODE_ADDRESS;
+    };
+
+    /* Builds an iNES file with 16KB of PRG-ROM holding t_code at TEST_ROM_CODE_ADDRESS, and 8KB of
+     * blank CHR-ROM, or CHR-RAM if t_chrRam is set. Horizontal mirroring unless t_verticalMirroring.
+     */
+    inline std::vector<uint8_t> makeTestROM(uint8_t t_mapper, std::span<const uint8_t> t_code, const TestROMVectors& t_vectors,
+                                            bool t_chrRam = false, bool t_verticalMirroring = false) {
+        const size_t prgSize = 0x4000;
+        const size_t chrSize = t_chrRam ? 0 : 0x2000;
+        const size_t codeOffset = TEST_ROM_CODE_ADDRESS - 0xC000;
+        ASSERT(codeOffset + t_code.size() <= prgSize - 6, "Test code is too large");
+
+        std::vector<uint8_t> rom(16 + prgSize + chrSize, 0);
+        rom[0] = 'N';
+        rom[1] = 'E';
+        rom[2] = 'S';
+        rom[3] = 0x1A;
+        rom[4] = prgSize / 0x4000;
+        rom[5] = chrSize / 0x2000;
+        rom[6] = ((t_mapper & 0x0F) << 4) | (t_verticalMirroring ? 0x01 : 0x00);
+        rom[7] = t_mapper & 0xF0;
+
+        uint8_t* prg = rom.data() + 16;
+        std::copy(t_code.begin(), t_code.end(), prg + codeOffset);
+
+        const uint16_t vectors[3] = { t_vectors.nmi, t_vectors.reset, t_vectors.irq };
+        for (size_t i = 0; i < 3; i++) {
+            prg[prgSize - 6 + 2 * i + 0] = vectors[i] & 0xFF;
+            prg[prgSize - 6 + 2 * i + 1] = vectors[i] >> 8;
+        }
+
+        return rom;
+    }
+
+}
+
+#endif
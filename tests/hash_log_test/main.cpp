@@ -0,0 +1,95 @@
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "console.hpp"
+#include "hash_log.hpp"
+#include "test_rom.hpp"
+
+/* A hash log that is written and loaded again has to give back the ROM hash, whether pictures were
+ * hashed and every frame's hashes, with and without pictures. The ROM changes RAM and the
+ * background colour all the time, so no two states hash the same and a frame read from the wrong
+ * place would show. A frame cut short at the end of the file, as a run that was killed leaves, is
+ * dropped.
+ */
+static const size_t FRAME_COUNT = 120;
+
+static const std::array<uint8_t, 25> PROGRAM = {
+    0xA9, 0x08,             // E000  LDA #$08
+    0x8D, 0x01, 0x20,       // E002  STA $2001
+    0xE6, 0x00,             // E005  INC $00
+    0xA9, 0x3F,             // E007  LDA #$3F
+    0x8D, 0x06, 0x20,       // E009  STA $2006
+    0xA9, 0x00,             // E00C  LDA #$00
+    0x8D, 0x06, 0x20,       // E00E  STA $2006
+    0xA5, 0x00,             // E011  LDA $00
+    0x8D, 0x07, 0x20,       // E013  STA $2007
+    0x4C, 0x05, 0xE0,       // E016  JMP $E005
+};
+
+static bool testLog(const std::vector<uint8_t>& t_rom, bool t_hashPictures) {
+    auto console = RNES::Console::fromBuffer(t_rom).get_value();
+    const std::string path = (std::filesystem::temp_directory_path() / "rnes_hash_log_test.rnh").string();
+
+    RNES::FrameHasher hasher(*console, t_hashPictures);
+    std::vector<RNES::FrameHashes> written;
+    {
+        auto logOrError = RNES::HashLogWriter::open(path.c_str(), console->getROMHash(), t_hashPictures);
+        if (logOrError.is_error()) {
+            std::cerr << "Failed to open " << path << "\n";
+            return false;
+        }
+        auto log = std::move(logOrError).get_value();
+        for (size_t i = 0; i < FRAME_COUNT; i++) {
+            console->runFrame();
+            written.push_back(hasher.hash(*console));
+            log->write(written.back());
+        }
+    }
+
+    // A partial frame at the end is dropped
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) + 5);
+
+    auto loadedOrError = RNES::loadHashLog(path.c_str());
+    std::filesystem::remove(path);
+    if (loadedOrError.is_error()) {
+        std::cerr << "Failed to load " << path << " (error " << loadedOrError.get_error().getErrorCode() << ")\n";
+        return false;
+    }
+    const RNES::HashLog loaded = std::move(loadedOrError).get_value();
+
+    const char* kind = t_hashPictures ? "with pictures" : "without pictures";
+    if (loaded.romHash != console->getROMHash() || loaded.hasPictures != t_hashPictures) {
+        std::cerr << "The header of the log " << kind << " didn't survive\n";
+        return false;
+    }
+    if (loaded.frames != written) {
+        std::cerr << "The log " << kind << " has " << loaded.frames.size() << " frames, expected " << written.size()
+                  << " matching the ones written\n";
+        return false;
+    }
+    for (size_t i = 1; i < written.size(); i++) {
+        if (written[i].state == written[i - 1].state) {
+            std::cerr << "Frames " << (i - 1) << " and " << i << " hash the same " << kind << "\n";
+            return false;
+        }
+        if ((written[i].picture != 0) != t_hashPictures) {
+            std::cerr << "Frame " << i << " has a picture hash of " << written[i].picture << " " << kind << "\n";
+            return false;
+        }
+    }
+
+    std::cout << "Read back " << loaded.frames.size() << " frames " << kind << "\n";
+    return true;
+}
+
+int main() {
+    const auto rom = RNES::Test::makeTestROM(0, PROGRAM, {}, true);
+
+    bool passed = testLog(rom, false);
+    passed &= testLog(rom, true);
+    return passed ? 0 : EXIT_FAILURE;
+}
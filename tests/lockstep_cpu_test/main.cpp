@@ -0,0 +1,327 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "cpu/cpu.hpp"
+#include "cpu/lockstep_cpu.hpp"
+#include "mapper/mapper.hpp"
+#include "save_state.hpp"
+#include "test_rom.hpp"
+
+using RNES::Address;
+using RNES::Word;
+using RNES::CPU::LockstepCPU;
+
+/* LockstepCPU against the scalar CPU. Random programs are run on many lanes at once, each starting
+ * from its own registers and RAM, and every lane is then replayed alone on the scalar CPU. The two
+ * have to agree on registers, RAM, cycle count and why the lane stopped.
+ */
+static const size_t SEED_COUNT = 40;
+static const size_t LANE_COUNT = 37;
+static const uint64_t CYCLE_BUDGET = 20000;
+static const size_t PRG_SIZE = 0x4000;
+static const size_t PROGRAM_END = PRG_SIZE - 0x10;
+static const Address PRG_START = 0x8000;
+
+// Just RAM and PRG ROM, like the lanes. Any other access is noted, so the reference can stop there.
+class TestMemoryMap : public RNES::CPU::CPUMemoryMap {
+public:
+    TestMemoryMap(std::array<Word, LockstepCPU::RAM_SIZE>& t_ram, std::span<const uint8_t> t_prg) : m_ram(t_ram), m_prg(t_prg), m_outside(false) {
+        ;
+    }
+
+    [[nodiscard]] Word readWord(Address t_address) const override {
+        if (t_address < 0x2000) {
+            return m_ram[t_address % LockstepCPU::RAM_SIZE];
+        }
+        if (t_address >= PRG_START) {
+            return m_prg[(t_address - PRG_START) % m_prg.size()];
+        }
+        m_outside = true;
+        return 0;
+    }
+
+    void writeWord(Address t_address, Word t_value) override {
+        if (t_address < 0x2000) {
+            m_ram[t_address % LockstepCPU::RAM_SIZE] = t_value;
+        }
+        else {
+            m_outside = true;
+        }
+    }
+
+    [[nodiscard]] bool takeOutsideAccess() {
+        return std::exchange(m_outside, false);
+    }
+
+private:
+    std::array<Word, LockstepCPU::RAM_SIZE>& m_ram;
+    std::span<const uint8_t> m_prg;
+    mutable bool m_outside;
+};
+
+// The scalar CPU's registers, set and read through its save state, as it has no other way in
+struct ScalarRegisters {
+    LockstepCPU::Registers registers;
+    uint64_t cycle;
+
+    void save(RNES::CPU::CPU& t_cpu) const {
+        std::array<uint8_t, 32> buffer{};
+        RNES::StateWriter writer(buffer);
+        writer.value(registers.pc);
+        writer.value(registers.sp);
+        writer.value(registers.acc);
+        writer.value(registers.x);
+        writer.value(registers.y);
+        writer.value(registers.st);
+        writer.value(cycle);
+        writer.value(false);
+        writer.value(false);
+        writer.value(false);
+
+        RNES::StateReader reader(buffer);
+        t_cpu.loadState(reader);
+    }
+
+    void load(const RNES::CPU::CPU& t_cpu) {
+        std::array<uint8_t, 32> buffer{};
+        RNES::StateWriter writer(buffer);
+        t_cpu.saveState(writer);
+
+        RNES::StateReader reader(buffer);
+        reader.value(registers.pc);
+        reader.value(registers.sp);
+        reader.value(registers.acc);
+        reader.value(registers.x);
+        reader.value(registers.y);
+        reader.value(registers.st);
+        reader.value(cycle);
+    }
+};
+
+/* Random instructions, except BRK so that lanes get somewhere, with most absolute operands in RAM
+ * and every branch and jump landing on an instruction, so that programs run for a while before
+ * wandering off into data.
+ */
+static std::vector<uint8_t> makeProgram(std::mt19937& t_random) {
+    using namespace RNES::CPU;
+
+    std::vector<uint8_t> opcodes;
+    for (size_t opcode = 0; opcode < INSTRUCTION_TABLE.size(); opcode++) {
+        const InstructionId id = INSTRUCTION_TABLE[opcode].id;
+        if (id != InstructionId::NONE && id != InstructionId::BRK) {
+            opcodes.push_back(static_cast<uint8_t>(opcode));
+        }
+    }
+
+    std::vector<uint8_t> program(PROGRAM_END, 0);
+    std::vector<size_t> starts;
+    size_t offset = 0;
+    while (offset + 3 <= PROGRAM_END) {
+        const uint8_t opcode = opcodes[t_random() % opcodes.size()];
+        const AddressMode mode = INSTRUCTION_TABLE[opcode].addressMode;
+        const size_t size = instructionSize(mode);
+
+        starts.push_back(offset);
+        program[offset] = opcode;
+        for (size_t i = 1; i < size; i++) {
+            program[offset + i] = static_cast<uint8_t>(t_random());
+        }
+        if (size == 3) {
+            program[offset + 2] = (mode == AddressMode::INDIRECT || t_random() % 10 != 0) ? t_random() % 8 : 0x80 + t_random() % 0x80;
+        }
+        offset += size;
+    }
+
+    for (size_t i = 0; i < starts.size(); i++) {
+        const size_t start = starts[i];
+        const InstructionInfo& info = INSTRUCTION_TABLE[program[start]];
+
+        if (info.addressMode == AddressMode::RELATIVE) {
+            const size_t first = (i > 40) ? i - 40 : 0;
+            const size_t last = std::min(starts.size() - 1, i + 40);
+            const long distance = static_cast<long>(starts[first + t_random() % (last - first + 1)]) - static_cast<long>(start + 2);
+            if (distance >= -128 && distance <= 127) {
+                program[start + 1] = static_cast<uint8_t>(distance);
+            }
+        }
+        else if (info.id == InstructionId::JSR || (info.id == InstructionId::JMP && info.addressMode == AddressMode::ABSOLUTE)) {
+            const size_t target = PRG_START + starts[t_random() % starts.size()];
+            program[start + 1] = target & 0xFF;
+            program[start + 2] = target >> 8;
+        }
+    }
+
+    return program;
+}
+
+// Runs one lane's start alone on the scalar CPU, stopping where a lane would
+static LockstepCPU::LaneExit runReference(const LockstepCPU::Registers& t_start, std::array<Word, LockstepCPU::RAM_SIZE>& t_ram,
+                                          std::span<const uint8_t> t_prg, ScalarRegisters& t_end) {
+    using namespace RNES::CPU;
+
+    auto memoryMap = std::make_unique<TestMemoryMap>(t_ram, t_prg);
+    TestMemoryMap& memory = *memoryMap;
+    CPU cpu;
+    cpu.setController(std::move(memoryMap));
+
+    t_end = { t_start, 0 };
+    t_end.save(cpu);
+
+    while (t_end.cycle < CYCLE_BUDGET) {
+        const Address pc = t_end.registers.pc;
+        if (pc < PRG_START) {
+            return LockstepCPU::LaneExit::PC_OUTSIDE_ROM;
+        }
+
+        const InstructionInfo& info = INSTRUCTION_TABLE[memory.readWord(pc)];
+        if (info.id == InstructionId::NONE || info.id == InstructionId::BRK) {
+            return LockstepCPU::LaneExit::UNSUPPORTED_INSTRUCTION;
+        }
+        if (pc + instructionSize(info.addressMode) - 1 > 0xFFFF) {
+            return LockstepCPU::LaneExit::PC_OUTSIDE_ROM;
+        }
+
+        // Lanes stop before an instruction that leaves RAM and ROM, so undo it here
+        const auto ram = t_ram;
+        cpu.executeInstruction();
+        if (memory.takeOutsideAccess()) {
+            t_ram = ram;
+            t_end.save(cpu);
+            return LockstepCPU::LaneExit::IO_ACCESS;
+        }
+        t_end.load(cpu);
+    }
+
+    return LockstepCPU::LaneExit::NONE;
+}
+
+/* Taken branches cost a cycle more than ones not taken, including a branch to the very next
+ * instruction, which lands where it would have anyway.
+ */
+static bool testBranchToNextInstruction() {
+    static const std::array<uint8_t, 13> PROGRAM = {
+        0xA2, 0x01,             // 8000  LDX #$01     ; 2
+        0xD0, 0x00,             // 8002  BNE $8004    ; 3, taken
+        0xA2, 0x00,             // 8004  LDX #$00     ; 2
+        0xD0, 0x00,             // 8006  BNE $8008    ; 2, not taken
+        0xF0, 0x00,             // 8008  BEQ $800A    ; 3, taken
+        0x4C, 0x0A, 0x80,       // 800A  JMP $800A
+    };
+    static const size_t INSTRUCTION_COUNT = 5;
+    static const uint64_t EXPECTED_CYCLES = 12;
+    static const Address EXPECTED_PC = 0x800A;
+
+    auto file = RNES::Test::makeTestROM(0, {}, { .nmi = PRG_START, .reset = PRG_START, .irq = PRG_START });
+    std::copy(PROGRAM.begin(), PROGRAM.end(), file.begin() + 16);
+    const auto rom = RNES::Mapper::loadROMImage(std::span<const uint8_t>(file)).get_value();
+    const LockstepCPU::Registers start = { PRG_START, 0xFD, 0, 0, 0, 0x24 };
+
+    std::array<Word, LockstepCPU::RAM_SIZE> ram{};
+    RNES::CPU::CPU cpu;
+    cpu.setController(std::make_unique<TestMemoryMap>(ram, rom->prgRom));
+    ScalarRegisters scalar = { start, 0 };
+    scalar.save(cpu);
+    for (size_t i = 0; i < INSTRUCTION_COUNT; i++) {
+        cpu.executeInstruction();
+    }
+    scalar.load(cpu);
+
+    auto lockstep = LockstepCPU::create(rom, 1).get_value();
+    lockstep->setLane(0, start, ram, 0);
+    lockstep->runUntil(EXPECTED_CYCLES);
+
+    bool passed = true;
+    if (scalar.cycle != EXPECTED_CYCLES || scalar.registers.pc != EXPECTED_PC) {
+        std::cerr << "Scalar CPU: branches to the next instruction took " << scalar.cycle << " cycles, expected " << EXPECTED_CYCLES << "\n";
+        passed = false;
+    }
+    if (lockstep->getCycleCount(0) != EXPECTED_CYCLES || lockstep->getRegisters(0).pc != EXPECTED_PC) {
+        std::cerr << "LockstepCPU: branches to the next instruction took " << lockstep->getCycleCount(0) << " cycles, expected " << EXPECTED_CYCLES << "\n";
+        passed = false;
+    }
+    return passed;
+}
+
+int main() {
+    if (!testBranchToNextInstruction()) {
+        return EXIT_FAILURE;
+    }
+
+    size_t failures = 0;
+    std::array<size_t, 4> exits{};
+
+    for (size_t seed = 0; seed < SEED_COUNT; seed++) {
+        std::mt19937 random(static_cast<std::mt19937::result_type>(seed));
+
+        auto file = RNES::Test::makeTestROM(0, {}, { .nmi = PRG_START, .reset = PRG_START, .irq = PRG_START });
+        const auto program = makeProgram(random);
+        std::copy(program.begin(), program.end(), file.begin() + 16);
+
+        auto romOrError = RNES::Mapper::loadROMImage(std::span<const uint8_t>(file));
+        if (romOrError.is_error()) {
+            std::cerr << "Failed to load ROM (error " << romOrError.get_error().getErrorCode() << ")\n";
+            return EXIT_FAILURE;
+        }
+        const auto rom = romOrError.get_value();
+
+        auto lockstepOrError = LockstepCPU::create(rom, LANE_COUNT);
+        if (lockstepOrError.is_error()) {
+            std::cerr << "Failed to create lanes (error " << lockstepOrError.get_error().getErrorCode() << ")\n";
+            return EXIT_FAILURE;
+        }
+        auto lockstep = std::move(lockstepOrError).get_value();
+
+        std::vector<std::array<Word, LockstepCPU::RAM_SIZE>> rams(LANE_COUNT);
+        std::vector<LockstepCPU::Registers> starts(LANE_COUNT);
+        for (size_t lane = 0; lane < LANE_COUNT; lane++) {
+            // Small values, so that indirect addresses mostly land in RAM
+            for (Word& value : rams[lane]) {
+                value = random() % 4;
+            }
+            // Decimal mode is set on some lanes: it's ignored, but must be kept
+            const Word status = (random() & 0xC7) | ((random() % 8 == 0) ? 0x08 : 0x00);
+            starts[lane] = { PRG_START, static_cast<Word>(random()), static_cast<Word>(random()),
+                             static_cast<Word>(random()), static_cast<Word>(random()), status };
+            lockstep->setLane(lane, starts[lane], rams[lane], 0);
+        }
+
+        lockstep->runUntil(CYCLE_BUDGET);
+
+        for (size_t lane = 0; lane < LANE_COUNT; lane++) {
+            ScalarRegisters expected{};
+            const LockstepCPU::LaneExit expectedExit = runReference(starts[lane], rams[lane], rom->prgRom, expected);
+
+            const LockstepCPU::Registers actual = lockstep->getRegisters(lane);
+            std::array<Word, LockstepCPU::RAM_SIZE> ram{};
+            lockstep->getRAM(lane, ram);
+            exits[static_cast<size_t>(lockstep->getExit(lane))]++;
+
+            const bool registersMatch = actual.pc == expected.registers.pc && actual.sp == expected.registers.sp
+                                        && actual.acc == expected.registers.acc && actual.x == expected.registers.x
+                                        && actual.y == expected.registers.y && actual.st == expected.registers.st;
+            if (!registersMatch || ram != rams[lane] || lockstep->getCycleCount(lane) != expected.cycle || lockstep->getExit(lane) != expectedExit) {
+                std::cerr << std::hex << "Seed " << seed << " lane " << lane << ": pc " << actual.pc << "/" << expected.registers.pc
+                          << " sp " << +actual.sp << "/" << +expected.registers.sp << " a " << +actual.acc << "/" << +expected.registers.acc
+                          << " x " << +actual.x << "/" << +expected.registers.x << " y " << +actual.y << "/" << +expected.registers.y
+                          << " st " << +actual.st << "/" << +expected.registers.st << std::dec
+                          << " cycles " << lockstep->getCycleCount(lane) << "/" << expected.cycle
+                          << " exit " << static_cast<int>(lockstep->getExit(lane)) << "/" << static_cast<int>(expectedExit)
+                          << (ram == rams[lane] ? "" : " RAM differs") << "\n";
+                failures++;
+            }
+        }
+    }
+
+    std::cout << SEED_COUNT * LANE_COUNT << " lanes: " << exits[0] << " ran out of cycles, " << exits[1] << " I/O, "
+              << exits[2] << " unsupported, " << exits[3] << " left ROM\n";
+    if (failures != 0) {
+        std::cerr << failures << " lanes differ from the scalar CPU\n";
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <array>
+#include <cstdlib>
+#include <iostream>
+
+#include "console.hpp"
+#include "test_rom.hpp"
+
+/* An MMC3 game with an IRQ every 8 scanlines and nothing else going on: NMIs and the APU frame IRQ
+ * are off and the main loop never touches the PPU. The IRQ handler counts into $0000-$0001. Only
+ * the scheduled mapper IRQ can bring the PPU up to date here, so a missed one shows up as about
+ * one IRQ per frame instead of one per 8 of the 241 rendered scanlines.
+ */
+static const std::array<uint8_t, 0x30> PROGRAM = {
+    0x78,                   // E000  SEI
+    0xD8,                   // E001  CLD
+    0xA2, 0xFF,             // E002  LDX #$FF
+    0x9A,                   // E004  TXS
+    0xA9, 0x40,             // E005  LDA #$40
+    0x8D, 0x17, 0x40,       // E007  STA $4017    ; no APU frame IRQ
+    0xA9, 0x08,             // E00A  LDA #$08
+    0x8D, 0x00, 0x20,       // E00C  STA $2000    ; sprites at $1000, so A12 rises on dot 260
+    0xA9, 0x18,             // E00F  LDA #$18
+    0x8D, 0x01, 0x20,       // E011  STA $2001    ; rendering on
+    0xA9, 0x07,             // E014  LDA #$07
+    0x8D, 0x00, 0xC0,       // E016  STA $C000    ; IRQ latch
+    0x8D, 0x01, 0xC0,       // E019  STA $C001    ; reload
+    0x8D, 0x01, 0xE0,       // E01C  STA $E001    ; IRQs on
+    0x58,                   // E01F  CLI
+    0x4C, 0x20, 0xE0,       // E020  JMP $E020
+
+    0xE6, 0x00,             // E023  INC $00      ; IRQ handler
+    0xD0, 0x02,             // E025  BNE $E029
+    0xE6, 0x01,             // E027  INC $01
+    0x8D, 0x00, 0xE0,       // E029  STA $E000    ; acknowledge
+    0x8D, 0x01, 0xE0,       // E02C  STA $E001    ; and turn IRQs back on
+    0x40,                   // E02F  RTI
+};
+
+static const uint16_t IRQ_HANDLER = 0xE023;
+
+static const size_t WARMUP_FRAMES = 4;
+static const size_t MEASURED_FRAMES = 60;
+
+static unsigned readCount(const RNES::Console& t_console) {
+    return t_console.getRAM()[0] | (t_console.getRAM()[1] << 8);
+}
+
+int main() {
+    RNES::Test::TestROMVectors vectors;
+    vectors.irq = IRQ_HANDLER;
+    const auto rom = RNES::Test::makeTestROM(4, PROGRAM, vectors);
+
+    auto consoleOrError = RNES::Console::fromBuffer(rom);
+    if (consoleOrError.is_error()) {
+        std::cerr << "Failed to create console (error " << consoleOrError.get_error().getErrorCode() << ")\n";
+        return EXIT_FAILURE;
+    }
+    auto console = std::move(consoleOrError).get_value();
+
+    for (size_t i = 0; i < WARMUP_FRAMES; i++) {
+        console->skipFrame();
+    }
+    const unsigned start = readCount(*console);
+    for (size_t i = 0; i < MEASURED_FRAMES; i++) {
+        console->skipFrame();
+    }
+    const unsigned count = readCount(*console) - start;
+
+    // A reload clock plus 7 more per IRQ, over the 241 scanlines that clock the counter each frame
+    const double perFrame = static_cast<double>(count) / MEASURED_FRAMES;
+    std::cout << count << " IRQs in " << MEASURED_FRAMES << " frames, " << perFrame << " per frame\n";
+
+    if (perFrame < 29.5 || perFrame > 30.5) {
+        std::cerr << "Expected about " << (241.0 / 8.0) << " IRQs per frame\n";
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
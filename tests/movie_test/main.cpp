@@ -0,0 +1,140 @@
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "console.hpp"
+#include "movie.hpp"
+#include "test_rom.hpp"
+
+/* A movie that is saved and loaded again has to hold the same ROM hash and the same input for
+ * every frame, and replaying it has to leave the console exactly where the recording did. The ROM
+ * reads the first controller all the time and folds what it reads into RAM, so any frame played
+ * with the wrong buttons changes the state. Files that are cut short or made for another ROM are
+ * refused.
+ */
+static const size_t FRAME_COUNT = 300;
+
+static const std::array<uint8_t, 30> PROGRAM = {
+    0xA9, 0x01,             // E000  LDA #$01
+    0x8D, 0x16, 0x40,       // E002  STA $4016
+    0xA9, 0x00,             // E005  LDA #$00
+    0x8D, 0x16, 0x40,       // E007  STA $4016
+    0xA2, 0x08,             // E00A  LDX #$08
+    0xAD, 0x16, 0x40,       // E00C  LDA $4016
+    0x4A,                   // E00F  LSR A
+    0x26, 0x00,             // E010  ROL $00
+    0xCA,                   // E012  DEX
+    0xD0, 0xF7,             // E013  BNE $E00C
+    0xA5, 0x00,             // E015  LDA $00
+    0x65, 0x01,             // E017  ADC $01
+    0x85, 0x01,             // E019  STA $01
+    0x4C, 0x00, 0xE0,       // E01B  JMP $E000
+};
+
+static std::string tempPath(const char* t_name) {
+    return (std::filesystem::temp_directory_path() / t_name).string();
+}
+
+static std::vector<uint8_t> saveState(const RNES::Console& t_console) {
+    std::vector<uint8_t> state(t_console.getStateSize());
+    (void)t_console.saveState(state);
+    return state;
+}
+
+int main() {
+    const auto rom = RNES::Test::makeTestROM(0, PROGRAM, {});
+    auto recordingOrError = RNES::Console::fromBuffer(rom);
+    if (recordingOrError.is_error()) {
+        std::cerr << "Failed to create console (error " << recordingOrError.get_error().getErrorCode() << ")\n";
+        return EXIT_FAILURE;
+    }
+    auto recording = std::move(recordingOrError).get_value();
+
+    // Buttons change every few frames, as a player's would
+    std::mt19937 random(3);
+    RNES::Movie movie(recording->getROMHash());
+    RNES::InputFrame input = {};
+    for (uint64_t frame = 0; frame < FRAME_COUNT; frame++) {
+        if (random() % 4 == 0) {
+            input = { static_cast<uint8_t>(random()), static_cast<uint8_t>(random()) };
+        }
+        movie.record(frame, input);
+        movie.apply(*recording);
+        recording->runFrame();
+    }
+    const std::vector<uint8_t> recorded = saveState(*recording);
+
+    const std::string path = tempPath("rnes_movie_test.rnm");
+    if (movie.save(path.c_str()).is_error()) {
+        std::cerr << "Failed to save " << path << "\n";
+        return EXIT_FAILURE;
+    }
+
+    auto loadedOrError = RNES::Movie::load(path.c_str());
+    if (loadedOrError.is_error()) {
+        std::cerr << "Failed to load " << path << " (error " << loadedOrError.get_error().getErrorCode() << ")\n";
+        return EXIT_FAILURE;
+    }
+    const RNES::Movie loaded = std::move(loadedOrError).get_value();
+
+    if (loaded.getROMHash() != movie.getROMHash() || loaded.getFrameCount() != movie.getFrameCount()) {
+        std::cerr << "The loaded movie has " << loaded.getFrameCount() << " frames for ROM " << loaded.getROMHash()
+                  << ", expected " << movie.getFrameCount() << " for " << movie.getROMHash() << "\n";
+        return EXIT_FAILURE;
+    }
+    for (uint64_t frame = 0; frame < FRAME_COUNT; frame++) {
+        if (loaded.getInput(frame) != movie.getInput(frame)) {
+            std::cerr << "The loaded movie has the wrong input on frame " << frame << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Replaying the loaded movie ends where the recording did
+    auto playback = RNES::Console::fromBuffer(rom).get_value();
+    if (loaded.checkROM(*playback).is_error()) {
+        std::cerr << "The loaded movie doesn't match its own ROM\n";
+        return EXIT_FAILURE;
+    }
+    for (uint64_t frame = 0; frame < FRAME_COUNT; frame++) {
+        loaded.apply(*playback);
+        playback->runFrame();
+    }
+    if (saveState(*playback) != recorded) {
+        std::cerr << "Replaying the loaded movie ended in a different state\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "Replayed " << FRAME_COUNT << " frames from " << path << "\n";
+
+    // Which only means something if the input mattered
+    auto idle = RNES::Console::fromBuffer(rom).get_value();
+    for (uint64_t frame = 0; frame < FRAME_COUNT; frame++) {
+        idle->runFrame();
+    }
+    if (saveState(*idle) == recorded) {
+        std::cerr << "The input made no difference to the state\n";
+        return EXIT_FAILURE;
+    }
+
+    // Another ROM is refused
+    auto otherROM = rom;
+    otherROM[16] ^= 0xFF; // PRG-ROM that is never run
+    if (!loaded.checkROM(*RNES::Console::fromBuffer(otherROM).get_value()).is_error()) {
+        std::cerr << "A movie for another ROM was accepted\n";
+        return EXIT_FAILURE;
+    }
+
+    // A file cut short is refused
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    const auto truncated = RNES::Movie::load(path.c_str());
+    std::filesystem::remove(path);
+    if (!truncated.is_error()) {
+        std::cerr << "A movie that was cut short was loaded\n";
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
@@ -2,6 +2,8 @@
 #include <fstream>
 #include <vector>
 
+#include "SDL.h"
+
 #include "assert.hpp"
 #include "test_chr_map.hpp"
 #include "ppu/ppu.hpp"
@@ -61,10 +63,14 @@ int main(int argc, char* argv[]) {
 
     RNES::PPU::PPU ppu(std::move(ppuController), oamDumpArr);
 
+    std::vector<uint32_t> frameBuffer(RNES::PPU::OUTPUT_WIDTH * RNES::PPU::OUTPUT_HEIGHT, 0);
+    ppu.setFrameBuffer(frameBuffer);
+
     for (size_t i = 0; i < 341 * 241; i++) {
         ppu.cycle();
     }
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, ppu.getScreenOutput());
+    SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, RNES::PPU::OUTPUT_WIDTH, RNES::PPU::OUTPUT_HEIGHT);
+    SDL_UpdateTexture(texture, nullptr, frameBuffer.data(), RNES::PPU::OUTPUT_WIDTH * sizeof(uint32_t));
     SDL_RenderCopy(renderer, texture, nullptr, nullptr);
     SDL_RenderPresent(renderer);
     SDL_DestroyTexture(texture);
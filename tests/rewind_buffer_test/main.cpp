@@ -0,0 +1,243 @@
+#include <array>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "console.hpp"
+#include "rewind_buffer.hpp"
+#include "test_rom.hpp"
+
+/* RewindBuffer has to give back exactly what was pushed, newest first, whatever the deltas look
+ * like and however many times the ring has wrapped. States here are made up so that every kind of
+ * delta turns up: a few bytes changed, runs at either end, gaps too short to split a run, bytes
+ * that alternate, no change at all and a whole new state. Budgets only hold a handful of states,
+ * so keyframes and their deltas are evicted all the time, and entries of very different sizes
+ * meet at the end of the ring.
+ */
+static const size_t STATE_SIZE = 1000;
+static const size_t KEYFRAME_INTERVAL = 8;
+
+// Small states, intervals and budgets, picked at random, so that the ring wraps in every way
+static const size_t RING_SEEDS = 200;
+static const size_t OPERATIONS = 2000;
+
+static std::vector<uint8_t> nextState(const std::vector<uint8_t>& t_previous, std::mt19937& t_random) {
+    std::vector<uint8_t> state = t_previous;
+    switch (t_random() % 8) {
+        case 0: // nothing changed
+            break;
+        case 1: // a whole new state
+            for (uint8_t& byte : state) {
+                byte = static_cast<uint8_t>(t_random());
+            }
+            break;
+        case 2: // both ends
+            state.front() ^= 0x01;
+            state.back() ^= 0x80;
+            break;
+        case 3: // every other byte, the worst case for runs
+            for (size_t i = t_random() % 2; i < state.size(); i += 2) {
+                state[i]++;
+            }
+            break;
+        case 4: { // changes with short unchanged gaps between them
+            const size_t start = t_random() % (state.size() - 64);
+            for (size_t i = start; i < start + 64; i += 1 + t_random() % 4) {
+                state[i] = static_cast<uint8_t>(t_random());
+            }
+            break;
+        }
+        default: // a few scattered bytes, as most frames do
+            for (size_t i = 0; i < 1 + t_random() % 16; i++) {
+                state[t_random() % state.size()]++;
+            }
+            break;
+    }
+    return state;
+}
+
+static bool testRing(std::mt19937::result_type t_seed, size_t& t_evicted) {
+    std::mt19937 random(t_seed);
+    const size_t stateSize = 100 + random() % 200;
+    const RNES::RewindOptions options = { .memoryBudget = 2 * stateSize + random() % (6 * stateSize), .keyframeInterval = 1 + random() % 6 };
+    RNES::RewindBuffer buffer(stateSize, options);
+
+    // What the buffer should hold, oldest first
+    std::deque<std::vector<uint8_t>> expected;
+    std::vector<uint8_t> state(stateSize, 0);
+    std::vector<uint8_t> popped(stateSize);
+    size_t pushes = 0;
+    size_t pops = 0;
+
+    for (size_t i = 0; i < OPERATIONS; i++) {
+        // Mostly forwards, with stretches of rewinding, as a player would
+        if (random() % 4 != 0 || expected.empty()) {
+            state = nextState(state, random);
+            buffer.push(state);
+            expected.push_back(state);
+            pushes++;
+
+            // Evicting only ever drops the oldest states, and never the one just pushed
+            if (buffer.size() > expected.size() || buffer.empty()) {
+                std::cerr << "Seed " << t_seed << ": push " << pushes << " left " << buffer.size() << " states\n";
+                return false;
+            }
+            t_evicted += expected.size() - buffer.size();
+            while (expected.size() > buffer.size()) {
+                expected.pop_front();
+            }
+        }
+        else {
+            if (!buffer.pop(popped)) {
+                std::cerr << "Seed " << t_seed << ": pop " << pops << " found nothing, expected " << expected.size() << " states\n";
+                return false;
+            }
+            if (popped != expected.back()) {
+                std::cerr << "Seed " << t_seed << ": pop " << pops << " gave back the wrong state\n";
+                return false;
+            }
+            expected.pop_back();
+            pops++;
+
+            // Carry on from the state that was rewound to
+            state = popped;
+        }
+
+        if (buffer.memoryUsed() > options.memoryBudget) {
+            std::cerr << "Seed " << t_seed << ": using " << buffer.memoryUsed() << " bytes of a " << options.memoryBudget << " byte budget\n";
+            return false;
+        }
+    }
+
+    // Everything left comes back in order, and then nothing
+    while (!expected.empty()) {
+        if (!buffer.pop(popped) || popped != expected.back()) {
+            std::cerr << "Seed " << t_seed << ": draining gave back the wrong state with " << expected.size() << " left\n";
+            return false;
+        }
+        expected.pop_back();
+    }
+    if (buffer.pop(popped) || !buffer.empty() || buffer.memoryUsed() != 0) {
+        std::cerr << "Seed " << t_seed << ": the buffer isn't empty after popping everything\n";
+        return false;
+    }
+    return true;
+}
+
+static bool testRings() {
+    size_t evicted = 0;
+    for (size_t seed = 0; seed < RING_SEEDS; seed++) {
+        if (!testRing(static_cast<std::mt19937::result_type>(seed), evicted)) {
+            return false;
+        }
+    }
+
+    std::cout << RING_SEEDS << " rings, " << evicted << " states evicted\n";
+    return evicted > 0;
+}
+
+/* A wrap that has to skip past an older group still left at the end of the ring. With a budget of
+ * 202 bytes and 100 byte states, the 102 byte delta at the end doesn't fit after its keyframe, and
+ * can only go at the start once the group at the end has been dropped, along with everything it
+ * would overwrite there.
+ */
+static bool testWrapPastOlderGroup() {
+    const size_t stateSize = 100;
+    RNES::RewindBuffer buffer(stateSize, { .memoryBudget = 2 * stateSize + 2, .keyframeInterval = 2 });
+
+    std::vector<std::vector<uint8_t>> states(6, std::vector<uint8_t>(stateSize, 0));
+    states[2][0] = 1;
+    states[3][0] = 1;
+    states[4][0] = 2;
+    for (size_t i = 0; i < stateSize; i++) {
+        states[5][i] = static_cast<uint8_t>(~states[4][i]);
+    }
+
+    for (const auto& state : states) {
+        buffer.push(state);
+    }
+
+    if (buffer.empty()) {
+        std::cerr << "Wrapping past an older group dropped the newest state\n";
+        return false;
+    }
+
+    std::vector<uint8_t> popped(stateSize);
+    for (size_t i = states.size(); buffer.pop(popped); i--) {
+        if (i == 0 || popped != states[i - 1]) {
+            std::cerr << "Wrapping past an older group corrupted state " << (i - 1) << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Small changes are stored as deltas against the keyframe, well under a state each
+static bool testCompression() {
+    std::mt19937 random(7);
+    RNES::RewindBuffer buffer(STATE_SIZE, { .memoryBudget = 64 * STATE_SIZE, .keyframeInterval = KEYFRAME_INTERVAL });
+
+    std::vector<uint8_t> state(STATE_SIZE, 0);
+    for (size_t i = 0; i < KEYFRAME_INTERVAL; i++) {
+        state[random() % STATE_SIZE]++;
+        buffer.push(state);
+    }
+
+    const size_t deltaBytes = buffer.memoryUsed() - STATE_SIZE;
+    std::cout << KEYFRAME_INTERVAL - 1 << " deltas of a few bytes take " << deltaBytes << " bytes\n";
+    if (deltaBytes > (KEYFRAME_INTERVAL - 1) * STATE_SIZE / 10) {
+        std::cerr << "Deltas aren't being compressed\n";
+        return false;
+    }
+    return true;
+}
+
+// The console shortcuts, with a real state
+static bool testConsole() {
+    static const std::array<uint8_t, 5> PROGRAM = {
+        0xE6, 0x00,             // E000  INC $00
+        0x4C, 0x00, 0xE0,       // E002  JMP $E000
+    };
+    const auto rom = RNES::Test::makeTestROM(0, PROGRAM, {});
+
+    auto consoleOrError = RNES::Console::fromBuffer(rom);
+    if (consoleOrError.is_error()) {
+        std::cerr << "Failed to create console (error " << consoleOrError.get_error().getErrorCode() << ")\n";
+        return false;
+    }
+    auto console = std::move(consoleOrError).get_value();
+
+    RNES::RewindBuffer buffer(console->getStateSize(), { .memoryBudget = 4 * console->getStateSize(), .keyframeInterval = 4 });
+    std::vector<std::vector<uint8_t>> states;
+    for (size_t i = 0; i < 20; i++) {
+        console->runFrame();
+        buffer.push(*console);
+
+        states.emplace_back(console->getStateSize());
+        (void)console->saveState(states.back());
+    }
+
+    std::vector<uint8_t> state(console->getStateSize());
+    size_t popped = 0;
+    while (buffer.pop(*console)) {
+        (void)console->saveState(state);
+        if (state != states[states.size() - 1 - popped]) {
+            std::cerr << "The console was rewound to the wrong state after " << popped << " frames\n";
+            return false;
+        }
+        popped++;
+    }
+
+    std::cout << "Rewound the console " << popped << " frames\n";
+    return popped > 0;
+}
+
+int main() {
+    bool passed = testRings();
+    passed &= testWrapPastOlderGroup();
+    passed &= testCompression();
+    passed &= testConsole();
+    return passed ? 0 : EXIT_FAILURE;
+}
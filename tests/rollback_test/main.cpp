@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "console.hpp"
+#include "hash.hpp"
+#include "test_rom.hpp"
+#include "netplay/rollback_session.hpp"
+#include "netplay/transport.hpp"
+#include "output/video_sink.hpp"
+
+/* Both sides of a rollback session over a LoopbackTransport have to end in the same state, and in
+ * the state of a console that was simply given both players' input every frame, however many
+ * guesses were wrong along the way. The ROM folds both controllers into RAM all the time, so any
+ * frame left with the wrong input would show. Buttons change every few frames and the link is slow
+ * enough that guesses go wrong, so the sessions really do roll back.
+ */
+static const uint64_t FRAME_COUNT = 120;
+static const auto LATENCY = std::chrono::milliseconds(20);
+static const size_t MAX_ROLLBACK_FRAMES = 4;
+
+static const std::array<uint8_t, 42> PROGRAM = {
+    0xA9, 0x01,             // E000  LDA #$01
+    0x8D, 0x16, 0x40,       // E002  STA $4016
+    0xA9, 0x00,             // E005  LDA #$00
+    0x8D, 0x16, 0x40,       // E007  STA $4016
+    0xA2, 0x08,             // E00A  LDX #$08
+    0xAD, 0x16, 0x40,       // E00C  LDA $4016
+    0x4A,                   // E00F  LSR A
+    0x26, 0x00,             // E010  ROL $00
+    0xAD, 0x17, 0x40,       // E012  LDA $4017
+    0x4A,                   // E015  LSR A
+    0x26, 0x01,             // E016  ROL $01
+    0xCA,                   // E018  DEX
+    0xD0, 0xF1,             // E019  BNE $E00C
+    0xA5, 0x00,             // E01B  LDA $00
+    0x65, 0x02,             // E01D  ADC $02
+    0x85, 0x02,             // E01F  STA $02
+    0xA5, 0x01,             // E021  LDA $01
+    0x65, 0x03,             // E023  ADC $03
+    0x85, 0x03,             // E025  STA $03
+    0x4C, 0x00, 0xE0,       // E027  JMP $E000
+};
+
+static uint64_t hashState(const RNES::Console& t_console) {
+    std::vector<uint8_t> state(t_console.getStateSize());
+    (void)t_console.saveState(state);
+    return RNES::hash64(state);
+}
+
+int main() {
+    const auto rom = RNES::Test::makeTestROM(0, PROGRAM, {});
+
+    auto [first, second] = RNES::Netplay::LoopbackTransport::createPair(LATENCY);
+    std::unique_ptr<RNES::Netplay::Transport> transports[2] = { std::move(first), std::move(second) };
+
+    std::array<std::unique_ptr<RNES::Console>, 2> consoles;
+    std::array<std::unique_ptr<RNES::Netplay::RollbackSession>, 2> sessions;
+    for (size_t i = 0; i < 2; i++) {
+        auto consoleOrError = RNES::Console::fromBuffer(rom);
+        if (consoleOrError.is_error()) {
+            std::cerr << "Failed to create console (error " << consoleOrError.get_error().getErrorCode() << ")\n";
+            return EXIT_FAILURE;
+        }
+        consoles[i] = std::move(consoleOrError).get_value();
+        consoles[i]->setVideoSink(std::make_unique<RNES::Output::NullVideoSink>());
+
+        RNES::Netplay::RollbackOptions options;
+        options.localPort = i;
+        options.maxRollbackFrames = MAX_ROLLBACK_FRAMES;
+        sessions[i] = std::make_unique<RNES::Netplay::RollbackSession>(*consoles[i], std::move(transports[i]), options);
+    }
+
+    // Each player's buttons for every frame, changing every few frames
+    std::mt19937 random(9);
+    std::array<std::vector<uint8_t>, 2> buttons;
+    for (std::vector<uint8_t>& player : buttons) {
+        player.resize(FRAME_COUNT);
+        for (uint64_t frame = 0; frame < FRAME_COUNT; frame++) {
+            player[frame] = (frame % 8 == 0) ? static_cast<uint8_t>(random()) : player[frame - 1];
+        }
+    }
+
+    const auto finished = [&](auto t_done) {
+        return std::all_of(sessions.begin(), sessions.end(), t_done);
+    };
+    while (!finished([](const auto& t_session) { return t_session->getFrame() >= FRAME_COUNT; })) {
+        bool advanced = false;
+        for (size_t i = 0; i < 2; i++) {
+            if (sessions[i]->getFrame() < FRAME_COUNT) {
+                advanced |= sessions[i]->advanceFrame(buttons[i][sessions[i]->getFrame()]);
+            }
+            else {
+                sessions[i]->poll();
+            }
+        }
+        if (!advanced) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    // Settles the last frames, which were still guesses
+    while (!finished([](const auto& t_session) { return t_session->getConfirmedFrame() >= t_session->getFrame(); })) {
+        for (auto& session : sessions) {
+            session->poll();
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    auto reference = RNES::Console::fromBuffer(rom).get_value();
+    reference->setVideoSink(std::make_unique<RNES::Output::NullVideoSink>());
+    for (uint64_t frame = 0; frame < FRAME_COUNT; frame++) {
+        for (size_t port = 0; port < 2; port++) {
+            reference->setInput(port, buttons[port][frame]);
+        }
+        reference->runFrame();
+    }
+
+    bool passed = true;
+    for (size_t i = 0; i < 2; i++) {
+        std::cout << "Player " << (i + 1) << " rolled back " << sessions[i]->getRollbackCount() << " times, resimulating "
+                  << sessions[i]->getResimulatedFrameCount() << " frames\n";
+        if (hashState(*consoles[i]) != hashState(*reference)) {
+            std::cerr << "Player " << (i + 1) << " ended in a different state from the reference\n";
+            passed = false;
+        }
+    }
+
+    if (sessions[0]->getRollbackCount() + sessions[1]->getRollbackCount() == 0) {
+        std::cerr << "Neither side rolled back, so nothing was tested\n";
+        passed = false;
+    }
+
+    return passed ? 0 : EXIT_FAILURE;
+}
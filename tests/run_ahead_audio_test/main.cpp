@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "console.hpp"
+#include "output/audio_sink.hpp"
+#include "test_rom.hpp"
+
+/* Run-ahead, skipped frames and loaded states must not be heard. The DMC is set to a constant level
+ * and left there, so the audio settles to silence once the filters have taken out the offset, and
+ * any step in level when synthesis restarts shows up as a click. Runs with run-ahead have to play
+ * exactly the same samples as one without.
+ */
+static const std::array<uint8_t, 8> PROGRAM = {
+    0xA9, 0x7F,             // E000  LDA #$7F
+    0x8D, 0x11, 0x40,       // E002  STA $4011    ; DMC output level, held from here on
+    0x4C, 0x05, 0xE0,       // E005  JMP $E005
+};
+
+static const size_t SETTLE_FRAMES = 120;
+static const size_t COMPARED_FRAMES = 60;
+// Well below the step of a DMC level of $7F, which is in the thousands
+static const int MAX_SILENCE = 64;
+
+struct Run {
+    std::unique_ptr<RNES::Console> console;
+    RNES::Output::BufferAudioSink* audio;
+};
+
+static Run powerOn(std::span<const uint8_t> t_rom, size_t t_runAhead) {
+    auto consoleOrError = RNES::Console::fromBuffer(t_rom);
+    if (consoleOrError.is_error()) {
+        std::cerr << "Failed to create console (error " << consoleOrError.get_error().getErrorCode() << ")\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    Run run{ std::move(consoleOrError).get_value(), nullptr };
+    auto sink = std::make_unique<RNES::Output::BufferAudioSink>();
+    run.audio = sink.get();
+    run.console->setAudioSink(std::move(sink));
+    run.console->setRunAhead(t_runAhead);
+    return run;
+}
+
+static int loudest(std::span<const int16_t> t_samples) {
+    int result = 0;
+    for (const int16_t sample : t_samples) {
+        result = std::max(result, std::abs(static_cast<int>(sample)));
+    }
+    return result;
+}
+
+// Settles, then plays the frames to compare
+static std::vector<int16_t> play(Run& t_run) {
+    for (size_t i = 0; i < SETTLE_FRAMES; i++) {
+        t_run.console->runFrame();
+    }
+    t_run.audio->clear();
+
+    for (size_t i = 0; i < COMPARED_FRAMES; i++) {
+        t_run.console->runFrame();
+    }
+    const auto samples = t_run.audio->getSamples();
+    return { samples.begin(), samples.end() };
+}
+
+int main() {
+    const auto rom = RNES::Test::makeTestROM(0, PROGRAM, {});
+    bool passed = true;
+
+    Run plain = powerOn(rom, 0);
+    const std::vector<int16_t> expected = play(plain);
+    std::cout << "Without run-ahead: " << expected.size() << " samples, loudest " << loudest(expected) << "\n";
+    if (expected.empty() || loudest(expected) > MAX_SILENCE) {
+        std::cerr << "A constant level doesn't settle to silence\n";
+        passed = false;
+    }
+
+    for (size_t runAhead = 1; runAhead <= 2; runAhead++) {
+        Run run = powerOn(rom, runAhead);
+        const std::vector<int16_t> samples = play(run);
+        std::cout << "Run-ahead " << runAhead << ": loudest " << loudest(samples) << "\n";
+        if (samples != expected) {
+            std::cerr << "Run-ahead " << runAhead << " changes the audio\n";
+            passed = false;
+        }
+    }
+
+    // Skipping frames and going back to a saved state only ever continue from the same level
+    Run skipping = powerOn(rom, 0);
+    (void)play(skipping);
+    std::vector<uint8_t> state(skipping.console->getStateSize());
+    (void)skipping.console->saveState(state);
+    skipping.audio->clear();
+    for (size_t i = 0; i < COMPARED_FRAMES; i++) {
+        skipping.console->skipFrame();
+        skipping.console->runFrame();
+        if (i % 4 == 0) {
+            (void)skipping.console->loadState(state);
+        }
+    }
+    std::cout << "Skipping and loading: loudest " << loudest(skipping.audio->getSamples()) << "\n";
+    if (loudest(skipping.audio->getSamples()) > MAX_SILENCE) {
+        std::cerr << "Skipping frames or loading a state clicks\n";
+        passed = false;
+    }
+
+    return passed ? 0 : EXIT_FAILURE;
+}
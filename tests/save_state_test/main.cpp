@@ -0,0 +1,200 @@
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "console.hpp"
+#include "hash.hpp"
+#include "test_rom.hpp"
+
+/* Save states have to capture everything that affects what happens next. An MMC3 game keeps every
+ * part of the console busy: scanline IRQs, NMIs that read the controller and set the scroll, a
+ * looping DMC sample, palette writes, and a main loop that feeds an LFSR into the pulse and triangle timers. A run
+ * from a saved state has to match the original run frame by frame, and so do a run from a fork of
+ * it and a run with run-ahead on.
+ */
+static const std::array<uint8_t, 0x97> PROGRAM = {
+    0x78,                   // E000  SEI
+    0xD8,                   // E001  CLD
+    0xA2, 0xFF,             // E002  LDX #$FF
+    0x9A,                   // E004  TXS
+    0xA9, 0x40,             // E005  LDA #$40
+    0x8D, 0x17, 0x40,       // E007  STA $4017    ; no APU frame IRQ
+    0xA9, 0x01,             // E00A  LDA #$01
+    0x85, 0x00,             // E00C  STA $00      ; LFSR seed
+    0xA9, 0x4F,             // E00E  LDA #$4F
+    0x8D, 0x10, 0x40,       // E010  STA $4010    ; DMC looping at the fastest rate
+    0xA9, 0x04,             // E013  LDA #$04
+    0x8D, 0x13, 0x40,       // E015  STA $4013    ; 65 byte sample at $C000
+    0xA9, 0x1F,             // E018  LDA #$1F
+    0x8D, 0x15, 0x40,       // E01A  STA $4015    ; every channel on
+    0xA9, 0xBF,             // E01D  LDA #$BF
+    0x8D, 0x00, 0x40,       // E01F  STA $4000    ; pulse 1 duty and volume
+    0xA9, 0xFF,             // E022  LDA #$FF
+    0x8D, 0x08, 0x40,       // E024  STA $4008    ; triangle linear counter
+    0xA9, 0x88,             // E027  LDA #$88
+    0x8D, 0x00, 0x20,       // E029  STA $2000    ; NMIs on, sprites at $1000
+    0xA9, 0x18,             // E02C  LDA #$18
+    0x8D, 0x01, 0x20,       // E02E  STA $2001    ; rendering on
+    0xA9, 0x07,             // E031  LDA #$07
+    0x8D, 0x00, 0xC0,       // E033  STA $C000    ; IRQ latch
+    0x8D, 0x01, 0xC0,       // E036  STA $C001    ; reload
+    0x8D, 0x01, 0xE0,       // E039  STA $E001    ; IRQs on
+    0x58,                   // E03C  CLI
+
+    0xA5, 0x00,             // E03D  LDA $00      ; main loop
+    0x0A,                   // E03F  ASL A
+    0x90, 0x02,             // E040  BCC $E044
+    0x49, 0x1D,             // E042  EOR #$1D
+    0x85, 0x00,             // E044  STA $00
+    0x8D, 0x02, 0x40,       // E046  STA $4002
+    0x8D, 0x0A, 0x40,       // E049  STA $400A
+    0x29, 0x07,             // E04C  AND #$07
+    0x8D, 0x03, 0x40,       // E04E  STA $4003
+    0x8D, 0x0B, 0x40,       // E051  STA $400B
+    0xE6, 0x01,             // E054  INC $01
+    0x4C, 0x3D, 0xE0,       // E056  JMP $E03D
+
+    0x48,                   // E059  PHA          ; NMI handler
+    0xA9, 0x01,             // E05A  LDA #$01
+    0x8D, 0x16, 0x40,       // E05C  STA $4016
+    0xA9, 0x00,             // E05F  LDA #$00
+    0x8D, 0x16, 0x40,       // E061  STA $4016    ; latch the buttons
+    0xA2, 0x08,             // E064  LDX #$08
+    0xAD, 0x16, 0x40,       // E066  LDA $4016
+    0x4A,                   // E069  LSR A
+    0x26, 0x02,             // E06A  ROL $02
+    0xCA,                   // E06C  DEX
+    0xD0, 0xF7,             // E06D  BNE $E066
+    0xA9, 0x3F,             // E06F  LDA #$3F
+    0x8D, 0x06, 0x20,       // E071  STA $2006
+    0xA9, 0x00,             // E074  LDA #$00
+    0x8D, 0x06, 0x20,       // E076  STA $2006
+    0xA5, 0x00,             // E079  LDA $00
+    0x29, 0x3F,             // E07B  AND #$3F
+    0x8D, 0x07, 0x20,       // E07D  STA $2007    ; backdrop colour from the LFSR
+    0xA5, 0x02,             // E080  LDA $02
+    0x8D, 0x05, 0x20,       // E082  STA $2005    ; scroll by the buttons
+    0xA5, 0x00,             // E085  LDA $00
+    0x8D, 0x05, 0x20,       // E087  STA $2005    ; and the LFSR
+    0xE6, 0x03,             // E08A  INC $03
+    0x68,                   // E08C  PLA
+    0x40,                   // E08D  RTI
+
+    0xE6, 0x04,             // E08E  INC $04      ; IRQ handler
+    0x8D, 0x00, 0xE0,       // E090  STA $E000    ; acknowledge
+    0x8D, 0x01, 0xE0,       // E093  STA $E001    ; and turn IRQs back on
+    0x40,                   // E096  RTI
+};
+
+static const uint16_t NMI_HANDLER = 0xE059;
+static const uint16_t IRQ_HANDLER = 0xE08E;
+
+static const size_t WARMUP_FRAMES = 10;
+static const size_t COMPARED_FRAMES = 30;
+static const size_t RUN_AHEAD_FRAMES = 2;
+
+// What a run did, frame by frame
+struct Trace {
+    std::vector<uint64_t> states;
+    std::vector<uint64_t> pictures;
+};
+
+static uint64_t hashState(const RNES::Console& t_console) {
+    std::vector<uint8_t> state(t_console.getStateSize());
+    const auto saved = t_console.saveState(state);
+    ASSERT(!saved.is_error(), "Failed to save state");
+    return RNES::hash64(state);
+}
+
+static uint64_t hashPicture(const RNES::Console& t_console) {
+    const auto frame = t_console.getFrameBuffer();
+    return RNES::hash64(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(frame.data()), frame.size_bytes()));
+}
+
+static Trace run(RNES::Console& t_console, std::span<const RNES::InputFrame> t_inputs) {
+    Trace trace;
+    for (const RNES::InputFrame& input : t_inputs) {
+        t_console.setInput(0, input[0]);
+        t_console.setInput(1, input[1]);
+        t_console.runFrame();
+        trace.states.push_back(hashState(t_console));
+        trace.pictures.push_back(hashPicture(t_console));
+    }
+    return trace;
+}
+
+static bool compare(const char* t_name, const std::vector<uint64_t>& t_expected, const std::vector<uint64_t>& t_actual) {
+    for (size_t i = 0; i < t_expected.size(); i++) {
+        if (t_expected[i] != t_actual[i]) {
+            std::cerr << t_name << " differs from frame " << i << "\n";
+            return false;
+        }
+    }
+    std::cout << t_name << " matches over " << t_expected.size() << " frames\n";
+    return true;
+}
+
+static std::unique_ptr<RNES::Console> powerOn(std::span<const uint8_t> t_rom) {
+    auto consoleOrError = RNES::Console::fromBuffer(t_rom);
+    if (consoleOrError.is_error()) {
+        std::cerr << "Failed to create console (error " << consoleOrError.get_error().getErrorCode() << ")\n";
+        std::exit(EXIT_FAILURE);
+    }
+    return std::move(consoleOrError).get_value();
+}
+
+int main() {
+    RNES::Test::TestROMVectors vectors;
+    vectors.nmi = NMI_HANDLER;
+    vectors.irq = IRQ_HANDLER;
+    const auto rom = RNES::Test::makeTestROM(4, PROGRAM, vectors);
+
+    std::mt19937 random(1);
+    std::vector<RNES::InputFrame> inputs(WARMUP_FRAMES + COMPARED_FRAMES);
+    for (RNES::InputFrame& input : inputs) {
+        input = { static_cast<uint8_t>(random()), static_cast<uint8_t>(random()) };
+    }
+    const auto warmup = std::span<const RNES::InputFrame>(inputs).first(WARMUP_FRAMES);
+    const auto compared = std::span<const RNES::InputFrame>(inputs).subspan(WARMUP_FRAMES);
+
+    auto console = powerOn(rom);
+    const Trace before = run(*console, warmup);
+    std::vector<uint8_t> state(console->getStateSize());
+    if (console->saveState(state).is_error()) {
+        std::cerr << "Failed to save state\n";
+        return EXIT_FAILURE;
+    }
+    const Trace expected = run(*console, compared);
+
+    bool passed = true;
+
+    // Loading a state and saving it again gives back the same bytes
+    if (console->loadState(state).is_error()) {
+        std::cerr << "Failed to load state\n";
+        return EXIT_FAILURE;
+    }
+    if (hashState(*console) != RNES::hash64(state)) {
+        std::cerr << "A loaded state saves differently\n";
+        passed = false;
+    }
+
+    auto child = console->fork();
+    const Trace reloaded = run(*console, compared);
+    passed &= compare("Loaded state", expected.states, reloaded.states);
+    passed &= compare("Loaded pictures", expected.pictures, reloaded.pictures);
+
+    const Trace forked = run(*child, compared);
+    passed &= compare("Fork", expected.states, forked.states);
+
+    // Run-ahead only changes what's shown, never the state a frame leaves behind
+    auto runAhead = powerOn(rom);
+    runAhead->setRunAhead(RUN_AHEAD_FRAMES);
+    const Trace runAheadBefore = run(*runAhead, warmup);
+    const Trace runAheadAfter = run(*runAhead, compared);
+    passed &= compare("Run-ahead warmup", before.states, runAheadBefore.states);
+    passed &= compare("Run-ahead", expected.states, runAheadAfter.states);
+
+    return passed ? 0 : EXIT_FAILURE;
+}
@@ -0,0 +1,136 @@
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "console.hpp"
+#include "hash.hpp"
+#include "test_rom.hpp"
+#include "batch/state_cache.hpp"
+#include "mapper/mapper.hpp"
+
+/* A console booted by StateCache has to be in exactly the state reached by playing the boot input
+ * from power on, whether the cache emulated it, forked an entry it already had, or loaded the file
+ * another cache wrote. Consoles from the cache have to carry on from there just as the original
+ * does. A damaged file is booted over and replaced. The ROM folds the first controller into RAM
+ * all the time, so the wrong boot input would show in the state.
+ */
+static const size_t BOOT_FRAMES = 60;
+static const size_t LATER_FRAMES = 20;
+
+static const std::array<uint8_t, 30> PROGRAM = {
+    0xA9, 0x01,             // E000  LDA #$01
+    0x8D, 0x16, 0x40,       // E002  STA $4016
+    0xA9, 0x00,             // E005  LDA #$00
+    0x8D, 0x16, 0x40,       // E007  STA $4016
+    0xA2, 0x08,             // E00A  LDX #$08
+    0xAD, 0x16, 0x40,       // E00C  LDA $4016
+    0x4A,                   // E00F  LSR A
+    0x26, 0x00,             // E010  ROL $00
+    0xCA,                   // E012  DEX
+    0xD0, 0xF7,             // E013  BNE $E00C
+    0xA5, 0x00,             // E015  LDA $00
+    0x65, 0x01,             // E017  ADC $01
+    0x85, 0x01,             // E019  STA $01
+    0x4C, 0x00, 0xE0,       // E01B  JMP $E000
+};
+
+static void runFrames(RNES::Console& t_console, std::span<const RNES::InputFrame> t_input) {
+    for (const RNES::InputFrame& frame : t_input) {
+        for (size_t port = 0; port < frame.size(); port++) {
+            t_console.setInput(port, frame[port]);
+        }
+        t_console.runFrame();
+    }
+}
+
+static std::vector<uint8_t> saveState(const RNES::Console& t_console) {
+    std::vector<uint8_t> state(t_console.getStateSize());
+    (void)t_console.saveState(state);
+    return state;
+}
+
+// Boots from t_cache and checks the console against t_expected, and that the cache ran t_emulatedFrames to get there
+static bool checkBoot(RNES::Batch::StateCache& t_cache, const std::shared_ptr<const RNES::Mapper::ROMImage>& t_rom,
+                      std::span<const RNES::InputFrame> t_input, const std::vector<uint8_t>& t_expected,
+                      uint64_t t_emulatedFrames, const char* t_description) {
+    auto consoleOrError = t_cache.boot(t_rom, t_input);
+    if (consoleOrError.is_error()) {
+        std::cerr << "Failed to boot " << t_description << " (error " << consoleOrError.get_error().getErrorCode() << ")\n";
+        return false;
+    }
+    if (saveState(*consoleOrError.get_value()) != t_expected) {
+        std::cerr << "Booting " << t_description << " gave the wrong state\n";
+        return false;
+    }
+    if (t_cache.getEmulatedFrames() != t_emulatedFrames) {
+        std::cerr << "Booting " << t_description << " emulated " << t_cache.getEmulatedFrames() << " frames, expected " << t_emulatedFrames << "\n";
+        return false;
+    }
+    std::cout << "Booted " << t_description << "\n";
+    return true;
+}
+
+int main() {
+    const auto rom = RNES::Mapper::loadROMImage(RNES::Test::makeTestROM(0, PROGRAM, {})).get_value();
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "rnes_state_cache_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    std::mt19937 random(5);
+    std::vector<RNES::InputFrame> input(BOOT_FRAMES + LATER_FRAMES);
+    for (RNES::InputFrame& frame : input) {
+        frame = { static_cast<uint8_t>(random()), static_cast<uint8_t>(random()) };
+    }
+    const std::span<const RNES::InputFrame> boot = std::span<const RNES::InputFrame>(input).first(BOOT_FRAMES);
+    const std::span<const RNES::InputFrame> later = std::span<const RNES::InputFrame>(input).subspan(BOOT_FRAMES);
+
+    auto original = RNES::Console::fromImage(rom).get_value();
+    runFrames(*original, boot);
+    const std::vector<uint8_t> booted = saveState(*original);
+    runFrames(*original, later);
+    const std::vector<uint8_t> finished = saveState(*original);
+
+    bool passed = true;
+    {
+        RNES::Batch::StateCache cache(directory.string());
+        passed &= checkBoot(cache, rom, boot, booted, BOOT_FRAMES, "from scratch");
+        passed &= checkBoot(cache, rom, boot, booted, BOOT_FRAMES, "again from memory");
+    }
+
+    // A cache in another process only has the file
+    const uint64_t inputHash = RNES::hash64({ reinterpret_cast<const uint8_t*>(boot.data()), boot.size_bytes() });
+    const std::filesystem::path path = RNES::Batch::StateCache(directory.string()).getPath(rom->hash, inputHash);
+    if (!std::filesystem::exists(path)) {
+        std::cerr << "The booted state wasn't written to " << path << "\n";
+        return EXIT_FAILURE;
+    }
+    {
+        RNES::Batch::StateCache cache(directory.string());
+        passed &= checkBoot(cache, rom, boot, booted, 0, "from the file");
+
+        auto console = cache.boot(rom, boot).get_value();
+        runFrames(*console, later);
+        if (saveState(*console) != finished) {
+            std::cerr << "A console from the cache didn't carry on like the original\n";
+            passed = false;
+        }
+    }
+
+    // A damaged file is booted over and replaced
+    const uintmax_t fileSize = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, fileSize / 2);
+    {
+        RNES::Batch::StateCache cache(directory.string());
+        passed &= checkBoot(cache, rom, boot, booted, BOOT_FRAMES, "over a damaged file");
+    }
+    if (std::filesystem::file_size(path) != fileSize) {
+        std::cerr << "The damaged file wasn't replaced\n";
+        passed = false;
+    }
+
+    std::filesystem::remove_all(directory);
+    return passed ? 0 : EXIT_FAILURE;
+}